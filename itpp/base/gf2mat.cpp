@@ -32,6 +32,10 @@
 #include <itpp/base/converters.h>
 #include <iostream>
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 namespace itpp
 {
 
@@ -273,6 +277,366 @@ void GF2mat_sparse_alist::from_sparse(const GF2mat_sparse &sbmat,
   }
 }
 
+// ----------------------------------------------------------------------
+// Word-parallel row operations and M4RI elimination
+// ----------------------------------------------------------------------
+
+//! \cond
+
+// dst += src (XOR) over n words
+static inline void xor_words(uint64_t *dst, const uint64_t *src, int n)
+{
+  int k = 0;
+#if defined(__SSE2__)
+  for (; k + 4 <= n; k += 4) {
+    __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + k));
+    __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + k + 2));
+    __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k));
+    __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k + 2));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + k), _mm_xor_si128(a0, b0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + k + 2), _mm_xor_si128(a1, b1));
+  }
+#endif
+  for (; k < n; k++) {
+    dst[k] ^= src[k];
+  }
+}
+
+// dst += a + b (XOR) over n words
+static inline void xor_words(uint64_t *dst, const uint64_t *a, const uint64_t *b, int n)
+{
+  int k = 0;
+#if defined(__SSE2__)
+  for (; k + 2 <= n; k += 2) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + k));
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + k));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + k));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + k),
+                     _mm_xor_si128(d, _mm_xor_si128(x, y)));
+  }
+#endif
+  for (; k < n; k++) {
+    dst[k] ^= a[k] ^ b[k];
+  }
+}
+
+static inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__)
+  return __builtin_popcountll(x);
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest bit set in x, which must not be zero
+static inline int lowest_bit(uint64_t x)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#else
+  int b = 0;
+  while (!(x & 1)) {
+    x >>= 1;
+    b++;
+  }
+  return b;
+#endif
+}
+
+// The 64 bits of a row of nwords words starting at bit pos
+static inline uint64_t bits_at(const uint64_t *words, int nwords, int pos)
+{
+  int w = pos >> 6;
+  int s = pos & 63;
+  uint64_t x = words[w] >> s;
+  if ((s != 0) && (w + 1 < nwords)) {
+    x |= words[w + 1] << (64 - s);
+  }
+  return x;
+}
+
+// Add nbits bits of src, from bit src_pos, into the zero bits of dst from
+// bit dst_pos
+static void copy_bits(uint64_t *dst, int dst_pos, const uint64_t *src,
+                      int src_nwords, int src_pos, int nbits)
+{
+  for (int done = 0; done < nbits; done += 64) {
+    uint64_t x = bits_at(src, src_nwords, src_pos + done);
+    int nb = nbits - done;
+    if (nb < 64) {
+      x &= (uint64_t(1) << nb) - 1;
+    }
+    else {
+      nb = 64;
+    }
+    int p = dst_pos + done;
+    int w = p >> 6;
+    int s = p & 63;
+    dst[w] |= x << s;
+    if ((s != 0) && (s + nb > 64)) {
+      dst[w + 1] |= x >> (64 - s);
+    }
+  }
+}
+
+// Transpose a 64x64 block in place: bit c of a[r] and bit r of a[c] are
+// exchanged, by swapping 32x32, 16x16, ... sub-blocks
+static void transpose64(uint64_t *a)
+{
+  uint64_t m = 0x00000000FFFFFFFFULL;
+  for (int j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+    for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+      uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    }
+  }
+}
+
+// The sums of all combinations of up to eight rows: entry v is the sum of
+// the rows whose bits are set in v. Only the words first..n-1 are used.
+class GF2_Table
+{
+public:
+  GF2_Table(): n(0) {}
+  void build(const uint64_t *const *rows, int nrows, int first, int nwords) {
+    int size = 1 << nrows;
+    n = nwords;
+    if (table.size() < size * n) {
+      table.set_size(size * n);
+    }
+    uint64_t *t = table._data();
+    for (int k = first; k < n; k++) {
+      t[k] = 0;
+    }
+    for (int v = 1; v < size; v++) {
+      uint64_t *tv = t + v * n;
+      const uint64_t *prev = t + (v & (v - 1)) * n;
+      const uint64_t *r = rows[lowest_bit(v)];
+      for (int k = first; k < n; k++) {
+        tv[k] = prev[k] ^ r[k];
+      }
+    }
+  }
+  const uint64_t *operator()(int v) const { return table._data() + v * n; }
+private:
+  int n;
+  Vec<uint64_t> table;
+};
+
+// Gaussian elimination on nrows rows of stride words, with the pivots
+// taken in blocks of up to 16 (M4RI). The pivot rows of a block are kept
+// reduced against each other in E, so that a row is reduced by the whole
+// block with one addition per bit it has in the pivot columns. A row is
+// only reduced when the pivot search reaches it; the others are reduced
+// when the block is full, with two table lookups each.
+class GF2_Elimination
+{
+public:
+  GF2_Elimination(uint64_t *rows, int nrows, int row_stride):
+      A(rows), m(nrows), stride(row_stride), npiv(0), first(0) {
+    E.set_size(max_block * stride);
+  }
+
+  // The elimination of GF2mat::T_fact(): the pivot of row j is the first
+  // one in columns j..ncols-1 of the first row from j that has one, and
+  // is brought to column j. Only the rows below the pivots are reduced.
+  int forward_full_pivot(int ncols, int *perm) {
+    for (int j = 0; j < m; j++) {
+      int i1 = -1, j1 = -1;
+      for (int i = j; (i < m) && (i1 < 0); i++) {
+        uint64_t *r = row(i);
+        reduce(r);
+        for (int w = j >> 6; w <= ((ncols - 1) >> 6); w++) {
+          uint64_t x = r[w];
+          if (w == (j >> 6)) {
+            x &= ~uint64_t(0) << (j & 63);
+          }
+          if ((w == ((ncols - 1) >> 6)) && (ncols & 63)) {
+            x &= (uint64_t(1) << (ncols & 63)) - 1;
+          }
+          if (x != 0) {
+            i1 = i;
+            j1 = 64 * w + lowest_bit(x);
+            break;
+          }
+        }
+      }
+      if (i1 < 0) {
+        end_block(j, false);
+        return j;
+      }
+      swap_rows(i1, j);
+      if (j1 != j) {
+        swap_cols(j1, j);
+        int temp = perm[j];
+        perm[j] = perm[j1];
+        perm[j1] = temp;
+      }
+      add_pivot(j, j);
+      if (npiv == max_block) {
+        end_block(j + 1, false);
+      }
+    }
+    end_block(m, false);
+    return m;
+  }
+
+  // Pivots taken column by column in the first ncols columns, in rows
+  // 0, 1, ... With reduce_above the rows above the pivots are reduced as
+  // well, which gives the reduced row echelon form.
+  int echelon(int ncols, bool reduce_above, int *pivot_cols) {
+    int r = 0;
+    for (int c = 0; (c < ncols) && (r < m); c++) {
+      int i1 = -1;
+      for (int i = r; i < m; i++) {
+        uint64_t *ri = row(i);
+        reduce(ri);
+        if ((ri[c >> 6] >> (c & 63)) & 1) {
+          i1 = i;
+          break;
+        }
+      }
+      if (i1 < 0) {
+        continue;
+      }
+      swap_rows(i1, r);
+      add_pivot(r, c);
+      pivot_cols[r] = c;
+      r++;
+      if (npiv == max_block) {
+        end_block(r, reduce_above);
+      }
+    }
+    end_block(r, reduce_above);
+    return r;
+  }
+
+private:
+  static const int max_block = 16;
+  uint64_t *A;
+  int m;
+  int stride;
+  // pivots in the current block, their columns and the first word they use
+  int npiv;
+  int pcol[max_block];
+  int first;
+  Vec<uint64_t> E;
+  GF2_Table tables[2];
+
+  uint64_t *row(int i) { return A + i * stride; }
+
+  // The bits of a row in the pivot columns of the current block
+  int block_bits(const uint64_t *r) const {
+    int v = 0;
+    for (int b = 0; b < npiv; b++) {
+      v |= static_cast<int>((r[pcol[b] >> 6] >> (pcol[b] & 63)) & 1) << b;
+    }
+    return v;
+  }
+
+  void reduce(uint64_t *r) {
+    int v = block_bits(r);
+    while (v != 0) {
+      int b = lowest_bit(static_cast<uint64_t>(v));
+      xor_words(r + first, E._data() + b * stride + first, stride - first);
+      v &= v - 1;
+    }
+  }
+
+  // Row i, reduced by the block, gets its leading one in column col
+  void add_pivot(int i, int col) {
+    if (npiv == 0) {
+      first = col >> 6;
+    }
+    uint64_t *e = E._data() + npiv * stride;
+    const uint64_t *r = row(i);
+    for (int k = first; k < stride; k++) {
+      e[k] = r[k];
+    }
+    for (int b = 0; b < npiv; b++) {
+      uint64_t *eb = E._data() + b * stride;
+      if ((eb[col >> 6] >> (col & 63)) & 1) {
+        xor_words(eb + first, e + first, stride - first);
+      }
+    }
+    pcol[npiv] = col;
+    npiv++;
+  }
+
+  // Reduce the rows from r by the block (and the rows above the block
+  // with reduce_above, whose pivot rows are then replaced by E)
+  void end_block(int r, bool reduce_above) {
+    if (npiv == 0) {
+      return;
+    }
+    const uint64_t *e[max_block];
+    for (int b = 0; b < npiv; b++) {
+      e[b] = E._data() + b * stride;
+    }
+    int n0 = (npiv < 8) ? npiv : 8;
+    tables[0].build(e, n0, first, stride);
+    if (npiv > 8) {
+      tables[1].build(e + 8, npiv - 8, first, stride);
+    }
+    int r0 = r - npiv;
+    for (int i = reduce_above ? 0 : r; i < m; i++) {
+      if (i == r0) {
+        i = r - 1;
+        continue;
+      }
+      uint64_t *ri = row(i);
+      int v = block_bits(ri);
+      if ((v >> 8) != 0) {
+        xor_words(ri + first, tables[0](v & 255) + first,
+                  tables[1](v >> 8) + first, stride - first);
+      }
+      else if (v != 0) {
+        xor_words(ri + first, tables[0](v) + first, stride - first);
+      }
+    }
+    if (reduce_above) {
+      for (int b = 0; b < npiv; b++) {
+        uint64_t *ri = row(r0 + b);
+        for (int k = first; k < stride; k++) {
+          ri[k] = e[b][k];
+        }
+      }
+    }
+    npiv = 0;
+  }
+
+  void swap_rows(int i, int j) {
+    if (i == j) {
+      return;
+    }
+    uint64_t *ri = row(i);
+    uint64_t *rj = row(j);
+    for (int k = 0; k < stride; k++) {
+      uint64_t temp = ri[k];
+      ri[k] = rj[k];
+      rj[k] = temp;
+    }
+  }
+
+  // Swap columns i and j in all rows and in the pivot rows of the block
+  void swap_cols(int i, int j) {
+    int wi = i >> 6, bi = i & 63, wj = j >> 6, bj = j & 63;
+    for (int k = 0; k < m + npiv; k++) {
+      uint64_t *r = (k < m) ? row(k) : E._data() + (k - m) * stride;
+      uint64_t d = ((r[wi] >> bi) ^ (r[wj] >> bj)) & 1;
+      r[wi] ^= d << bi;
+      r[wj] ^= d << bj;
+    }
+  }
+};
+
+//! \endcond
+
 
 // ----------------------------------------------------------------------
 // Implementation of a dense GF2 matrix class
@@ -281,14 +645,14 @@ void GF2mat_sparse_alist::from_sparse(const GF2mat_sparse &sbmat,
 GF2mat::GF2mat(int i, int j): nrows(i), ncols(j),
     nwords((j >> shift_divisor) + 1)
 {
-  data.set_size(nrows, nwords);
-  data.clear();
+  data.set_size(nrows * nwords);
+  data.zeros();
 }
 
 GF2mat::GF2mat(): nrows(1), ncols(1), nwords(1)
 {
-  data.set_size(nrows, nwords);
-  data.clear();
+  data.set_size(nrows * nwords);
+  data.zeros();
 }
 
 GF2mat::GF2mat(const bvec &x, bool is_column)
@@ -297,8 +661,8 @@ GF2mat::GF2mat(const bvec &x, bool is_column)
     nrows = length(x);
     ncols = 1;
     nwords = 1;
-    data.set_size(nrows, nwords);
-    data.clear();
+    data.set_size(nrows * nwords);
+    data.zeros();
     for (int i = 0; i < nrows; i++) {
       set(i, 0, x(i));
     }
@@ -307,8 +671,8 @@ GF2mat::GF2mat(const bvec &x, bool is_column)
     nrows = 1;
     ncols = length(x);
     nwords = (ncols >> shift_divisor) + 1;
-    data.set_size(nrows, nwords);
-    data.clear();
+    data.set_size(nrows * nwords);
+    data.zeros();
     for (int i = 0; i < ncols; i++) {
       set(0, i, x(i));
     }
@@ -319,8 +683,8 @@ GF2mat::GF2mat(const bvec &x, bool is_column)
 GF2mat::GF2mat(const bmat &X): nrows(X.rows()), ncols(X.cols())
 {
   nwords = (ncols >> shift_divisor) + 1;
-  data.set_size(nrows, nwords);
-  data.clear();
+  data.set_size(nrows * nwords);
+  data.zeros();
   for (int i = 0; i < nrows; i++) {
     for (int j = 0; j < ncols; j++) {
       set(i, j, X(i, j));
@@ -334,12 +698,8 @@ GF2mat::GF2mat(const GF2mat_sparse &X)
   nrows = X.rows();
   ncols = X.cols();
   nwords = (ncols >> shift_divisor) + 1;
-  data.set_size(nrows, nwords);
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < nwords; j++) {
-      data(i, j) = 0;
-    }
-  }
+  data.set_size(nrows * nwords);
+  data.zeros();
 
   for (int j = 0; j < ncols; j++) {
     for (int i = 0; i < X.get_col(j).nnz(); i++)   {
@@ -359,13 +719,8 @@ GF2mat::GF2mat(const GF2mat_sparse &X, int m1, int n1, int m2, int n2)
   nrows = m2 - m1 + 1;
   ncols = n2 - n1 + 1;
   nwords = (ncols >> shift_divisor) + 1;
-  data.set_size(nrows, nwords);
-
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < nwords; j++) {
-      data(i, j) = 0;
-    }
-  }
+  data.set_size(nrows * nwords);
+  data.zeros();
 
   for (int i = 0; i < nrows; i++) {
     for (int j = 0; j < ncols; j++)   {
@@ -386,13 +741,8 @@ GF2mat::GF2mat(const GF2mat_sparse &X, const ivec &columns)
   nrows = X.rows();
   ncols = length(columns);
   nwords = (ncols >> shift_divisor) + 1;
-  data.set_size(nrows, nwords);
-
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < nwords; j++) {
-      data(i, j) = 0;
-    }
-  }
+  data.set_size(nrows * nwords);
+  data.zeros();
 
   for (int j = 0; j < ncols; j++) {
     for (int i = 0; i < X.get_col(columns(j)).nnz(); i++)   {
@@ -405,12 +755,35 @@ GF2mat::GF2mat(const GF2mat_sparse &X, const ivec &columns)
 
 void GF2mat::set_size(int m, int n, bool copy)
 {
+  int old_rows = nrows;
+  int old_words = nwords;
   nrows = m;
   ncols = n;
   nwords = (ncols >> shift_divisor) + 1;
-  data.set_size(nrows, nwords, copy);
-  if (!copy)
-    data.clear();
+  if (copy) {
+    Vec<uint64_t> old_data(data);
+    data.set_size(nrows * nwords);
+    data.zeros();
+    int copy_words = std::min(nwords, old_words);
+    for (int i = 0; i < std::min(nrows, old_rows); i++) {
+      for (int k = 0; k < copy_words; k++) {
+        data(i * nwords + k) = old_data(i * old_words + k);
+      }
+    }
+    clear_tails();
+  }
+  else {
+    data.set_size(nrows * nwords);
+    data.zeros();
+  }
+}
+
+void GF2mat::clear_tails()
+{
+  uint64_t mask = (uint64_t(1) << (ncols & rem_mask)) - 1;
+  for (int i = 0; i < nrows; i++) {
+    row_words(i)[ncols >> shift_divisor] &= mask;
+  }
 }
 
 
@@ -418,9 +791,12 @@ GF2mat_sparse GF2mat::sparsify() const
 {
   GF2mat_sparse Z(nrows, ncols);
   for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < ncols; j++) {
-      if (get(i, j) == 1) {
-        Z.set(i, j, 1);
+    const uint64_t *r = row_words(i);
+    for (int k = 0; k < nwords; k++) {
+      uint64_t x = r[k];
+      while (x != 0) {
+        Z.set(i, (k << shift_divisor) + lowest_bit(x), 1);
+        x &= x - 1;
       }
     }
   }
@@ -452,8 +828,13 @@ void GF2mat::set_row(int i, bvec x)
 {
   it_assert(length(x) == ncols,
             "GF2mat::set_row(): dimension mismatch");
+  uint64_t *r = row_words(i);
+  for (int k = 0; k < nwords; k++) {
+    r[k] = 0;
+  }
   for (int j = 0; j < ncols; j++) {
-    set(i, j, x(j));
+    r[j >> shift_divisor] |= static_cast<uint64_t>(static_cast<int>(x(j)))
+                             << (j & rem_mask);
   }
 }
 
@@ -484,9 +865,8 @@ GF2mat GF2mat::get_submatrix(int m1, int n1, int m2, int n2) const
   GF2mat result(m2 - m1 + 1, n2 - n1 + 1);
 
   for (int i = m1; i <= m2; i++) {
-    for (int j = n1; j <= n2; j++) {
-      result.set(i - m1, j - n1, get(i, j));
-    }
+    copy_bits(result.row_words(i - m1), 0, row_words(i), nwords, n1,
+              result.ncols);
   }
 
   return result;
@@ -501,16 +881,12 @@ GF2mat GF2mat::concatenate_vertical(const GF2mat &X) const
             "GF2mat::concatenate_vertical(): dimension mismatch");
 
   GF2mat result(nrows + X.nrows, ncols);
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < nwords; j++) {
-      result.data(i, j) = data(i, j);
-    }
+  for (int k = 0; k < nrows * nwords; k++) {
+    result.data(k) = data(k);
   }
 
-  for (int i = 0; i < X.nrows; i++) {
-    for (int j = 0; j < nwords; j++) {
-      result.data(i + nrows, j) = X.data(i, j);
-    }
+  for (int k = 0; k < X.nrows * nwords; k++) {
+    result.data(k + nrows * nwords) = X.data(k);
   }
 
   return result;
@@ -523,15 +899,8 @@ GF2mat GF2mat::concatenate_horizontal(const GF2mat &X) const
 
   GF2mat result(nrows, X.ncols + ncols);
   for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < ncols; j++) {
-      result.set(i, j, get(i, j));
-    }
-  }
-
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < X.ncols; j++) {
-      result.set(i, j + ncols, X.get(i, j));
-    }
+    copy_bits(result.row_words(i), 0, row_words(i), nwords, 0, ncols);
+    copy_bits(result.row_words(i), ncols, X.row_words(i), X.nwords, 0, X.ncols);
   }
 
   return result;
@@ -540,8 +909,9 @@ GF2mat GF2mat::concatenate_horizontal(const GF2mat &X) const
 bvec GF2mat::get_row(int i) const
 {
   bvec result(ncols);
+  const uint64_t *r = row_words(i);
   for (int j = 0; j < ncols; j++) {
-    result(j) = get(i, j);
+    result(j) = static_cast<int>((r[j >> shift_divisor] >> (j & rem_mask)) & 1);
   }
 
   return result;
@@ -560,9 +930,6 @@ bvec GF2mat::get_col(int j) const
 
 int GF2mat::T_fact(GF2mat &T, GF2mat &U, ivec &perm) const
 {
-  T = gf2dense_eye(nrows);
-  U = *this;
-
   perm = zeros_i(ncols);
   for (int i = 0; i < ncols; i++) {
     perm(i) = i;
@@ -572,42 +939,39 @@ int GF2mat::T_fact(GF2mat &T, GF2mat &U, ivec &perm) const
     it_info_debug("Performing T-factorization of GF(2) matrix...  rows: "
                   << nrows << " cols: "  << ncols << " .... " << std::endl);
   }
-  int pdone = 0;
-  for (int j = 0; j < nrows; j++) {
-    // Now working on diagonal element j,j
-    // First try find a row with a 1 in column i
-    int i1, j1;
-    for (i1 = j; i1 < nrows; i1++) {
-      for (j1 = j; j1 < ncols; j1++) {
-        if (U.get(i1, j1) == 1) { goto found; }
-      }
-    }
-
-    return j;
 
-  found:
-    U.swap_rows(i1, j);
-    T.swap_rows(i1, j);
-    U.swap_cols(j1, j);
+  // U and T side by side in the rows of one buffer, so that each row
+  // operation is done on both
+  int twords = (nrows >> shift_divisor) + 1;
+  int stride = nwords + twords;
+  Vec<uint64_t> rows(nrows * stride);
+  rows.zeros();
+  for (int i = 0; i < nrows; i++) {
+    uint64_t *r = rows._data() + i * stride;
+    const uint64_t *x = row_words(i);
+    for (int k = 0; k < nwords; k++) {
+      r[k] = x[k];
+    }
+    r[nwords + (i >> shift_divisor)] = uint64_t(1) << (i & rem_mask);
+  }
 
-    int temp = perm(j);
-    perm(j) = perm(j1);
-    perm(j1) = temp;
+  GF2_Elimination elimination(rows._data(), nrows, stride);
+  int rank = elimination.forward_full_pivot(ncols, perm._data());
 
-    // now subtract row i from remaining rows
-    for (int i1 = j + 1; i1 < nrows; i1++)  {
-      if (U.get(i1, j) == 1) {
-        int ptemp = floor_i(100.0 * (i1 + j * nrows) / (nrows * nrows));
-        if (nrows > 250 && ptemp > pdone + 10) {
-          it_info_debug(ptemp << "% done.");
-          pdone = ptemp;
-        }
-        U.add_rows(i1, j);
-        T.add_rows(i1, j);
-      }
+  U.set_size(nrows, ncols);
+  T.set_size(nrows, nrows);
+  for (int i = 0; i < nrows; i++) {
+    const uint64_t *r = rows._data() + i * stride;
+    uint64_t *u = U.row_words(i);
+    uint64_t *t = T.row_words(i);
+    for (int k = 0; k < nwords; k++) {
+      u[k] = r[k];
+    }
+    for (int k = 0; k < twords; k++) {
+      t[k] = r[nwords + k];
     }
   }
-  return nrows;
+  return rank;
 }
 
 
@@ -743,46 +1107,46 @@ found:
 }
 
 
-
-
 GF2mat GF2mat::inverse() const
 {
   it_assert(nrows == ncols, "GF2mat::inverse(): Matrix must be square");
 
-  // first compute the T-factorization
-  GF2mat T, U;
-  ivec perm;
-  int rank = T_fact(T, U, perm);
+  // reduce [X I] to [I X^{-1}]
+  GF2mat Z = concatenate_horizontal(gf2dense_eye(nrows));
+  ivec pivots;
+  int rank = Z.rref(pivots, ncols);
   it_assert(rank == ncols, "GF2mat::inverse(): Matrix is not full rank");
 
-  // backward substitution
-  for (int i = ncols - 2; i >= 0; i--) {
-    for (int j = ncols - 1; j > i; j--) {
-      if (U.get(i, j) == 1) {
-        U.add_rows(i, j);
-        T.add_rows(i, j);
-      }
-    }
-  }
-  T.permute_rows(perm, 1);
-  return T;
+  return Z.get_submatrix(0, ncols, nrows - 1, 2 * ncols - 1);
 }
 
 int GF2mat::row_rank() const
 {
-  GF2mat T, U;
-  ivec perm;
-  int rank = T_fact(T, U, perm);
+  GF2mat Z(*this);
+  ivec pivots(nrows);
+  GF2_Elimination elimination(Z.data._data(), nrows, nwords);
+  return elimination.echelon(ncols, false, pivots._data());
+}
+
+int GF2mat::rref(ivec &pivot_cols)
+{
+  return rref(pivot_cols, ncols);
+}
+
+int GF2mat::rref(ivec &pivot_cols, int pivot_limit)
+{
+  pivot_cols.set_size(nrows);
+  GF2_Elimination elimination(data._data(), nrows, nwords);
+  int rank = elimination.echelon(pivot_limit, true, pivot_cols._data());
+  pivot_cols.set_size(rank, true);
   return rank;
 }
 
 bool GF2mat::is_zero() const
 {
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < nwords; j++) {
-      if (data(i, j) != 0) {
-        return false;
-      }
+  for (int k = 0; k < nrows * nwords; k++) {
+    if (data(k) != 0) {
+      return false;
     }
   }
   return true;
@@ -794,12 +1158,9 @@ bool GF2mat::operator==(const GF2mat &X) const
   if (X.ncols != ncols) { return false; }
   it_assert(X.nwords == nwords, "GF2mat::operator==() dimension mismatch");
 
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < nwords; j++) {
-      //      if (X.get(i,j)!=get(i,j)) {
-      if (X.data(i, j) != data(i, j)) {
-        return false;
-      }
+  for (int k = 0; k < nrows * nwords; k++) {
+    if (X.data(k) != data(k)) {
+      return false;
     }
   }
   return true;
@@ -810,19 +1171,19 @@ void GF2mat::add_rows(int i, int j)
 {
   it_assert(i >= 0 && i < nrows, "GF2mat::add_rows(): out of range");
   it_assert(j >= 0 && j < nrows, "GF2mat::add_rows(): out of range");
-  for (int k = 0; k < nwords; k++)   {
-    data(i, k) ^= data(j, k);
-  }
+  xor_words(row_words(i), row_words(j), nwords);
 }
 
 void GF2mat::swap_rows(int i, int j)
 {
   it_assert(i >= 0 && i < nrows, "GF2mat::swap_rows(): index out of range");
   it_assert(j >= 0 && j < nrows, "GF2mat::swap_rows(): index out of range");
+  uint64_t *ri = row_words(i);
+  uint64_t *rj = row_words(j);
   for (int k = 0; k < nwords; k++) {
-    unsigned char temp = data(i, k);
-    data(i, k) = data(j, k);
-    data(j, k) = temp;
+    uint64_t temp = ri[k];
+    ri[k] = rj[k];
+    rj[k] = temp;
   }
 }
 
@@ -830,9 +1191,14 @@ void GF2mat::swap_cols(int i, int j)
 {
   it_assert(i >= 0 && i < ncols, "GF2mat::swap_cols(): index out of range");
   it_assert(j >= 0 && j < ncols, "GF2mat::swap_cols(): index out of range");
-  bvec temp = get_col(i);
-  set_col(i, get_col(j));
-  set_col(j, temp);
+  int wi = i >> shift_divisor, bi = i & rem_mask;
+  int wj = j >> shift_divisor, bj = j & rem_mask;
+  for (int k = 0; k < nrows; k++) {
+    uint64_t *r = row_words(k);
+    uint64_t d = ((r[wi] >> bi) ^ (r[wj] >> bj)) & 1;
+    r[wi] ^= d << bi;
+    r[wj] ^= d << bj;
+  }
 }
 
 
@@ -850,24 +1216,40 @@ GF2mat operator*(const GF2mat &X, const GF2mat &Y)
   it_assert(X.nwords > 0, "Gfmat::operator*(): dimension mismatch");
   it_assert(Y.nwords > 0, "Gfmat::operator*(): dimension mismatch");
 
-  /*
-  // this can be done more efficiently?
-  GF2mat result(X.nrows,Y.ncols);
-  for (int i=0; i<X.nrows; i++) {
-  for (int j=0; j<Y.ncols; j++) {
-  bin b=0;
-  for (int k=0; k<X.ncols; k++) {
-  bin x = X.get(i,k);
-  bin y = Y.get(k,j);
-  b ^= (x&y);
-  }
-  result.set(i,j,b);
-  }
+  // M4RI: the rows of Y are taken 32 at a time, in four tables of the
+  // sums of eight rows, and each row of X picks one entry of each table
+  GF2mat result(X.nrows, Y.ncols);
+  GF2_Table tables[4];
+  Vec<uint64_t> zero_row(Y.nwords);
+  zero_row.zeros();
+  for (int k0 = 0; k0 < X.ncols; k0 += 32) {
+    int ntables = 0;
+    for (int k = k0; (k < k0 + 32) && (k < X.ncols); k += 8, ntables++) {
+      const uint64_t *rows[8];
+      int n = std::min(8, X.ncols - k);
+      for (int l = 0; l < n; l++) {
+        rows[l] = Y.row_words(k + l);
+      }
+      tables[ntables].build(rows, n, 0, Y.nwords);
+    }
+    int nbits = std::min(32, X.ncols - k0);
+    uint64_t mask = (uint64_t(1) << nbits) - 1;
+    for (int i = 0; i < X.nrows; i++) {
+      uint64_t v = bits_at(X.row_words(i), X.nwords, k0) & mask;
+      if (v == 0) {
+        continue;
+      }
+      uint64_t *r = result.row_words(i);
+      for (int t = 0; t < ntables; t += 2) {
+        const uint64_t *a = tables[t](static_cast<int>((v >> (8 * t)) & 255));
+        const uint64_t *b = (t + 1 < ntables)
+                            ? tables[t + 1](static_cast<int>((v >> (8 * t + 8)) & 255))
+                            : zero_row._data();
+        xor_words(r, a, b, Y.nwords);
+      }
+    }
   }
-  return result; */
-
-  // is this better?
-  return mult_trans(X, Y.transpose());
+  return result;
 }
 
 bvec operator*(const GF2mat &X, const bvec &y)
@@ -875,29 +1257,23 @@ bvec operator*(const GF2mat &X, const bvec &y)
   it_assert(length(y) == X.ncols, "GF2mat::operator*(): dimension mismatch");
   it_assert(X.nwords > 0, "Gfmat::operator*(): dimension mismatch");
 
-  /*
-  // this can be done more efficiently?
-  bvec result = zeros_b(X.nrows);
-  for (int i=0; i<X.nrows; i++) {
-  // do the nwords-1 data columns first
-  for (int j=0; j<X.nwords-1; j++) {
-  int ind = j<<shift_divisor;
-  unsigned char r=X.data(i,j);
-  while (r) {
-  result(i) ^= (r & y(ind));
-  r >>= 1;
-  ind++;
-  }
+  Vec<uint64_t> yw(X.nwords);
+  yw.zeros();
+  for (int j = 0; j < X.ncols; j++) {
+    yw(j >> GF2mat::shift_divisor) |= static_cast<uint64_t>(static_cast<int>(y(j)))
+                                      << (j & GF2mat::rem_mask);
   }
-  // do the last column separately
-  for (int j=(X.nwords-1)<<shift_divisor; j<X.ncols; j++) {
-  result(i) ^= (X.get(i,j) & y(j));
-  }
-  }
-  return result; */
 
-  // is this better?
-  return (mult_trans(X, GF2mat(y, 0))).bvecify();
+  bvec result(X.nrows);
+  for (int i = 0; i < X.nrows; i++) {
+    const uint64_t *r = X.row_words(i);
+    uint64_t b = 0;
+    for (int k = 0; k < X.nwords; k++) {
+      b ^= r[k] & yw(k);
+    }
+    result(i) = popcount64(b) & 1;
+  }
+  return result;
 }
 
 GF2mat mult_trans(const GF2mat &X, const GF2mat &Y)
@@ -907,39 +1283,24 @@ GF2mat mult_trans(const GF2mat &X, const GF2mat &Y)
   it_assert(Y.nwords > 0, "GF2mat::mult_trans(): dimension mismatch");
   it_assert(X.nwords == Y.nwords, "GF2mat::mult_trans(): dimension mismatch");
 
-  GF2mat result(X.nrows, Y.nrows);
-
-  for (int i = 0; i < X.nrows; i++) {
-    for (int j = 0; j < Y.nrows; j++) {
-      bin b = 0;
-      int kindx = i;
-      int kindy = j;
-      for (int k = 0; k < X.nwords; k++) {
-        unsigned char r = X.data(kindx) & Y.data(kindy);
-        /* The following can be speeded up by using a small lookup
-           table for the number of ones and shift only a few times (or
-           not at all if table is large) */
-        while (r) {
-          b ^= r & 1;
-          r >>= 1;
-        };
-        kindx += X.nrows;
-        kindy += Y.nrows;
-      }
-      result.set(i, j, b);
-    }
-  }
-  return result;
+  return X * Y.transpose();
 }
 
 GF2mat GF2mat::transpose() const
 {
-  // CAN BE SPEEDED UP
+  // transpose 64x64 blocks
   GF2mat result(ncols, nrows);
+  uint64_t block[64];
 
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < ncols; j++) {
-      result.set(j, i, get(i, j));
+  for (int i0 = 0; i0 < nrows; i0 += 64) {
+    for (int k = 0; (k << shift_divisor) < ncols; k++) {
+      for (int l = 0; l < 64; l++) {
+        block[l] = (i0 + l < nrows) ? row_words(i0 + l)[k] : 0;
+      }
+      transpose64(block);
+      for (int l = 0; (l < 64) && ((k << shift_divisor) + l < ncols); l++) {
+        result.row_words((k << shift_divisor) + l)[i0 >> shift_divisor] = block[l];
+      }
     }
   }
   return result;
@@ -950,13 +1311,8 @@ GF2mat operator+(const GF2mat &X, const GF2mat &Y)
   it_assert(X.nrows == Y.nrows, "GF2mat::operator+(): dimension mismatch");
   it_assert(X.ncols == Y.ncols, "GF2mat::operator+(): dimension mismatch");
   it_assert(X.nwords == Y.nwords, "GF2mat::operator+(): dimension mismatch");
-  GF2mat result(X.nrows, X.ncols);
-
-  for (int i = 0; i < X.nrows; i++) {
-    for (int j = 0; j < X.nwords; j++) {
-      result.data(i, j) = X.data(i, j) ^ Y.data(i, j);
-    }
-  }
+  GF2mat result(X);
+  xor_words(result.data._data(), Y.data._data(), X.nrows * X.nwords);
 
   return result;
 }
@@ -966,15 +1322,10 @@ void GF2mat::permute_cols(ivec &perm, bool I)
   it_assert(length(perm) == ncols,
             "GF2mat::permute_cols(): dimensions do not match");
 
-  GF2mat temp = (*this);
-  for (int j = 0; j < ncols; j++) {
-    if (I == 0) {
-      set_col(j, temp.get_col(perm(j)));
-    }
-    else {
-      set_col(perm(j), temp.get_col(j));
-    }
-  }
+  // the columns are the rows of the transpose
+  GF2mat temp = transpose();
+  temp.permute_rows(perm, I);
+  *this = temp.transpose();
 }
 
 void GF2mat::permute_rows(ivec &perm, bool I)
@@ -986,12 +1337,12 @@ void GF2mat::permute_rows(ivec &perm, bool I)
   for (int i = 0; i < nrows; i++) {
     if (I == 0) {
       for (int j = 0; j < nwords; j++) {
-        data(i, j) = temp.data(perm(i), j);
+        row_words(i)[j] = temp.row_words(perm(i))[j];
       }
     }
     else {
       for (int j = 0; j < nwords; j++) {
-        data(perm(i), j) = temp.data(i, j);
+        row_words(perm(i))[j] = temp.row_words(i)[j];
       }
     }
   }
@@ -1019,29 +1370,31 @@ double GF2mat::density() const
 {
   int no_of_ones = 0;
 
-  for (int i = 0; i < nrows; i++) {
-    for (int j = 0; j < ncols; j++) {
-      no_of_ones += (get(i, j) == 1 ? 1 : 0);
-    }
+  for (int k = 0; k < nrows * nwords; k++) {
+    no_of_ones += popcount64(data(k));
   }
 
   return ((double) no_of_ones) / (nrows*ncols);
 }
 
 
+// The file format stores each row in (ncols / 8) + 1 bytes, bit j in bit
+// j mod 8 of byte j / 8
 it_file &operator<<(it_file &f, const GF2mat &X)
 {
+  int nbytes = (X.ncols >> 3) + 1;
   // 3 64-bit unsigned words for: nrows, ncols and nwords + rest for char data
   uint64_t bytecount = 3 * sizeof(uint64_t)
-                       + X.nrows * X.nwords * sizeof(char);
+                       + X.nrows * nbytes * sizeof(char);
   f.write_data_header("GF2mat", bytecount);
 
   f.low_level_write(static_cast<uint64_t>(X.nrows));
   f.low_level_write(static_cast<uint64_t>(X.ncols));
-  f.low_level_write(static_cast<uint64_t>(X.nwords));
+  f.low_level_write(static_cast<uint64_t>(nbytes));
   for (int i = 0; i < X.nrows; i++) {
-    for (int j = 0; j < X.nwords; j++) {
-      f.low_level_write(static_cast<char>(X.data(i, j)));
+    const uint64_t *r = X.row_words(i);
+    for (int j = 0; j < nbytes; j++) {
+      f.low_level_write(static_cast<char>((r[j >> 3] >> (8 * (j & 7))) & 255));
     }
   }
   return f;
@@ -1055,19 +1408,24 @@ it_ifile &operator>>(it_ifile &f, GF2mat &X)
   if (h.type == "GF2mat") {
     uint64_t tmp;
     f.low_level_read(tmp);
-    X.nrows = static_cast<int>(tmp);
+    int nrows = static_cast<int>(tmp);
     f.low_level_read(tmp);
-    X.ncols = static_cast<int>(tmp);
+    int ncols = static_cast<int>(tmp);
     f.low_level_read(tmp);
-    X.nwords = static_cast<int>(tmp);
-    X.data.set_size(X.nrows, X.nwords);
+    int nbytes = static_cast<int>(tmp);
+    X.set_size(nrows, ncols);
     for (int i = 0; i < X.nrows; i++) {
-      for (int j = 0; j < X.nwords; j++) {
-        char r;
-        f.low_level_read(r);
-        X.data(i, j) = static_cast<unsigned char>(r);
+      uint64_t *r = X.row_words(i);
+      for (int j = 0; j < nbytes; j++) {
+        char b;
+        f.low_level_read(b);
+        if ((j >> 3) < X.nwords) {
+          r[j >> 3] |= static_cast<uint64_t>(static_cast<unsigned char>(b))
+                       << (8 * (j & 7));
+        }
       }
     }
+    X.clear_tails();
   }
   else {
     it_error("it_ifile &operator>>() - internal error");
@@ -1077,4 +1435,3 @@ it_ifile &operator>>(it_ifile &f, GF2mat &X)
 }
 
 } // namespace itpp
-
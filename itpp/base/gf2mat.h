@@ -47,6 +47,7 @@
 #include <itpp/base/svec.h>
 #include <itpp/base/smat.h>
 #include <itpp/base/itfile.h>
+#include <itpp/base/ittypes.h>
 
 
 namespace itpp
@@ -153,6 +154,14 @@ protected:
   See also \c GF2mat_sparse which offers an efficient representation
   of sparse GF(2) matrices, and \c GF2mat_sparse_alist for a
   parameterized representation of sparse GF(2) matrices.
+
+  The matrix is stored row by row, each row in contiguous 64-bit words
+  with bit \a j in bit \a j mod 64 of word \a j / 64. Rows are added
+  with SSE2 when available, and the elimination in T_fact(), rref() and
+  inverse(), as well as the matrix product, use the "Method of Four
+  Russians" (M4RI): the sums of all combinations of eight rows are
+  tabulated once, so that one table lookup replaces up to eight row
+  additions.
 */
 class GF2mat
 {
@@ -300,6 +309,19 @@ public:
   //! Returns the number of linearly independent rows
   int row_rank() const;
 
+  /*! \brief Reduced row echelon form (Gauss-Jordan elimination)
+
+  The matrix is transformed in place by row operations to its reduced
+  row echelon form. The pivots are taken column by column from the
+  left, so that a column gets a pivot exactly when it is not a linear
+  combination of the columns before it. Row \a r of the result has its
+  leading one in column \c pivot_cols(r), which is the only one in
+  that column. The rows below the rank are zero.
+
+  The function returns the row rank of the matrix.
+  */
+  int rref(ivec &pivot_cols);
+
   /*! \brief TXP factorization.
 
   Given X, compute a factorization of the form U=TXP, where U is
@@ -402,16 +424,25 @@ public:
 
 private:
   int nrows, ncols;            // number of rows and columns of matrix
-  int nwords;                  // number of bytes used
-  Mat<unsigned char> data;   // data structure
+  int nwords;                  // number of 64-bit words in each row
+  Vec<uint64_t> data;          // data structure, nrows rows of nwords words
 
   // This value is used to perform division by bit shift and is equal to
-  // log2(8)
-  static const unsigned char shift_divisor = 3;
+  // log2(64)
+  static const unsigned char shift_divisor = 6;
 
   // This value is used as a mask when computing the bit position of the
   // division remainder
   static const unsigned char rem_mask = (1 << shift_divisor) - 1;
+
+  //! The words of row \a i
+  uint64_t *row_words(int i) { return data._data() + i * nwords; }
+  //! The words of row \a i
+  const uint64_t *row_words(int i) const { return data._data() + i * nwords; }
+  //! Clear the bits beyond column ncols in every row
+  void clear_tails();
+  //! Reduced row echelon form with pivots only in the first \a pivot_limit columns
+  int rref(ivec &pivot_cols, int pivot_limit);
 };
 
 
@@ -477,14 +508,14 @@ inline void GF2mat::addto_element(int i, int j, bin s)
   it_assert_debug(i >= 0 && i < nrows, "GF2mat::addto_element()");
   it_assert_debug(j >= 0 && j < ncols, "GF2mat::addto_element()");
   if (s == 1)
-    data(i, (j >> shift_divisor)) ^= (1 << (j & rem_mask));
+    data(i * nwords + (j >> shift_divisor)) ^= (uint64_t(1) << (j & rem_mask));
 }
 
 inline bin GF2mat::get(int i, int j) const
 {
   it_assert_debug(i >= 0 && i < nrows, "GF2mat::get_element()");
   it_assert_debug(j >= 0 && j < ncols, "GF2mat::get_element()");
-  return (data(i, (j >> shift_divisor)) >> (j & rem_mask)) & 1;
+  return static_cast<int>((data(i * nwords + (j >> shift_divisor)) >> (j & rem_mask)) & 1);
 }
 
 inline void GF2mat::set(int i, int j, bin s)
@@ -492,9 +523,9 @@ inline void GF2mat::set(int i, int j, bin s)
   it_assert_debug(i >= 0 && i < nrows, "GF2mat::set_element()");
   it_assert_debug(j >= 0 && j < ncols, "GF2mat::set_element()");
   if (s == 1) // set bit to one
-    data(i, (j >> shift_divisor)) |= (1 << (j & rem_mask));
+    data(i * nwords + (j >> shift_divisor)) |= (uint64_t(1) << (j & rem_mask));
   else // set bit to zero
-    data(i, (j >> shift_divisor)) &= (~(1 << (j & rem_mask)));
+    data(i * nwords + (j >> shift_divisor)) &= (~(uint64_t(1) << (j & rem_mask)));
 }
 
 } // namespace itpp
@@ -0,0 +1,358 @@
+/*!
+ * \file
+ * \brief Implementation of a packed binary vector class
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 1995-2010  (see AUTHORS file for a list of contributors)
+ *
+ * This file is part of IT++ - a C++ library of mathematical, signal
+ * processing, speech processing, and communications classes and functions.
+ *
+ * IT++ is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * IT++ is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with IT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <itpp/base/packed_bvec.h>
+#include <itpp/base/random.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+
+namespace itpp
+{
+
+//! \cond
+
+static inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__)
+  return __builtin_popcountll(x);
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// The first nbits bits of a word set, counting from the most significant bit
+static inline uint64_t top_mask(int nbits)
+{
+  return (nbits >= 64) ? ~uint64_t(0) : ~(~uint64_t(0) >> nbits);
+}
+
+//! \endcond
+
+
+Packed_Bvec::Packed_Bvec(int size): len(0)
+{
+  set_size(size);
+  zeros();
+}
+
+Packed_Bvec::Packed_Bvec(const bvec &v): len(0)
+{
+  set_size(v.size());
+  pack(v._data(), len, data._data());
+}
+
+void Packed_Bvec::set_size(int size, bool copy)
+{
+  it_assert_debug(size >= 0, "Packed_Bvec::set_size(): New size must not be negative");
+  int old_words = data.size();
+  int nwords = (size + 63) >> 6;
+  data.set_size(nwords, copy);
+  len = size;
+  if (copy) {
+    for (int w = old_words; w < nwords; w++) {
+      data(w) = 0;
+    }
+    clear_tail();
+  }
+}
+
+void Packed_Bvec::zeros()
+{
+  for (int w = 0; w < data.size(); w++) {
+    data(w) = 0;
+  }
+}
+
+void Packed_Bvec::ones()
+{
+  for (int w = 0; w < data.size(); w++) {
+    data(w) = ~uint64_t(0);
+  }
+  clear_tail();
+}
+
+void Packed_Bvec::set(int i, bin b)
+{
+  it_assert_debug((i >= 0) && (i < len), "Packed_Bvec::set(): index out of range");
+  uint64_t bit = uint64_t(1) << (63 - (i & 63));
+  if (b == bin(1))
+    data(i >> 6) |= bit;
+  else
+    data(i >> 6) &= ~bit;
+}
+
+void Packed_Bvec::clear_tail()
+{
+  if (len & 63) {
+    data(data.size() - 1) &= top_mask(len & 63);
+  }
+}
+
+bvec Packed_Bvec::to_bvec() const
+{
+  bvec v;
+  to_bvec(v);
+  return v;
+}
+
+void Packed_Bvec::to_bvec(bvec &v) const
+{
+  v.set_size(len, false);
+  unpack(data._data(), len, v._data());
+}
+
+Packed_Bvec Packed_Bvec::mid(int start, int nr) const
+{
+  it_assert_debug((start >= 0) && (nr >= 0) && (start + nr <= len),
+                  "Packed_Bvec::mid(): indexing out of range");
+  Packed_Bvec out;
+  out.set_size(nr);
+  int first = start >> 6;
+  int shift = start & 63;
+  int nwords = out.data.size();
+  int last = data.size() - 1;
+  if (shift == 0) {
+    for (int w = 0; w < nwords; w++) {
+      out.data(w) = data(first + w);
+    }
+  }
+  else {
+    for (int w = 0; w < nwords; w++) {
+      uint64_t word = data(first + w) << shift;
+      if (first + w < last) {
+        word |= data(first + w + 1) >> (64 - shift);
+      }
+      out.data(w) = word;
+    }
+  }
+  out.clear_tail();
+  return out;
+}
+
+void Packed_Bvec::set_subvector(int i, const Packed_Bvec &v)
+{
+  it_assert_debug((i >= 0) && (i + v.len <= len),
+                  "Packed_Bvec::set_subvector(): indexing out of range");
+  int shift = i & 63;
+  for (int w = 0; w < v.data.size(); w++) {
+    int nbits = (v.len - 64 * w < 64) ? v.len - 64 * w : 64;
+    uint64_t mask = top_mask(nbits);
+    uint64_t bits = v.data(w);
+    int q = (i >> 6) + w;
+    data(q) = (data(q) & ~(mask >> shift)) | (bits >> shift);
+    if (shift + nbits > 64) {
+      data(q + 1) = (data(q + 1) & ~(mask << (64 - shift))) | (bits << (64 - shift));
+    }
+  }
+}
+
+Packed_Bvec &Packed_Bvec::operator+=(const Packed_Bvec &v)
+{
+  it_assert_debug(len == v.len, "Packed_Bvec::operator+=(): sizes do not match");
+  uint64_t *p = data._data();
+  const uint64_t *q = v.data._data();
+  int nwords = data.size();
+  int w = 0;
+#if defined(__SSE2__)
+  for (; w + 2 <= nwords; w += 2) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + w));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(q + w));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + w), _mm_xor_si128(a, b));
+  }
+#endif
+  for (; w < nwords; w++) {
+    p[w] ^= q[w];
+  }
+  return *this;
+}
+
+Packed_Bvec &Packed_Bvec::operator&=(const Packed_Bvec &v)
+{
+  it_assert_debug(len == v.len, "Packed_Bvec::operator&=(): sizes do not match");
+  uint64_t *p = data._data();
+  const uint64_t *q = v.data._data();
+  int nwords = data.size();
+  int w = 0;
+#if defined(__SSE2__)
+  for (; w + 2 <= nwords; w += 2) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + w));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(q + w));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + w), _mm_and_si128(a, b));
+  }
+#endif
+  for (; w < nwords; w++) {
+    p[w] &= q[w];
+  }
+  return *this;
+}
+
+Packed_Bvec operator+(const Packed_Bvec &a, const Packed_Bvec &b)
+{
+  Packed_Bvec r(a);
+  r += b;
+  return r;
+}
+
+Packed_Bvec operator^(const Packed_Bvec &a, const Packed_Bvec &b)
+{
+  Packed_Bvec r(a);
+  r += b;
+  return r;
+}
+
+Packed_Bvec operator&(const Packed_Bvec &a, const Packed_Bvec &b)
+{
+  Packed_Bvec r(a);
+  r &= b;
+  return r;
+}
+
+bool Packed_Bvec::operator==(const Packed_Bvec &v) const
+{
+  if (len != v.len)
+    return false;
+  for (int w = 0; w < data.size(); w++) {
+    if (data(w) != v.data(w))
+      return false;
+  }
+  return true;
+}
+
+int Packed_Bvec::weight() const
+{
+  int n = 0;
+  for (int w = 0; w < data.size(); w++) {
+    n += popcount64(data(w));
+  }
+  return n;
+}
+
+int Packed_Bvec::hamming_distance(const Packed_Bvec &v) const
+{
+  it_assert_debug(len == v.len, "Packed_Bvec::hamming_distance(): sizes do not match");
+  int n = 0;
+  for (int w = 0; w < data.size(); w++) {
+    n += popcount64(data(w) ^ v.data(w));
+  }
+  return n;
+}
+
+void Packed_Bvec::pack(const bin *bits, int nbits, uint64_t *words)
+{
+  int w = 0;
+  for (; 64 * w + 64 <= nbits; w++) {
+    const bin *b = bits + 64 * w;
+    uint64_t word = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (int h = 0; h < 4; h++) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 16 * h));
+      // reverse the 16 bytes, so that the first bit is the top bit of the mask
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+      v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)),
+                              _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      word = (word << 16) | static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, zero)));
+    }
+#else
+    for (int l = 0; l < 64; l++) {
+      word = (word << 1) | static_cast<uint64_t>(static_cast<int>(b[l]));
+    }
+#endif
+    words[w] = word;
+  }
+  if (64 * w < nbits) {
+    uint64_t word = 0;
+    for (int l = 64 * w; l < nbits; l++) {
+      word |= static_cast<uint64_t>(static_cast<int>(bits[l])) << (63 - (l & 63));
+    }
+    words[w] = word;
+  }
+}
+
+void Packed_Bvec::unpack(const uint64_t *words, int nbits, bin *bits)
+{
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128i mask = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                    1, 2, 4, 8, 16, 32, 64, -128);
+  const __m128i one = _mm_set1_epi8(1);
+  for (; i + 16 <= nbits; i += 16) {
+    int chunk = static_cast<int>((words[i >> 6] >> (48 - (i & 63))) & 0xffff);
+    // the first eight bits in the low half, the next eight in the high half
+    __m128i v = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(chunk >> 8)),
+                                   _mm_set1_epi8(static_cast<char>(chunk & 255)));
+    v = _mm_cmpeq_epi8(_mm_and_si128(v, mask), mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(bits + i), _mm_and_si128(v, one));
+  }
+#endif
+  for (; i < nbits; i++) {
+    bits[i] = static_cast<int>((words[i >> 6] >> (63 - (i & 63))) & 1);
+  }
+}
+
+Packed_Bvec concat(const Packed_Bvec &a, const Packed_Bvec &b)
+{
+  Packed_Bvec r(a);
+  r.set_size(a.size() + b.size(), true);
+  r.set_subvector(a.size(), b);
+  return r;
+}
+
+void randb(int size, Packed_Bvec &out)
+{
+  Random_Generator RNG;
+  out.set_size(size);
+  uint64_t *p = out._data();
+  for (int w = 0; w < out.words(); w++) {
+    uint64_t hi = RNG.random_int();
+    p[w] = (hi << 32) | RNG.random_int();
+  }
+  if (size & 63) {
+    p[out.words() - 1] &= ~(~uint64_t(0) >> (size & 63));
+  }
+}
+
+std::ostream &operator<<(std::ostream &os, const Packed_Bvec &v)
+{
+  os << "[";
+  for (int i = 0; i < v.size(); i++) {
+    os << v(i);
+    if (i < v.size() - 1)
+      os << " ";
+  }
+  os << "]";
+  return os;
+}
+
+} // namespace itpp
@@ -0,0 +1,185 @@
+/*!
+ * \file
+ * \brief Definition of a packed binary vector class
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 1995-2010  (see AUTHORS file for a list of contributors)
+ *
+ * This file is part of IT++ - a C++ library of mathematical, signal
+ * processing, speech processing, and communications classes and functions.
+ *
+ * IT++ is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * IT++ is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with IT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef PACKED_BVEC_H
+#define PACKED_BVEC_H
+
+#include <itpp/base/vec.h>
+#include <itpp/base/ittypes.h>
+#include <iostream>
+
+
+namespace itpp
+{
+
+/*!
+  \brief Binary vector stored with one bit per bit
+  \ingroup arr_vec_mat
+
+  A \c bvec uses one byte for each element. Packed_Bvec stores 64 bits in
+  each word, so that it takes eight times less memory, and additions
+  (XOR), products (AND) and weights are computed a word at a time.
+
+  Bit \a i is bit 63 - (\a i mod 64) of word \a i / 64, that is the
+  first bit of the vector is the most significant bit of the first word.
+  The unused bits of the last word are always zero.
+
+  Example:
+  \code
+  Packed_Bvec a(randb(1000)), b;
+  randb(1000, b);
+  int errors = (a + b).weight();
+  bvec c = b.to_bvec();
+  \endcode
+*/
+class Packed_Bvec
+{
+public:
+  //! Default constructor
+  Packed_Bvec(): len(0) {}
+  //! Create a vector of \a size zeros
+  explicit Packed_Bvec(int size);
+  //! Create a vector with the bits of \a v
+  Packed_Bvec(const bvec &v);
+
+  //! Set the size of the vector. New bits are zero if \a copy is true.
+  void set_size(int size, bool copy = false);
+  //! Return the number of bits
+  int size() const { return len; }
+  //! Return the number of bits
+  int length() const { return len; }
+  //! Return the number of 64-bit words
+  int words() const { return data.size(); }
+  //! Set all bits to zero
+  void zeros();
+  //! Set all bits to one
+  void ones();
+
+  //! Get bit \a i
+  bin get(int i) const {
+    it_assert_debug((i >= 0) && (i < len), "Packed_Bvec::get(): index out of range");
+    return static_cast<int>((data(i >> 6) >> (63 - (i & 63))) & 1);
+  }
+  //! Get bit \a i
+  bin operator()(int i) const { return get(i); }
+  //! Set bit \a i to \a b
+  void set(int i, bin b);
+  //! Invert bit \a i
+  void flip(int i) {
+    it_assert_debug((i >= 0) && (i < len), "Packed_Bvec::flip(): index out of range");
+    data(i >> 6) ^= uint64_t(1) << (63 - (i & 63));
+  }
+
+  //! Convert to a bvec
+  bvec to_bvec() const;
+  //! Convert to a bvec
+  void to_bvec(bvec &v) const;
+
+  //! Get the bits from \a i1 to \a i2 (inclusive)
+  Packed_Bvec operator()(int i1, int i2) const { return mid(i1, i2 - i1 + 1); }
+  //! Get \a nr bits starting at bit \a start
+  Packed_Bvec mid(int start, int nr) const;
+  //! Get the first \a nr bits
+  Packed_Bvec left(int nr) const { return mid(0, nr); }
+  //! Get the last \a nr bits
+  Packed_Bvec right(int nr) const { return mid(len - nr, nr); }
+  //! Replace the bits from \a i with those of \a v
+  void set_subvector(int i, const Packed_Bvec &v);
+
+  //! Add (XOR) \a v to this vector
+  Packed_Bvec &operator+=(const Packed_Bvec &v);
+  //! Add (XOR) \a v to this vector
+  Packed_Bvec &operator^=(const Packed_Bvec &v) { return operator+=(v); }
+  //! Multiply (AND) this vector with \a v element by element
+  Packed_Bvec &operator&=(const Packed_Bvec &v);
+  //! Sum (XOR) of two vectors
+  friend Packed_Bvec operator+(const Packed_Bvec &a, const Packed_Bvec &b);
+  //! Sum (XOR) of two vectors
+  friend Packed_Bvec operator^(const Packed_Bvec &a, const Packed_Bvec &b);
+  //! Element-wise product (AND) of two vectors
+  friend Packed_Bvec operator&(const Packed_Bvec &a, const Packed_Bvec &b);
+  //! Equality of size and all bits
+  bool operator==(const Packed_Bvec &v) const;
+  //! Inequality
+  bool operator!=(const Packed_Bvec &v) const { return !(*this == v); }
+
+  //! Number of ones
+  int weight() const;
+  //! Number of positions where this vector and \a v differ
+  int hamming_distance(const Packed_Bvec &v) const;
+
+  //! Access to the words
+  uint64_t *_data() { return data._data(); }
+  //! Access to the words
+  const uint64_t *_data() const { return data._data(); }
+
+  /*!
+    \brief Pack \a nbits bits into words, the first bit in the most significant bit
+
+    The unused bits of the last word are set to zero. Uses SSE2 when
+    available.
+  */
+  static void pack(const bin *bits, int nbits, uint64_t *words);
+  //! Unpack \a nbits bits from words, the first bit in the most significant bit
+  static void unpack(const uint64_t *words, int nbits, bin *bits);
+
+private:
+  //! Number of bits
+  int len;
+  //! The bits, 64 in each word
+  Vec<uint64_t> data;
+  //! Clear the unused bits of the last word
+  void clear_tail();
+};
+
+//! Concatenate two packed binary vectors
+Packed_Bvec concat(const Packed_Bvec &a, const Packed_Bvec &b);
+
+//! Number of ones in \a v
+inline int weight(const Packed_Bvec &v) { return v.weight(); }
+
+//! Number of positions where \a a and \a b differ
+inline int hamming_distance(const Packed_Bvec &a, const Packed_Bvec &b)
+{
+  return a.hamming_distance(b);
+}
+
+/*!
+  \brief Fill \a out with \a size equiprobable random bits
+  \ingroup randgen
+
+  The bits are taken 32 at a time from the global random number
+  generator, so the sequence differs from that of randb(int, bvec &).
+*/
+void randb(int size, Packed_Bvec &out);
+
+//! Output stream of a packed binary vector, in the format of bvec
+std::ostream &operator<<(std::ostream &os, const Packed_Bvec &v);
+
+} // namespace itpp
+
+#endif // #ifndef PACKED_BVEC_H
@@ -20,6 +20,7 @@ h_base_sources = \
 	$(top_srcdir)/itpp/base/matfunc.h \
 	$(top_srcdir)/itpp/base/mat.h \
 	$(top_srcdir)/itpp/base/operators.h \
+	$(top_srcdir)/itpp/base/packed_bvec.h \
 	$(top_srcdir)/itpp/base/parser.h \
 	$(top_srcdir)/itpp/base/random.h \
 	$(top_srcdir)/itpp/base/random_dsfmt.h \
@@ -46,6 +47,7 @@ cpp_base_sources = \
 	$(top_srcdir)/itpp/base/mat.cpp \
 	$(top_srcdir)/itpp/base/matfunc.cpp \
 	$(top_srcdir)/itpp/base/operators.cpp \
+	$(top_srcdir)/itpp/base/packed_bvec.cpp \
 	$(top_srcdir)/itpp/base/parser.cpp \
 	$(top_srcdir)/itpp/base/random.cpp \
 	$(top_srcdir)/itpp/base/smat.cpp \
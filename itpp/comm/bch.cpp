@@ -30,12 +30,59 @@
 #include <itpp/base/binary.h>
 #include <itpp/base/specmat.h>
 #include <itpp/base/array.h>
+#include <itpp/base/packed_bvec.h>
+#include <algorithm>
+
 
 namespace itpp
 {
 
 //---------------------- BCH -----------------------------------
 
+//! \cond
+
+// The remainder register of BCH::decode() over nbytes bytes of a packed
+// word: each byte is shifted in with one lookup in table
+static void g_remainder(const uint64_t *word, int nbytes, const uint64_t *table,
+                        uint64_t *rem, int nwords)
+{
+  for (int w = 0; w < nwords; w++) {
+    rem[w] = 0;
+  }
+  for (int b = 0; b < nbytes; b++) {
+    int byte = static_cast<int>((word[b >> 3] >> (56 - 8 * (b & 7))) & 255);
+    const uint64_t *entry = table + nwords * (static_cast<int>(rem[0] >> 56) ^ byte);
+    for (int w = 0; w < nwords - 1; w++) {
+      rem[w] = ((rem[w] << 8) | (rem[w + 1] >> 56)) ^ entry[w];
+    }
+    rem[nwords - 1] = (rem[nwords - 1] << 8) ^ entry[nwords - 1];
+  }
+}
+
+// The same with a register of NWORDS words, kept in local variables
+template<int NWORDS>
+static void g_remainder(const uint64_t *word, int nbytes, const uint64_t *table,
+                        uint64_t *rem)
+{
+  uint64_t r[NWORDS];
+  for (int w = 0; w < NWORDS; w++) {
+    r[w] = 0;
+  }
+  for (int b = 0; b < nbytes; b++) {
+    int byte = static_cast<int>((word[b >> 3] >> (56 - 8 * (b & 7))) & 255);
+    const uint64_t *entry = table + NWORDS * (static_cast<int>(r[0] >> 56) ^ byte);
+    for (int w = 0; w < NWORDS - 1; w++) {
+      r[w] = ((r[w] << 8) | (r[w + 1] >> 56)) ^ entry[w];
+    }
+    r[NWORDS - 1] = (r[NWORDS - 1] << 8) ^ entry[NWORDS - 1];
+  }
+  for (int w = 0; w < NWORDS; w++) {
+    rem[w] = r[w];
+  }
+}
+
+//! \endcond
+
 BCH::BCH(int in_n, int in_k, int in_t, const ivec &genpolynom, bool sys):
     n(in_n), k(in_k), t(in_t), systematic(sys)
 {
@@ -46,6 +93,7 @@ BCH::BCH(int in_n, int in_k, int in_t, const ivec &genpolynom, bool sys):
     exponents(i) = static_cast<int>(temp(temp.length() - i - 1)) - 1;
   }
   g.set(n + 1, exponents);
+  init_decoder();
 }
 
 BCH::BCH(int in_n, int in_t, bool sys):
@@ -144,6 +192,152 @@ BCH::BCH(int in_n, int in_t, bool sys):
 
   // finally determine k
   k = n - g.get_true_degree();
+  init_decoder();
+}
+
+void BCH::init_decoder()
+{
+  int q = n + 1;
+
+  // the tables of the field share the mapping of the GF class
+  field.set_size(q);
+
+  // x^(n-k) v(x) mod g(x) for all bytes v(x), computed one bit at a time.
+  // Shifting a byte of r(x) into a remainder register then takes one
+  // lookup, and the register ends with x^(n-k) r(x) mod g(x), which is
+  // zero exactly when g(x) divides r(x).
+  int deg_g = n - k;
+  rem_words = (deg_g + 63) / 64;
+  Vec<uint64_t> g_low(rem_words);
+  g_low.zeros();
+  for (int i = 0; i < deg_g; i++) {
+    if (g[deg_g - 1 - i].get_value() == 0) {
+      g_low(i >> 6) |= uint64_t(1) << (63 - (i & 63));
+    }
+  }
+  g_table.set_size(256 * rem_words);
+  for (int v = 0; v < 256; v++) {
+    uint64_t *rem = g_table._data() + v * rem_words;
+    for (int w = 0; w < rem_words; w++) {
+      rem[w] = 0;
+    }
+    for (int b = 7; b >= 0; b--) {
+      bool feedback = ((rem[0] >> 63) ^ ((v >> b) & 1)) != 0;
+      for (int w = 0; w < rem_words - 1; w++) {
+        rem[w] = (rem[w] << 1) | (rem[w + 1] >> 63);
+      }
+      rem[rem_words - 1] <<= 1;
+      if (feedback) {
+        for (int w = 0; w < rem_words; w++) {
+          rem[w] ^= g_low(w);
+        }
+      }
+    }
+  }
+
+  // one shift register per cyclotomic coset of the odd powers alpha^j,
+  // j < 2t, dividing by the minimal polynomial M(x) of the coset. A
+  // polynomial of degree d < 8 is replaced by x^(8-d) M(x), which has the
+  // same roots alpha^j, so that a whole byte can be shifted in. These
+  // registers are fed with the 64 rem_words bits of the remainder modulo
+  // g(x), of the word followed by pad zeros, so the syndromes of r(x) are
+  // scaled by alpha^(-j (64 rem_words + pad)).
+  int pad = (8 - n % 8) % 8;
+  ivec leaders(t);
+  rem_degree.set_size(t);
+  rem_tables.set_size(256 * t);
+  syn_register.set_size(t);
+  syn_tables.set_size(512 * t);
+  int nregisters = 0;
+  for (int i = 0; i < t; i++) {
+    int j = 2 * i + 1;
+    int leader = j, d = 0;
+    int e = j;
+    do {
+      leader = std::min(leader, e);
+      e = (2 * e) % n;
+      d++;
+    }
+    while (e != j);
+
+    int r = 0;
+    while ((r < nregisters) && (leaders(r) != leader)) {
+      r++;
+    }
+    if (r == nregisters) {
+      // M(x) = prod (x - alpha^e) over the coset, with binary coefficients
+      Vec<uint16_t> poly(d + 1);
+      poly.zeros();
+      poly(0) = 1;
+      e = j;
+      for (int l = 0; l < d; l++) {
+        for (int c = l + 1; c > 0; c--) {
+          poly(c) = poly(c - 1) ^ field.mul(poly(c), field.alpha_pow(e));
+        }
+        poly(0) = field.mul(poly(0), field.alpha_pow(e));
+        e = (2 * e) % n;
+      }
+      int deg = std::max(d, 8);
+      int minpoly = 0;
+      for (int c = 0; c <= d; c++) {
+        it_assert(poly(c) <= 1, "BCH::init_decoder(): minimal polynomial is not binary");
+        minpoly |= poly(c) << (c + deg - d);
+      }
+      for (int v = 0; v < 256; v++) {
+        int rem = v << deg;
+        for (int b = deg + 7; b >= deg; b--) {
+          if ((rem >> b) & 1) {
+            rem ^= minpoly << (b - deg);
+          }
+        }
+        rem_tables(256 * r + v) = static_cast<uint16_t>(rem);
+      }
+      leaders(r) = leader;
+      rem_degree(r) = deg;
+      nregisters++;
+    }
+    syn_register(i) = r;
+
+    // S_j = rem(alpha^j), one table for each byte of the remainder
+    int scale = n - static_cast<int>((static_cast<uint64_t>(j)
+                                      * (64 * rem_words + pad)) % n);
+    for (int h = 0; h < 2; h++) {
+      for (int v = 0; v < 256; v++) {
+        int sum = 0;
+        for (int b = 0; (b < 8) && (8 * h + b < rem_degree(r)); b++) {
+          if ((v >> b) & 1) {
+            sum ^= field.alpha_pow((j * (8 * h + b) + scale) % n);
+          }
+        }
+        syn_tables(512 * i + 256 * h + v) = static_cast<uint16_t>(sum);
+      }
+    }
+  }
+  rem_degree.set_size(nregisters, true);
+  rem_tables.set_size(256 * nregisters, true);
+
+  // g(x) with its coefficient of x^(n-k) in bit s, for all offsets s
+  g_words = (n - k + 64) / 64 + 1;
+  g_shifted.set_size(64 * g_words);
+  g_shifted.zeros();
+  for (int s = 0; s < 64; s++) {
+    for (int i = 0; i <= n - k; i++) {
+      if (g[n - k - i].get_value() == 0) {
+        int pos = s + i;
+        g_shifted(s * g_words + (pos >> 6)) |= uint64_t(1) << (63 - (pos & 63));
+      }
+    }
+  }
+
+  packed.set_size((n + 63) / 64 + g_words);
+  packed.zeros();
+  g_rem.set_size(rem_words);
+  remainders.set_size(nregisters);
+  syndromes.set_size(2 * t + 1);
+  lambda.set_size(2 * t + 3);
+  old_lambda.set_size(2 * t + 3);
+  t_poly.set_size(2 * t + 3);
+  chien_values.set_size(64);
 }
 
 
@@ -205,113 +399,188 @@ bvec BCH::encode(const bvec &uncoded_bits)
   return coded_bits;
 }
 
+bool BCH::correct_errors()
+{
+  // Berlekamp-Massey for binary codes, t iterations
+  lambda.zeros();
+  t_poly.zeros();
+  lambda(0) = t_poly(0) = 1;
+  int deg_lambda = 0, deg_t = 0;
+  for (int kk = 0; kk < t; kk++) {
+    // delta is the coefficient of x^(2kk+1) in Lambda(x) (1 + S(x))
+    uint16_t delta = 0;
+    for (int i = 0; i <= std::min(deg_lambda, 2 * kk + 1); i++) {
+      delta ^= field.mul(lambda(i), syndromes(2 * kk + 1 - i));
+    }
+    int old_deg = deg_lambda;
+    for (int i = 0; i <= old_deg; i++) {
+      old_lambda(i) = lambda(i);
+    }
+    // Lambda(x) += delta x T(x)
+    if (delta != 0) {
+      for (int i = 0; i <= deg_t; i++) {
+        lambda(i + 1) ^= field.mul(delta, t_poly(i));
+      }
+      deg_lambda = std::max(deg_lambda, deg_t + 1);
+      while ((deg_lambda > 0) && (lambda(deg_lambda) == 0)) {
+        deg_lambda--;
+      }
+    }
+    if ((delta == 0) || (old_deg > kk)) {
+      // T(x) = x^2 T(x)
+      for (int i = deg_t; i >= 0; i--) {
+        t_poly(i + 2) = t_poly(i);
+      }
+      t_poly(0) = t_poly(1) = 0;
+      deg_t += 2;
+    }
+    else {
+      // T(x) = x Lambda_old(x) / delta
+      int scale = n - field.log_alpha(delta);
+      t_poly.zeros();
+      for (int i = 0; i <= old_deg; i++) {
+        if (old_lambda(i) != 0) {
+          t_poly(i + 1) = field.alpha_pow(field.log_alpha(old_lambda(i))
+                                          + scale);
+        }
+      }
+      deg_t = old_deg + 1;
+    }
+  }
+
+  // Chien search on blocks of points: alpha^j is a root when bit
+  // j - 1 (mod n) of the word is in error, and the syndromes are updated
+  // with every correction
+  int found = 0;
+  for (int j0 = 0; (j0 < n) && (found < deg_lambda); j0 += 64) {
+    int npoints = std::min(64, n - j0);
+    field.eval_poly(lambda._data(), deg_lambda, field.alpha_pow_table() + j0,
+                    chien_values._data(), npoints);
+    for (int l = 0; (l < npoints) && (found < deg_lambda); l++) {
+      if (chien_values(l) == 0) {
+        int j = j0 + l;
+        int idx = (j + n - 1) % n;
+        packed(idx >> 6) ^= uint64_t(1) << (63 - (idx & 63));
+        int pos = (n - j) % n;
+        int e = 0;
+        for (int s = 1; s <= 2 * t; s++) {
+          e += pos;
+          e -= (e >= n) ? n : 0;
+          syndromes(s) ^= field.alpha_pow(e);
+        }
+        found++;
+      }
+    }
+  }
+
+  // the corrected word must be a codeword
+  for (int s = 1; s <= 2 * t; s++) {
+    if (syndromes(s) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void BCH::decode(const bvec &coded_bits, bvec &decoded_bits)
 {
-  int j, i, degree, kk, foundzeros, cisvalid;
   int iterations = floor_i(static_cast<double>(coded_bits.length()) / n);
-  bvec rbin(n), mbin(k);
   decoded_bits.set_size(iterations*k, false);
 
-  GFX r(n + 1, n - 1), c(n + 1, n - 1), m(n + 1, k - 1), S(n + 1, 2*t), Lambda(n + 1),
-  OldLambda(n + 1), T(n + 1), Ohmega(n + 1), One(n + 1, (char*)"0");
-  GF delta(n + 1);
-  ivec errorpos;
-
-  for (i = 0; i < iterations; i++) {
-    //Fix the received polynomial r(x)
-    rbin = coded_bits.mid(i * n, n);
-    for (j = 0; j < n; j++) {
-      degree = static_cast<int>(rbin(n - j - 1)) - 1;
-      // reverse mapping, see encode(.)
-      r[j] = GF(n + 1, degree);
+  int nbytes = (n + 7) / 8;
+  int nregisters = rem_degree.size();
+
+  for (int i = 0; i < iterations; i++) {
+    const bin *in = coded_bits._data() + i * n;
+    bin *out = decoded_bits._data() + i * k;
+
+    // pack the received bits, first bit in the most significant bit and
+    // zeros up to a whole word at the end
+    Packed_Bvec::pack(in, n, packed._data());
+
+    // x^(n-k) r(x) mod g(x)
+    uint64_t *rem = g_rem._data();
+    switch (rem_words) {
+    case 1:
+      g_remainder<1>(packed._data(), nbytes, g_table._data(), rem);
+      break;
+    case 2:
+      g_remainder<2>(packed._data(), nbytes, g_table._data(), rem);
+      break;
+    case 3:
+      g_remainder<3>(packed._data(), nbytes, g_table._data(), rem);
+      break;
+    default:
+      g_remainder(packed._data(), nbytes, g_table._data(), rem, rem_words);
     }
-    //Fix the syndrome polynomial S(x).
-    S[0] = GF(n + 1, -1);
-    for (j = 1; j <= 2*t; j++) {
-      S[j] =  r(GF(n + 1, j));
+    bool errors = false;
+    for (int w = 0; w < rem_words; w++) {
+      errors |= (rem[w] != 0);
     }
-    if (S.get_true_degree() >= 1) { //Errors in the received word
-      //Iterate to find Lambda(x).
-      kk = 0;
-      Lambda = GFX(n + 1, (char*)"0");
-      T = GFX(n + 1, (char*)"0");
-      while (kk < t) {
-        Ohmega = Lambda * (S + One);
-        delta = Ohmega[2*kk+1];
-        OldLambda = Lambda;
-        Lambda = OldLambda + delta * (GFX(n + 1, (char*)"-1 0") * T);
-        if ((delta == GF(n + 1, -1)) || (OldLambda.get_true_degree() > kk)) {
-          T = GFX(n + 1, (char*)"-1 -1 0") * T;
-        }
-        else {
-          T = (GFX(n + 1, (char*)"-1 0") * OldLambda) / delta;
+
+    bool valid = true;
+    if (errors) {
+      // remainders modulo the minimal polynomials
+      remainders.zeros();
+      for (int b = 0; b < 8 * rem_words; b++) {
+        int byte = static_cast<int>((rem[b >> 3] >> (56 - 8 * (b & 7))) & 255);
+        for (int r = 0; r < nregisters; r++) {
+          int deg = rem_degree(r);
+          int rem_r = remainders(r);
+          remainders(r) = static_cast<uint16_t>(((rem_r << 8) & ((1 << deg) - 1))
+                                                ^ rem_tables(256 * r + (rem_r >> (deg - 8)))
+                                                ^ byte);
         }
-        kk = kk + 1;
       }
-      //Find the zeros to Lambda(x).
-      errorpos.set_size(Lambda.get_true_degree(), true);
-      foundzeros = 0;
-      for (j = 0; j <= n - 1; j++) {
-        if (Lambda(GF(n + 1, j)) == GF(n + 1, -1)) {
-          errorpos(foundzeros) = (n - j) % n;
-          foundzeros += 1;
-          if (foundzeros >= Lambda.get_true_degree()) {
-            break;
-          }
+
+      // S_j for j = 1..2t, with S_2j = S_j^2
+      syndromes(0) = 1;
+      errors = false;
+      for (int j = 1; j <= 2 * t; j++) {
+        if (j & 1) {
+          int rem_r = remainders(syn_register(j / 2));
+          const uint16_t *table = syn_tables._data() + 512 * (j / 2);
+          syndromes(j) = table[rem_r & 255] ^ table[256 + (rem_r >> 8)];
         }
+        else {
+          syndromes(j) = field.mul(syndromes(j / 2), syndromes(j / 2));
+        }
+        errors |= (syndromes(j) != 0);
       }
-      //Correct the codeword.
-      for (j = 0; j < foundzeros; j++) {
-        rbin(n - errorpos(j) - 1) += 1;  // again, reverse mapping
-      }
-      //Reconstruct the corrected codeword.
-      for (j = 0; j < n; j++) {
-        degree = static_cast<int>(rbin(n - j - 1)) - 1;
-        c[j] = GF(n + 1, degree);
+      if (errors) {
+        valid = correct_errors();
       }
-      //Code word validation.
-      S[0] = GF(n + 1, -1);
-      for (j = 1; j <= 2*t; j++) {
-        S[j] =  c(GF(n + 1, j));
+    }
+
+    //Construct the message bit vector.
+    if (!valid) { //Decoder failure.
+      for (int p = 0; p < k; p++) {
+        out[p] = 0;
       }
-      if (S.get_true_degree() <= 0) { //c(x) is a valid codeword.
-        cisvalid = true;
+    }
+    else if (systematic && !errors) {
+      for (int p = 0; p < k; p++) {
+        out[p] = in[p];
       }
-      else {
-        cisvalid = false;
+    }
+    else if (systematic) {
+      for (int p = 0; p < k; p++) {
+        out[p] = static_cast<int>((packed(p >> 6) >> (63 - (p & 63))) & 1);
       }
     }
     else {
-      c = r;
-      cisvalid = true;
-    }
-    //Construct the message bit vector.
-    if (cisvalid) { //c(x) is a valid codeword.
-      if (c.get_true_degree() > 1) {
-        if (systematic) {
-          for (j = 0; j < k; j++)
-            m[j] = c[n-k+j];
+      // m(x) = c(x) / g(x), one bit of the quotient at a time
+      uint64_t *c = packed._data();
+      for (int p = 0; p < k; p++) {
+        uint64_t *cw = c + (p >> 6);
+        uint64_t q = (cw[0] >> (63 - (p & 63))) & 1;
+        const uint64_t *gs = g_shifted._data() + (p & 63) * g_words;
+        for (int l = 0; l < g_words; l++) {
+          cw[l] ^= gs[l] & (0 - q);
         }
-        else {
-          m = divgfx(c, g);
-        }
-        mbin.clear();
-        for (j = 0; j <= m.get_true_degree(); j++) {
-          if (m[j] == GF(n + 1, 0)) {
-            mbin(k - j - 1) = 1;
-          }
-        }
-      }
-      else { //The zero word was transmitted
-        mbin = zeros_b(k);
-        m = GFX(n + 1, (char*)"-1");
+        out[p] = static_cast<int>(q);
       }
     }
-    else { //Decoder failure.
-      mbin = zeros_b(k);
-      m = GFX(n + 1, (char*)"-1");
-    }
-    decoded_bits.replace_mid(i*k, mbin);
   }
 }
 
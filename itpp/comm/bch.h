@@ -55,6 +55,15 @@ namespace itpp
   uses the generator polynomial
   \f$g(x) = x^{10} + x^9 + x^8 + x^6 + x^5 + x^3 + 1\f$, and is capable of
   correcting 2 errors with \a n = 31 and \a k = 21.
+
+  The decoder packs the received bits and divides them byte by byte by
+  \f$g(x)\f$ with a table-driven shift register. When the remainder is
+  zero the word is accepted at once, which is the common case for outer
+  codes at high SNR. Otherwise the remainder is divided by the minimal
+  polynomials of \f$\alpha, \alpha^3, \ldots, \alpha^{2t-1}\f$ in
+  the same way, the syndromes are read off these short remainders, and
+  the error locator polynomial is found with Berlekamp-Massey and
+  evaluated at blocks of points for the Chien search.
 */
 class BCH : public Channel_Code
 {
@@ -84,6 +93,11 @@ public:
   //! Destructor
   virtual ~BCH() { }
 
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
+
   //! Encode a bvec of indata
   virtual void encode(const bvec &uncoded_bits, bvec &coded_bits);
   //! Encode a bvec of indata
@@ -101,6 +115,9 @@ public:
   //! Get the code rate
   virtual double get_rate() const {return static_cast<double>(k) / n; }
 
+  //! Create a copy of the codec (used by \c decode_batch())
+  virtual Channel_Code *clone() const { return new BCH(*this); }
+
   //! Get cardinality of code k
   virtual int get_k() const {return k; }
 
@@ -111,6 +128,40 @@ private:
   int n, k, t;
   GFX g;
   const bool systematic;
+
+  /*! \name Table-driven decoder
+    Field elements are stored as integers in the vector space
+    representation of GF::get_vectorspace().
+    @{ */
+  //! Field arithmetic (tables of alpha, products, Chien search)
+  GF_Bulk field;
+  //! Number of words of a remainder modulo g(x)
+  int rem_words;
+  //! x^(n-k) times each byte modulo g(x), left-aligned in rem_words words (256 entries)
+  Vec<uint64_t> g_table;
+  //! Degree of the polynomial of each minimal polynomial shift register (at least 8)
+  ivec rem_degree;
+  //! x^degree times each byte, modulo the polynomial of each shift register (256 entries each)
+  Vec<uint16_t> rem_tables;
+  //! Shift register of each odd syndrome
+  ivec syn_register;
+  //! Contribution of the low and high byte of a remainder to each odd syndrome (512 entries each)
+  Vec<uint16_t> syn_tables;
+  //! Generator polynomial, highest degree first, at all 64 bit offsets
+  Vec<uint64_t> g_shifted;
+  //! Number of words of each shifted generator polynomial
+  int g_words;
+  //! Received word, packed with the first bit in the most significant bit and padded with zeros
+  Vec<uint64_t> packed;
+  //! Remainder of the received word modulo g(x)
+  Vec<uint64_t> g_rem;
+  //! Working buffers of the decoder
+  Vec<uint16_t> remainders, syndromes, lambda, old_lambda, t_poly, chien_values;
+  //! Build the tables of the decoder
+  void init_decoder();
+  //! Correct the packed word, given its syndromes. Returns false on a decoder failure.
+  bool correct_errors();
+  /*! @} */
 };
 
 } // namespace itpp
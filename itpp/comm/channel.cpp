@@ -1540,6 +1540,32 @@ bvec BSC::operator()(const bvec &input)
   return output;
 }
 
+Packed_Bvec BSC::operator()(const Packed_Bvec &input)
+{
+  Packed_Bvec output(input);
+  int length = input.length();
+  if (p <= 0.0) {
+    return output;
+  }
+  if (p >= 1.0) {
+    Packed_Bvec all_ones(length);
+    all_ones.ones();
+    output += all_ones;
+    return output;
+  }
+
+  // P(gap = g) = p (1-p)^g, drawn by inversion
+  double scale = 1.0 / std::log(1.0 - p);
+  double pos = -1.0;
+  while (true) {
+    pos += 1.0 + std::floor(std::log(1.0 - u()) * scale);
+    if (pos >= length)
+      break;
+    output.flip(static_cast<int>(pos));
+  }
+  return output;
+}
+
 
 // --------------------------------------------------------------------------
 // AWGN_Channel class methods
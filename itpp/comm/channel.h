@@ -33,6 +33,7 @@
 #include <itpp/base/mat.h>
 #include <itpp/base/array.h>
 #include <itpp/base/random.h>
+#include <itpp/base/packed_bvec.h>
 #include <itpp/signal/filter.h>
 
 /*!
@@ -999,6 +1000,10 @@ protected:
     bvec received_bits = bsc(transmitted_bits);
   }
   \endcode
+
+  For a Packed_Bvec input only the error positions are drawn: the gaps
+  between them are geometrically distributed, so that one random number
+  is used per error instead of one per bit.
 */
 class BSC
 {
@@ -1011,6 +1016,8 @@ public:
   double get_prob() const { return p; };
   //! Feed \a input through the BSC channel
   bvec operator()(const bvec &input);
+  //! Feed the packed \a input through the BSC channel
+  Packed_Bvec operator()(const Packed_Bvec &input);
 private:
   Uniform_RNG u;
   double p;
@@ -0,0 +1,107 @@
+/*!
+ * \file
+ * \brief Implementation of the batch decoding of the Channel Code class
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 1995-2010  (see AUTHORS file for a list of contributors)
+ *
+ * This file is part of IT++ - a C++ library of mathematical, signal
+ * processing, speech processing, and communications classes and functions.
+ *
+ * IT++ is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * IT++ is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with IT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <itpp/comm/channel_code.h>
+#include <algorithm>
+
+
+namespace itpp
+{
+
+//! \cond
+
+/*
+  Decode the blocks of "input" with nthreads copies of "codec". Worker t
+  decodes the blocks t, t+nthreads, t+2*nthreads, etc.
+*/
+template<class T>
+static void decode_blocks(Channel_Code &codec, const Array<T> &input,
+                          Array<bvec> &output, int nthreads)
+{
+  it_assert(nthreads > 0, "Channel_Code::decode_batch(): Number of threads "
+            "must be positive");
+  int nblocks = input.size();
+  output.set_size(nblocks);
+
+  nthreads = std::min(nthreads, nblocks);
+  Channel_Code *copy = (nthreads > 1) ? codec.clone() : 0;
+  if (copy == 0) {
+    for (int i = 0; i < nblocks; i++) {
+      codec.decode(input(i), output(i));
+    }
+    return;
+  }
+
+  Array<Channel_Code *> workers(nthreads);
+  workers(0) = copy;
+  for (int t = 1; t < nthreads; t++) {
+    workers(t) = codec.clone();
+  }
+
+  int t;
+#pragma omp parallel for private(t) num_threads(nthreads) schedule(static, 1)
+  for (t = 0; t < nthreads; t++) {
+    for (int i = t; i < nblocks; i += nthreads) {
+      workers(t)->decode(input(i), output(i));
+    }
+  }
+
+  for (t = 0; t < nthreads; t++) {
+    delete workers(t);
+  }
+}
+
+//! \endcond
+
+
+void Channel_Code::encode(const Packed_Bvec &uncoded_bits, Packed_Bvec &coded_bits)
+{
+  bvec out;
+  encode(uncoded_bits.to_bvec(), out);
+  coded_bits = out;
+}
+
+void Channel_Code::decode(const Packed_Bvec &coded_bits, Packed_Bvec &decoded_bits)
+{
+  bvec out;
+  decode(coded_bits.to_bvec(), out);
+  decoded_bits = out;
+}
+
+void Channel_Code::decode_batch(const Array<vec> &received_signals,
+                                Array<bvec> &decoded_bits, int nthreads)
+{
+  decode_blocks(*this, received_signals, decoded_bits, nthreads);
+}
+
+void Channel_Code::decode_batch(const Array<bvec> &coded_bits,
+                                Array<bvec> &decoded_bits, int nthreads)
+{
+  decode_blocks(*this, coded_bits, decoded_bits, nthreads);
+}
+
+} // namespace itpp
@@ -30,6 +30,8 @@
 #define CHANNEL_CODE_H
 
 #include <itpp/base/vec.h>
+#include <itpp/base/array.h>
+#include <itpp/base/packed_bvec.h>
 #include <itpp/comm/modulator.h>
 
 
@@ -72,8 +74,49 @@ public:
   //virtual bvec decode(const vec &received_signal);
   virtual bvec decode(const vec &received_signal) = 0;
 
+  /*!
+    \brief Encode a packed binary vector
+
+    The default implementation converts to and from \c bvec around
+    encode(const bvec &, bvec &). Codes which work on packed words may
+    override it.
+  */
+  virtual void encode(const Packed_Bvec &uncoded_bits, Packed_Bvec &coded_bits);
+  //! Decode a packed binary vector, by default through decode(const bvec &, bvec &)
+  virtual void decode(const Packed_Bvec &coded_bits, Packed_Bvec &decoded_bits);
+
   //! Get the code rate
   virtual double get_rate() const = 0;
+
+  /*!
+    \brief Decode a batch of received blocks using several threads
+
+    Each element of \c received_signals is decoded as with \c decode()
+    and the result is stored in the same element of \c decoded_bits.
+    The blocks are shared out among \c nthreads workers, each of them
+    decoding with its own copy of the codec (see \c clone()), so that
+    the working storage kept in the member variables of the decoders is
+    never shared between threads.
+
+    \note The workers are run in parallel by means of OpenMP, so IT++
+    must be compiled with OpenMP support enabled (e.g. \c -fopenmp).
+    Otherwise, or if \c clone() is not implemented, the blocks are
+    decoded one after another.
+  */
+  void decode_batch(const Array<vec> &received_signals,
+                    Array<bvec> &decoded_bits, int nthreads = 1);
+  //! Decode a batch of blocks of coded bits using several threads
+  void decode_batch(const Array<bvec> &coded_bits,
+                    Array<bvec> &decoded_bits, int nthreads = 1);
+
+  /*!
+    \brief Create a copy of the codec, used by \c decode_batch()
+
+    Returns a pointer to a new object, which is deleted by the caller,
+    or 0 if the codec can not be copied. Derived classes which override
+    the decoding functions need to override this function as well.
+  */
+  virtual Channel_Code *clone() const { return 0; }
 };
 
 
@@ -91,6 +134,11 @@ public:
   //! Destructor
   virtual ~Dummy_Code() {}
 
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
+
   //! Encode a bvec of input
   virtual void encode(const bvec &uncoded_bits, bvec &coded_bits) { coded_bits = uncoded_bits; }
   //! Encode a bvec of input
@@ -108,6 +156,9 @@ public:
 
   //! Get the code rate
   virtual double get_rate() const { return 1.0; }
+
+  //! Create a copy of the codec
+  virtual Channel_Code *clone() const { return new Dummy_Code(*this); }
 };
 
 
@@ -31,6 +31,10 @@
 #include <itpp/base/matfunc.h>
 #include <limits>
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 namespace itpp
 {
 
@@ -265,6 +269,275 @@ void Convolutional_Code::calc_metric(const vec &rx_codeword,
   }
 }
 
+
+void Convolutional_Code::encode_bits(const bin *input, int length,
+                                     bin *output)
+{
+  int i = 0;
+  if (encode_table.size() > 0) {
+    int nrof_bytes = encode_table.size() / 256;
+    const uint64_t *table = encode_table._data();
+    for (; i < length; i += 8) {
+      // shift register of the state and the next (up to) eight inputs
+      int nrof_steps = std::min(8, length - i);
+      uint64_t reg = encoder_state;
+      for (int k = 0; k < nrof_steps; k++) {
+        reg |= static_cast<uint64_t>(static_cast<int>(input[i + k])) << (m + k);
+      }
+      uint64_t word = table[reg & 255];
+      for (int t = 1; t < nrof_bytes; t++) {
+        word ^= table[256 * t + ((reg >> (8 * t)) & 255)];
+      }
+      for (int k = 0; k < nrof_steps * n; k++) {
+        output[k] = static_cast<int>((word >> k) & 1);
+      }
+      output += nrof_steps * n;
+      encoder_state = static_cast<int>(reg >> nrof_steps);
+    }
+    return;
+  }
+
+  int temp;
+  for (; i < length; i++) {
+    encoder_state |=  static_cast<int>(input[i]) << m;
+    for (int j = 0; j < n; j++) {
+      temp = encoder_state & gen_pol(j);
+      output[i * n + j] = xor_int_table(temp);
+    }
+    encoder_state >>= 1;
+  }
+}
+
+
+// ----------------- Fixed-point Viterbi decoder ---------------------
+//
+// The states 2j and 2j+1 are the predecessors of both state j and state
+// j + no_states/2. Eight such butterflies are updated at a time: the
+// metrics of sixteen consecutive states are split into even and odd
+// states, and the eight new metrics of the lower and the upper half of
+// the trellis are written to consecutive memory. The branch metrics are
+// sums of +/- the received values, with the signs precomputed per state.
+
+//! \cond
+
+//! Unreached states start with this metric in the fixed-point decoder
+static const short CC_fixed_unreached = 32767;
+
+#if defined(__SSE2__)
+
+typedef __m128i acs8;
+
+static inline acs8 acs8_load(const short *p)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+static inline void acs8_store(short *p, acs8 a)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a);
+}
+static inline acs8 acs8_set(short x) { return _mm_set1_epi16(x); }
+static inline acs8 acs8_add(acs8 a, acs8 b) { return _mm_add_epi16(a, b); }
+static inline acs8 acs8_adds(acs8 a, acs8 b) { return _mm_adds_epi16(a, b); }
+static inline acs8 acs8_subs(acs8 a, acs8 b) { return _mm_subs_epi16(a, b); }
+static inline acs8 acs8_min(acs8 a, acs8 b) { return _mm_min_epi16(a, b); }
+// -a in the lanes where mask is set (-1), a elsewhere (mask 0)
+static inline acs8 acs8_negate(acs8 a, acs8 mask)
+{
+  return _mm_sub_epi16(_mm_xor_si128(a, mask), mask);
+}
+// -1 in the lanes where a > b, 0 elsewhere
+static inline acs8 acs8_greater(acs8 a, acs8 b) { return _mm_cmpgt_epi16(a, b); }
+// the even and the odd lanes of a0 followed by those of a1
+static inline void acs8_split(acs8 a0, acs8 a1, acs8 &even, acs8 &odd)
+{
+  even = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a0, 16), 16),
+                         _mm_srai_epi32(_mm_slli_epi32(a1, 16), 16));
+  odd = _mm_packs_epi32(_mm_srai_epi32(a0, 16), _mm_srai_epi32(a1, 16));
+}
+// one bit per lane of two comparison masks, the lanes of a in the low byte
+static inline int acs8_bits(acs8 a, acs8 b)
+{
+  return _mm_movemask_epi8(_mm_packs_epi16(a, b));
+}
+// the minimum of all lanes
+static inline short acs8_hmin(acs8 a)
+{
+  a = _mm_min_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+  a = _mm_min_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+  a = _mm_min_epi16(a, _mm_shufflelo_epi16(a, _MM_SHUFFLE(2, 3, 0, 1)));
+  return static_cast<short>(_mm_cvtsi128_si32(a));
+}
+
+#else // standard C++
+
+struct acs8 { short x[8]; };
+
+static inline short acs8_sat(int a)
+{
+  return static_cast<short>(a > 32767 ? 32767 : (a < -32768 ? -32768 : a));
+}
+static inline acs8 acs8_load(const short *p)
+{
+  acs8 r;
+  for (int l = 0; l < 8; l++) r.x[l] = p[l];
+  return r;
+}
+static inline void acs8_store(short *p, acs8 a)
+{
+  for (int l = 0; l < 8; l++) p[l] = a.x[l];
+}
+static inline acs8 acs8_set(short x)
+{
+  acs8 r;
+  for (int l = 0; l < 8; l++) r.x[l] = x;
+  return r;
+}
+static inline acs8 acs8_add(acs8 a, acs8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = static_cast<short>(a.x[l] + b.x[l]);
+  return a;
+}
+static inline acs8 acs8_adds(acs8 a, acs8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = acs8_sat(a.x[l] + b.x[l]);
+  return a;
+}
+static inline acs8 acs8_subs(acs8 a, acs8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = acs8_sat(a.x[l] - b.x[l]);
+  return a;
+}
+static inline acs8 acs8_min(acs8 a, acs8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = std::min(a.x[l], b.x[l]);
+  return a;
+}
+static inline acs8 acs8_negate(acs8 a, acs8 mask)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = static_cast<short>(mask.x[l] ? -a.x[l] : a.x[l]);
+  return a;
+}
+static inline acs8 acs8_greater(acs8 a, acs8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = static_cast<short>(a.x[l] > b.x[l] ? -1 : 0);
+  return a;
+}
+static inline void acs8_split(acs8 a0, acs8 a1, acs8 &even, acs8 &odd)
+{
+  for (int l = 0; l < 4; l++) {
+    even.x[l] = a0.x[2 * l];
+    even.x[l + 4] = a1.x[2 * l];
+    odd.x[l] = a0.x[2 * l + 1];
+    odd.x[l + 4] = a1.x[2 * l + 1];
+  }
+}
+static inline int acs8_bits(acs8 a, acs8 b)
+{
+  int r = 0;
+  for (int l = 0; l < 8; l++) {
+    r |= (a.x[l] ? 1 : 0) << l;
+    r |= (b.x[l] ? 1 : 0) << (l + 8);
+  }
+  return r;
+}
+static inline short acs8_hmin(acs8 a)
+{
+  short m = a.x[0];
+  for (int l = 1; l < 8; l++) m = std::min(m, a.x[l]);
+  return m;
+}
+
+#endif // __SSE2__
+
+//! \endcond
+
+void Convolutional_Code::fixed_quantize(const vec &received_signal,
+                                        Vec<short> &rx) const
+{
+  // The branch metrics are then bounded by n*q and the spread of the path
+  // metrics by 2*m*n*q, so the metrics normalized to a minimum of zero
+  // stay within 16 bits, and below the metric of unreached states
+  int q = 8192 / ((m + 1) * n);
+  // Twice the mean magnitude maps to q, and larger samples saturate.
+  // Unlike the peak, the mean is not set by a single outlier, which
+  // would leave few levels for all the other samples.
+  double mean = 0.0;
+  for (int i = 0; i < received_signal.size(); i++) {
+    mean += std::fabs(received_signal(i));
+  }
+  if (received_signal.size() > 0) {
+    mean /= received_signal.size();
+  }
+  double scale = (mean > 0.0) ? q / (2.0 * mean) : 0.0;
+  rx.set_size(received_signal.size(), false);
+  for (int i = 0; i < received_signal.size(); i++) {
+    int x = round_i(scale * received_signal(i));
+    rx(i) = static_cast<short>(std::max(-q, std::min(q, x)));
+  }
+}
+
+double Convolutional_Code::fixed_acs(const short *rx, int nrof_steps,
+                                     short *metrics, short *decisions) const
+{
+  int half = no_states / 2;
+  const short *sign0 = fixed_branch_sign._data();
+  const short *sign1 = sign0 + n * no_states;
+  Vec<short> temp_metrics(no_states);
+  short *old_metrics = metrics, *new_metrics = temp_metrics._data();
+  acs8 r[8];
+
+  // the new metrics are normalized by the minimum of the old ones
+  short min_metric = metrics[0];
+  for (int s = 1; s < no_states; s++) {
+    min_metric = std::min(min_metric, metrics[s]);
+  }
+  double offset = 0.0;
+
+  for (int l = 0; l < nrof_steps; l++) {
+    for (int j = 0; j < n; j++) {
+      r[j] = acs8_set(rx[j]);
+    }
+    rx += n;
+    acs8 norm = acs8_set(min_metric);
+    acs8 new_min = acs8_set(CC_fixed_unreached);
+    offset += min_metric;
+
+    for (int i = 0; i < half; i += 8) {
+      acs8 even, odd, survivor_zero[2];
+      acs8_split(acs8_load(old_metrics + 2 * i),
+                 acs8_load(old_metrics + 2 * i + 8), even, odd);
+      for (int h = 0; h < 2; h++) {
+        int s = i + h * half;
+        acs8 bm0 = acs8_negate(r[0], acs8_load(sign0 + s));
+        acs8 bm1 = acs8_negate(r[0], acs8_load(sign1 + s));
+        for (int j = 1; j < n; j++) {
+          bm0 = acs8_add(bm0, acs8_negate(r[j], acs8_load(sign0 + j * no_states + s)));
+          bm1 = acs8_add(bm1, acs8_negate(r[j], acs8_load(sign1 + j * no_states + s)));
+        }
+        acs8 metric_zero = acs8_adds(even, bm0);
+        acs8 metric_one = acs8_adds(odd, bm1);
+        acs8 metric = acs8_subs(acs8_min(metric_zero, metric_one), norm);
+        acs8_store(new_metrics + s, metric);
+        new_min = acs8_min(new_min, metric);
+        survivor_zero[h] = acs8_greater(metric_one, metric_zero);
+      }
+      // as in the floating point decoder, path one survives on ties
+      decisions[i >> 3] = static_cast<short>(~acs8_bits(survivor_zero[0],
+                                                        survivor_zero[1]));
+    }
+    decisions += half / 8;
+    min_metric = acs8_hmin(new_min);
+    std::swap(old_metrics, new_metrics);
+  }
+
+  if (old_metrics != metrics) {
+    for (int s = 0; s < no_states; s++) {
+      metrics[s] = old_metrics[s];
+    }
+  }
+  return offset;
+}
+
 //! \cond
 
 // MFD codes R=1/2
@@ -588,6 +861,42 @@ void Convolutional_Code::set_generator_polynomials(const ivec &gen,
     output_reverse_int(i, 1) = one_output;
   }
 
+  // sign masks of the fixed-point branch metrics: -1 where the code bit
+  // is zero, in the order [input][generator][state]
+  if (n <= 8) {
+    fixed_branch_sign.set_size(2 * n * no_states, false);
+    for (int i = 0; i < no_states; i++) {
+      for (int b = 0; b < 2; b++) {
+        for (int j = 0; j < n; j++) {
+          int bit = (output_reverse_int(i, b) >> (n - 1 - j)) & 1;
+          fixed_branch_sign((b * n + j) * no_states + i) =
+            static_cast<short>(bit ? 0 : -1);
+        }
+      }
+    }
+  }
+
+  // code bits of eight steps for each byte of the shift register
+  if (n <= 8) {
+    int nrof_bytes = (m + 15) / 8;
+    encode_table.set_size(256 * nrof_bytes, false);
+    for (int t = 0; t < nrof_bytes; t++) {
+      for (int b = 0; b < 256; b++) {
+        uint64_t reg = static_cast<uint64_t>(b) << (8 * t), word = 0;
+        for (int i = 0; i < 8; i++) {
+          for (int j = 0; j < n; j++) {
+            int bit = xor_int_table(static_cast<int>((reg >> i) & gen_pol(j)));
+            word |= static_cast<uint64_t>(bit) << (i * n + j);
+          }
+        }
+        encode_table(256 * t + b) = word;
+      }
+    }
+  }
+  else {
+    encode_table.set_size(0);
+  }
+
   // initialise memory structures
   visited_state.set_size(no_states);
   visited_state = false;
@@ -599,6 +908,10 @@ void Convolutional_Code::set_generator_polynomials(const ivec &gen,
   trunc_ptr = 0;
   trunc_state = 0;
 
+  // the streaming decoder is started by the next decode_stream() call
+  stream_metric.set_size(0);
+  stream_rx.set_size(n);
+  stream_rx_fill = 0;
 }
 
 // Reset encoder and decoder states
@@ -613,6 +926,9 @@ void Convolutional_Code::reset()
 
   trunc_ptr = 0;
   trunc_state = 0;
+
+  stream_metric.set_size(0);
+  stream_rx_fill = 0;
 }
 
 
@@ -641,17 +957,8 @@ void Convolutional_Code::encode(const bvec &input, bvec &output)
 */
 void Convolutional_Code::encode_trunc(const bvec &input, bvec &output)
 {
-  int temp;
   output.set_size(input.size() * n, false);
-
-  for (int i = 0; i < input.size(); i++) {
-    encoder_state |=  static_cast<int>(input(i)) << m;
-    for (int j = 0; j < n; j++) {
-      temp = encoder_state & gen_pol(j);
-      output(i * n + j) = xor_int_table(temp);
-    }
-    encoder_state >>= 1;
-  }
+  encode_bits(input._data(), input.size(), output._data());
 }
 
 /*
@@ -666,15 +973,7 @@ void Convolutional_Code::encode_tail(const bvec &input, bvec &output)
 
   // always start from state 0
   encoder_state = 0;
-
-  for (int i = 0; i < input.size(); i++) {
-    encoder_state |=  static_cast<int>(input(i)) << m;
-    for (int j = 0; j < n; j++) {
-      temp = encoder_state & gen_pol(j);
-      output(i * n + j) = xor_int_table(temp);
-    }
-    encoder_state >>= 1;
-  }
+  encode_bits(input._data(), input.size(), output._data());
 
   // add tail of m = K-1 zeros
   for (int i = input.size(); i < input.size() + m; i++) {
@@ -691,7 +990,6 @@ void Convolutional_Code::encode_tail(const bvec &input, bvec &output)
 */
 void Convolutional_Code::encode_tailbite(const bvec &input, bvec &output)
 {
-  int temp;
   output.set_size(input.size() * n, false);
 
   // Set the start state equal to the end state:
@@ -702,14 +1000,7 @@ void Convolutional_Code::encode_tailbite(const bvec &input, bvec &output)
     encoder_state >>= 1;
   }
 
-  for (int i = 0; i < input.size(); i++) {
-    encoder_state |= static_cast<int>(input(i)) << m;
-    for (int j = 0; j < n; j++) {
-      temp = encoder_state & gen_pol(j);
-      output(i * n + j) = xor_int_table(temp);
-    }
-    encoder_state >>= 1;
-  }
+  encode_bits(input._data(), input.size(), output._data());
 }
 
 /*
@@ -773,13 +1064,36 @@ void Convolutional_Code::decode_tail(const vec &received_signal, bvec &output)
   int block_length = received_signal.size() / n; // no input symbols
   it_error_if(block_length - m <= 0,
               "Convolutional_Code::decode_tail(): Input sequence to short");
+  output.set_size(block_length - m, false);    // no tail in the output
+
+  if (use_fixed_viterbi()) {
+    int words = no_states / 16;
+    Vec<short> rx, metrics(no_states);
+    fixed_quantize(received_signal.left(block_length * n), rx);
+    metrics = CC_fixed_unreached;
+    metrics(0) = 0; // starts in the zero state
+    fixed_path_memory.set_size(words * block_length, false);
+    fixed_acs(rx._data(), block_length, metrics._data(),
+              fixed_path_memory._data());
+
+    // trace back from the zero state, first through the tail
+    int state = 0;
+    for (int l = block_length - 1; l >= 0; l--) {
+      if (l < block_length - m) {
+        output(l) = get_input(state);
+      }
+      state = previous_state(state, fixed_decision(fixed_path_memory._data()
+                                                   + l * words, state));
+    }
+    return;
+  }
+
   int S0, S1;
   vec temp_sum_metric(no_states), temp_rec(n), delta_metrics;
   Array<bool> temp_visited_state(no_states);
   double temp_metric_zero, temp_metric_one;
 
   path_memory.set_size(no_states, block_length, false);
-  output.set_size(block_length - m, false);    // no tail in the output
 
   // clear visited states
   visited_state = false;
@@ -882,6 +1196,10 @@ void Convolutional_Code::decode_tailbite(const vec &received_signal,
   int block_length = received_signal.size() / n; // no input symbols
   it_error_if(block_length <= 0,
               "Convolutional_Code::decode_tailbite(): Input sequence to short");
+  if (wava_passes > 0) {
+    decode_tailbite_wava(received_signal, output);
+    return;
+  }
   int S0, S1;
   vec temp_sum_metric(no_states), temp_rec(n), delta_metrics;
   Array<bool> temp_visited_state(no_states);
@@ -889,9 +1207,39 @@ void Convolutional_Code::decode_tailbite(const vec &received_signal,
   double best_metric = std::numeric_limits<double>::max();
   bvec best_output(block_length), temp_output(block_length);
 
-  path_memory.set_size(no_states, block_length, false);
   output.set_size(block_length, false);
 
+  if (use_fixed_viterbi()) {
+    int words = no_states / 16;
+    Vec<short> rx, metrics(no_states);
+    fixed_quantize(received_signal.left(block_length * n), rx);
+    fixed_path_memory.set_size(words * block_length, false);
+
+    // Try all start states ss
+    for (int ss = 0; ss < no_states; ss++) {
+      metrics = CC_fixed_unreached;
+      metrics(ss) = 0;
+      double metric = fixed_acs(rx._data(), block_length, metrics._data(),
+                                fixed_path_memory._data());
+      metric += metrics(ss);
+
+      int state = ss;
+      for (int l = block_length - 1; l >= 0; l--) {
+        temp_output(l) = get_input(state);
+        state = previous_state(state, fixed_decision(fixed_path_memory._data()
+                                                     + l * words, state));
+      }
+      if (metric < best_metric) {
+        best_metric = metric;
+        best_output = temp_output;
+      }
+    }
+    output = best_output;
+    return;
+  }
+
+  path_memory.set_size(no_states, block_length, false);
+
 
   // Try all start states ss
   for (int ss = 0; ss < no_states; ss++) {
@@ -1043,6 +1391,194 @@ void Convolutional_Code::decode_trunc(const vec &received_signal,
 }
 
 
+/*
+  Wrap-around Viterbi algorithm for tail-biting codes: the passes over
+  the circular trellis start with the final metrics of the previous pass,
+  until the best survivor is a tail-biting path. The passes may also lock
+  onto a path that never closes, so the best tail-biting survivor of the
+  other states is kept as a fallback.
+*/
+void Convolutional_Code::decode_tailbite_wava(const vec &received_signal,
+                                              bvec &output)
+{
+  int block_length = received_signal.size() / n; // no input symbols
+  bool fixed = use_fixed_viterbi();
+  int S0, S1;
+  vec start_metric(no_states), temp_sum_metric(no_states), temp_rec(n),
+  delta_metrics;
+  double temp_metric_zero, temp_metric_one;
+  double best_metric = std::numeric_limits<double>::max();
+  bool found = false;
+  Vec<short> rx, metrics(no_states);
+
+  output.set_size(block_length, false);
+  if (fixed) {
+    fixed_quantize(received_signal.left(block_length * n), rx);
+    fixed_path_memory.set_size(no_states / 16 * block_length, false);
+  }
+  else {
+    path_memory.set_size(no_states, block_length, false);
+  }
+  // all start states are equally likely
+  metrics.zeros();
+  sum_metric.zeros();
+
+  for (int pass = 0; pass < wava_passes; pass++) {
+    double offset = 0.0;
+    if (fixed) {
+      start_metric = to_vec(metrics);
+      offset = fixed_acs(rx._data(), block_length, metrics._data(),
+                         fixed_path_memory._data());
+      sum_metric = to_vec(metrics);
+    }
+    else {
+      start_metric = sum_metric;
+      for (int l = 0; l < block_length; l++) { // all transitions
+        temp_rec = received_signal.mid(l * n, n);
+        // calculate all metrics for all codewords at the same time
+        calc_metric(temp_rec, delta_metrics);
+
+        for (int s = 0; s < no_states; s++) { // all states
+          // S0 and S1 are the states that expanded end at state s
+          previous_state(s, S0, S1);
+          temp_metric_zero = sum_metric(S0)
+                             + delta_metrics(output_reverse_int(s, 0));
+          temp_metric_one = sum_metric(S1)
+                            + delta_metrics(output_reverse_int(s, 1));
+          if (temp_metric_zero < temp_metric_one) { // path zero survives
+            temp_sum_metric(s) = temp_metric_zero;
+            path_memory(s, l) = 0;
+          }
+          else { // path one survives
+            temp_sum_metric(s) = temp_metric_one;
+            path_memory(s, l) = 1;
+          }
+        } // all states, s
+        sum_metric = temp_sum_metric;
+      } // all transitions, l
+    }
+
+    // the decoding ends if the best survivor is tail-biting
+    int min_metric_state = min_index(sum_metric);
+    if (wava_start_state(min_metric_state, block_length) == min_metric_state) {
+      wava_traceback(min_metric_state, output);
+      return;
+    }
+
+    // otherwise keep the best tail-biting survivor found so far
+    for (int ss = 0; ss < no_states; ss++) {
+      double metric = sum_metric(ss) + offset - start_metric(ss);
+      if ((metric < best_metric)
+          && (wava_start_state(ss, block_length) == ss)) {
+        best_metric = metric;
+        wava_traceback(ss, output);
+        found = true;
+      }
+    }
+    if (!found && (pass == wava_passes - 1)) {
+      // no tail-biting path at all, so use the best survivor
+      wava_traceback(min_metric_state, output);
+    }
+
+    // normalise accumulated metrics for the next pass
+    sum_metric -= sum_metric(min_metric_state);
+  } // all passes
+}
+
+
+/*
+  Streaming Viterbi decoding with a fixed traceback depth. The survivor
+  decisions of the last stream_path.rows() steps are kept in a circular
+  buffer, and the input bit of the oldest of them is decided after each
+  new step.
+*/
+void Convolutional_Code::decode_stream(const vec &received_signal,
+                                       bvec &output)
+{
+  if (stream_metric.size() == 0) { // start a new stream
+    int depth = get_traceback_depth();
+    stream_metric.set_size(no_states);
+    stream_metric = std::numeric_limits<double>::max();
+    stream_metric(start_state) = 0.0;
+    stream_path.set_size(depth, no_states, false);
+    stream_ptr = 0;
+    stream_fill = 0;
+  }
+  int depth = stream_path.rows();
+  int S0, S1;
+  vec temp_sum_metric(no_states), delta_metrics;
+  double temp_metric_zero, temp_metric_one;
+
+  output.set_size((stream_rx_fill + received_signal.size()) / n, false);
+  int nrof_output = 0;
+
+  for (int i = 0; i < received_signal.size(); i++) {
+    stream_rx(stream_rx_fill++) = received_signal(i);
+    if (stream_rx_fill < n) {
+      continue;
+    }
+    stream_rx_fill = 0;
+
+    stream_ptr = (stream_ptr + 1) % depth;
+    // the oldest step is overwritten, so decide its input bit first
+    if (stream_fill == depth) {
+      int state = min_index(stream_metric);
+      for (int j = 0; j < depth - 1; j++) {
+        state = previous_state(state, stream_path(
+                                 (stream_ptr + depth - 1 - j) % depth, state));
+      }
+      output(nrof_output++) = get_input(state);
+    }
+    else {
+      stream_fill++;
+    }
+
+    // calculate all metrics for all codewords at the same time
+    calc_metric(stream_rx, delta_metrics);
+    for (int s = 0; s < no_states; s++) { // all states
+      previous_state(s, S0, S1);
+      temp_metric_zero = stream_metric(S0)
+                         + delta_metrics(output_reverse_int(s, 0));
+      temp_metric_one = stream_metric(S1)
+                        + delta_metrics(output_reverse_int(s, 1));
+      if (temp_metric_zero < temp_metric_one) { // path zero survives
+        temp_sum_metric(s) = temp_metric_zero;
+        stream_path(stream_ptr, s) = 0;
+      }
+      else { // path one survives
+        temp_sum_metric(s) = temp_metric_one;
+        stream_path(stream_ptr, s) = 1;
+      }
+    }
+    // normalise accumulated metrics
+    double min_metric = min(temp_sum_metric);
+    for (int s = 0; s < no_states; s++) {
+      stream_metric(s) = temp_sum_metric(s) - min_metric;
+    }
+  }
+  output.set_size(nrof_output, true);
+}
+
+void Convolutional_Code::flush_stream(bvec &output)
+{
+  if (stream_metric.size() == 0) { // no stream started
+    output.set_size(0);
+    stream_rx_fill = 0;
+    return;
+  }
+  int depth = stream_path.rows();
+  output.set_size(stream_fill, false);
+  int state = min_index(stream_metric);
+  for (int j = 0; j < stream_fill; j++) {
+    output(stream_fill - 1 - j) = get_input(state);
+    state = previous_state(state, stream_path((stream_ptr + depth - j) % depth,
+                                              state));
+  }
+  stream_metric.set_size(0);
+  stream_rx_fill = 0;
+}
+
+
 /*
   Calculate the inverse sequence
 
@@ -1209,76 +1745,188 @@ stack:
 
   Calculates both the weight spectrum (Ad) and the information weight spectrum (Cd) and
   returns it as ivec:s in the 0:th and 1:st component of spectrum, respectively. Suitable
-  for calculating many terms in the spectra (uses an breadth first algorithm). It is assumed
-  that the code is non-catastrophic or else it is a possibility for an eternal loop.
+  for calculating many terms in the spectra (uses an breadth first algorithm). Returns false,
+  with an all-zero spectrum, if the code is catastrophic.
   dmax = an upper bound on the free distance
   no_terms = no_terms including the dmax term that should be calculated
 */
-void Convolutional_Code::calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms)
+bool Convolutional_Code::calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms)
+{
+  imat branch_weight(no_states, 2);
+  for (int s = 0; s < no_states; s++) {
+    weight(s, branch_weight(s, 0), branch_weight(s, 1));
+  }
+  return trellis_spectrum(branch_weight, 0, dmax + no_terms, spectrum);
+}
+
+/*
+  Lowest weight of the paths from each state and phase to the zero state,
+  by Bellman-Ford iterations over the trellis. Paths stop when they reach
+  the zero state.
+*/
+void Convolutional_Code::distance_to_zero(const imat &branch_weight,
+                                          imat &dist) const
 {
-  imat Ad_states(no_states, dmax + no_terms), Cd_states(no_states, dmax + no_terms);
-  imat Ad_temp(no_states, dmax + no_terms), Cd_temp(no_states, dmax + no_terms);
-  ivec mindist(no_states),  mindist_temp(1 << m);
+  int period = branch_weight.cols() / 2;
+  int big = std::numeric_limits<int>::max() / 2;
+  dist.set_size(no_states, period, false);
+  dist = big;
+  for (int p = 0; p < period; p++) {
+    dist(0, p) = 0;
+  }
 
+  bool changed = true;
+  for (int iter = 0; changed && (iter <= no_states * period); iter++) {
+    changed = false;
+    for (int p = 0; p < period; p++) {
+      int p_next = (p + 1) % period;
+      for (int s = 1; s < no_states; s++) {
+        int d = std::min(branch_weight(s, 2 * p) + dist(next_state(s, 0), p_next),
+                         branch_weight(s, 2 * p + 1)
+                         + dist(next_state(s, 1), p_next));
+        if (d < dist(s, p)) {
+          dist(s, p) = d;
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+/*
+  True if the trellis has a cycle of zero-weight branches that avoids the
+  zero state. The nodes are the (state, phase) pairs. Nodes without an
+  incoming zero-weight branch are removed until none is left; the nodes
+  that remain lie on (or after) a zero-weight cycle.
+*/
+bool Convolutional_Code::zero_weight_cycle(const imat &branch_weight) const
+{
+  int period = branch_weight.cols() / 2;
+  ivec in_degree(no_states * period);
+  in_degree.zeros();
+  for (int p = 0; p < period; p++) {
+    int p_next = (p + 1) % period;
+    for (int s = 1; s < no_states; s++) {
+      for (int i = 0; i < 2; i++) {
+        int s_next = next_state(s, i);
+        if ((s_next != 0) && (branch_weight(s, 2 * p + i) == 0))
+          in_degree(s_next * period + p_next)++;
+      }
+    }
+  }
+
+  ivec queue(no_states * period);
+  int nrof_queued = 0, nrof_removed = 0;
+  for (int s = 1; s < no_states; s++) {
+    for (int p = 0; p < period; p++) {
+      if (in_degree(s * period + p) == 0)
+        queue(nrof_queued++) = s * period + p;
+    }
+  }
+  while (nrof_removed < nrof_queued) {
+    int node = queue(nrof_removed++);
+    int s = node / period, p = node % period, p_next = (p + 1) % period;
+    for (int i = 0; i < 2; i++) {
+      int s_next = next_state(s, i);
+      if ((s_next != 0) && (branch_weight(s, 2 * p + i) == 0)
+          && (--in_degree(s_next * period + p_next) == 0))
+        queue(nrof_queued++) = s_next * period + p_next;
+    }
+  }
+  return nrof_removed < (no_states - 1) * period;
+}
+
+/*
+  Breadth-first search for the weight spectrum of the paths that leave the
+  zero state at phase "time" and return to it for the first time, pruned
+  with the distances to the zero state. Returns false, with an all-zero
+  spectrum, if the code is catastrophic.
+*/
+bool Convolutional_Code::trellis_spectrum(const imat &branch_weight,
+                                          int time, int wmax,
+                                          Array<ivec> &spectrum) const
+{
   spectrum.set_size(2);
-  spectrum(0).set_size(dmax + no_terms, false);
-  spectrum(1).set_size(dmax + no_terms, false);
+  spectrum(0).set_size(wmax, false);
+  spectrum(1).set_size(wmax, false);
   spectrum(0).zeros();
   spectrum(1).zeros();
-  Ad_states.zeros();
-  Cd_states.zeros();
-  mindist.zeros();
-  int wmax = dmax + no_terms;
-  ivec visited_states(no_states), visited_states_temp(no_states);
-  bool proceede;
-  int d, w0, w1, s, s0, s1;
-
-  visited_states.zeros(); // 0 = false
-  s = next_state(0, 1); // Start in state from 0 with an one input.
-  visited_states(s) = 1;  // 1 = true. Start in state 2^(m-1).
-  w1 = weight(0, 1);
-  Ad_states(s, w1) = 1;
-  Cd_states(s, w1) = 1;
-  mindist(s) = w1;
-  proceede = true;
-
-  while (proceede) {
-    proceede = false;
-    Ad_temp.zeros();
-    Cd_temp.zeros();
-    mindist_temp.zeros();
-    visited_states_temp.zeros(); //false
-    for (s = 1; s < no_states; s++) {
-      if ((mindist(s) > 0) && (mindist(s) < wmax)) {
-        proceede = true;
-        weight(s, w0, w1);
-        s0 = next_state(s, 0);
-        for (d = mindist(s); d < (wmax - w0); d++) {
-          Ad_temp(s0, d + w0) += Ad_states(s, d);
-          Cd_temp(s0, d + w0) += Cd_states(s, d);
-          visited_states_temp(s0) = 1; //true
-        }
 
-        s1 = next_state(s, 1);
-        for (d = mindist(s); d < (wmax - w1); d++) {
-          Ad_temp(s1, d + w1) += Ad_states(s, d);
-          Cd_temp(s1, d + w1) += Cd_states(s, d) + Ad_states(s, d);
-          visited_states_temp(s1) = 1; //true
-        }
-        if (mindist_temp(s0) > 0) { mindist_temp(s0) = (mindist(s) + w0) < mindist_temp(s0) ? mindist(s) + w0 :  mindist_temp(s0); }
-        else { mindist_temp(s0) = mindist(s) + w0; }
-        if (mindist_temp(s1) > 0) { mindist_temp(s1) = (mindist(s) + w1) < mindist_temp(s1) ? mindist(s) + w1 :  mindist_temp(s1); }
-        else { mindist_temp(s1) = mindist(s) + w1; }
+  // a path could stay on a zero-weight cycle forever
+  if (zero_weight_cycle(branch_weight))
+    return false;
+
+  int period = branch_weight.cols() / 2;
+  imat dist;
+  distance_to_zero(branch_weight, dist);
+
+  // number of paths (Ad) and of their input weights (Cd) per state and
+  // path weight, and the lowest path weight in each state (wmax if none),
+  // for the current (cur) and the next trellis step
+  ivec Ad[2], Cd[2], mindist[2];
+  for (int i = 0; i < 2; i++) {
+    Ad[i].set_size(no_states * wmax, false);
+    Cd[i].set_size(no_states * wmax, false);
+    mindist[i].set_size(no_states, false);
+  }
+  int cur = 0;
+  Ad[cur].zeros();
+  Cd[cur].zeros();
+  mindist[cur] = wmax;
+
+  int s_start = next_state(0, 1); // start in state 0 with a one input
+  int w_start = branch_weight(0, 2 * time + 1);
+  int nrof_active = 0;
+  if (w_start + dist(s_start, (time + 1) % period) < wmax) {
+    Ad[cur](s_start * wmax + w_start) = 1;
+    Cd[cur](s_start * wmax + w_start) = 1;
+    mindist[cur](s_start) = w_start;
+    nrof_active = 1;
+  }
 
+  for (int t = time + 1; nrof_active > 0; t++) {
+    int p = t % period, p_next = (t + 1) % period;
+    const int *ad = Ad[cur]._data(), *cd = Cd[cur]._data();
+    const int *min_d = mindist[cur]._data();
+    int *ad_next = Ad[1 - cur]._data(), *cd_next = Cd[1 - cur]._data();
+    int *min_d_next = mindist[1 - cur]._data();
+    nrof_active = 0;
+
+    // each state pulls the paths of its two predecessors
+#pragma omp parallel for reduction(+:nrof_active) if(no_states >= 1024)
+    for (int s = 0; s < no_states; s++) {
+      int input = get_input(s), limit = wmax - dist(s, p_next), d_min = wmax;
+      int *a = ad_next + s * wmax, *c = cd_next + s * wmax;
+      for (int d = 0; d < wmax; d++) {
+        a[d] = 0;
+        c[d] = 0;
+      }
+      for (int b = 0; b < 2; b++) {
+        int s_prev = ((s << 1) | b) & (no_states - 1);
+        if ((s_prev == 0) || (min_d[s_prev] >= wmax))
+          continue;
+        int w = branch_weight(s_prev, 2 * p + input);
+        const int *a_prev = ad + s_prev * wmax, *c_prev = cd + s_prev * wmax;
+        for (int d = min_d[s_prev]; d + w < limit; d++) {
+          a[d + w] += a_prev[d];
+          c[d + w] += c_prev[d] + input * a_prev[d];
+        }
+        d_min = std::min(d_min, min_d[s_prev] + w);
       }
+      min_d_next[s] = (d_min < limit) ? d_min : wmax;
+      if ((s != 0) && (min_d_next[s] < wmax))
+        nrof_active++;
     }
-    Ad_states = Ad_temp;
-    Cd_states = Cd_temp;
-    spectrum(0) += Ad_temp.get_row(0);
-    spectrum(1) += Cd_temp.get_row(0);
-    visited_states = visited_states_temp;
-    mindist = elem_mult(mindist_temp, visited_states);
+
+    // the paths that reach the zero state are terminated
+    for (int d = 0; d < wmax; d++) {
+      spectrum(0)(d) += ad_next[d];
+      spectrum(1)(d) += cd_next[d];
+    }
+    min_d_next[0] = wmax;
+    cur = 1 - cur;
   }
+  return true;
 }
 
 /*
@@ -1337,17 +1985,22 @@ int Convolutional_Code::fast(Array<ivec> &spectrum, const int dfree, const int n
   S = next_state(0, 1); //first state zero and one as input
   int W = d - dist_prof_rev0;
 
+  // branch weights of the code that is searched backwards
+  imat branch_weight(no_states, 2);
+  for (i = 0; i < no_states; i++) {
+    if (reverse)
+      weight(i, branch_weight(i, 0), branch_weight(i, 1));
+    else
+      weight_reverse(i, branch_weight(i, 0), branch_weight(i, 1));
+  }
+
 
 F2:
   S0 = next_state(S, 0);
   S1 = next_state(S, 1);
 
-  if (reverse) {
-    weight(S, w0, w1);
-  }
-  else {
-    weight_reverse(S, w0, w1);
-  }
+  w0 = branch_weight(S, 0);
+  w1 = branch_weight(S, 1);
   W0 = W - w0;
   W1 = W - w1;
   if (mf < m) goto F6;
@@ -33,6 +33,7 @@
 #include <itpp/base/mat.h>
 #include <itpp/base/array.h>
 #include <itpp/base/binary.h>
+#include <itpp/base/ittypes.h>
 #include <itpp/comm/channel_code.h>
 
 
@@ -103,7 +104,8 @@ class Convolutional_Code : public Channel_Code
 {
 public:
   //! Default constructor - sets (0133,0171) code with tail
-  Convolutional_Code(void): K(0), start_state(0), cc_method(Tail) {
+  Convolutional_Code(void): K(0), start_state(0), cc_method(Tail),
+      fixed_viterbi(true), wava_passes(0), stream_depth(0) {
     set_code(MFD, 2, 7);
     init_encoder();
   }
@@ -135,6 +137,11 @@ public:
   void reset();
 
 
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
+
   //@{
   //! Encode an input binary vector using specified method (Tail by default)
   virtual void encode(const bvec &input, bvec &output);
@@ -250,9 +257,11 @@ public:
    * \brief Decode a block of encoded data where encode_tailbite has been
    * used.
    *
-   * The decoding algorithm tries all start states, so the
+   * By default the decoding algorithm tries all start states, so the
    * decode_tailbite() is \f$2^{K-1}\f$ times more complex than the
-   * decode_tail method.
+   * decode_tail method. The wrap-around Viterbi algorithm, which usually
+   * needs two or three passes, can be selected with
+   * set_wrap_around_viterbi().
    */
   virtual void decode_tailbite(const vec &received_signal, bvec &output);
   virtual bvec decode_tailbite(const vec &received_signal) {
@@ -272,10 +281,94 @@ public:
   }
   //@}
 
+  //@{
+  /*!
+    \brief Streaming Viterbi decoding with a fixed traceback depth
+
+    The received signal may be given in chunks of any size, also chunks
+    that do not hold a whole number of code symbols; the samples of an
+    incomplete symbol are kept until the next call. Each input bit is
+    output when \a depth further code symbols have been received
+    (\a depth is the truncation length by default, see
+    set_traceback_depth()), by tracing back from the best state. Thus
+    the decoding delay is fixed, and the survivor memory is a circular
+    buffer of \a depth steps, independent of the stream length.
+
+    The decoder starts in the start state of the encoder (see
+    set_start_state()), as for a stream encoded with encode_trunc().
+    Use flush_stream() at the end of a stream and reset() to start a new
+    one.
+  */
+  virtual void decode_stream(const vec &received_signal, bvec &output);
+  virtual bvec decode_stream(const vec &received_signal) {
+    bvec output;
+    decode_stream(received_signal, output);
+    return output;
+  }
+  //@}
+
+  //@{
+  /*!
+    \brief Decide the bits still held by the streaming decoder
+
+    Traces back from the best state to output the (at most \a depth)
+    bits of the stream that decode_stream() has not decided yet. The
+    streaming decoder is then restarted from the start state.
+  */
+  virtual void flush_stream(bvec &output);
+  virtual bvec flush_stream() {
+    bvec output;
+    flush_stream(output);
+    return output;
+  }
+  //@}
+
+
+  /*!
+    \brief Enable or disable the fixed-point Viterbi decoder (enabled by default)
+
+    When enabled, decode_tail() and decode_tailbite() run the Viterbi
+    algorithm on 16-bit path metrics. The add-compare-select operations
+    are done on the butterflies of the trellis, eight states at a time
+    with SSE2, and the survivor decisions are stored as packed bits. The
+    received signal is scaled so that twice its mean magnitude maps to
+    the largest level, rounded to integers with eight to nine bits of
+    resolution, and larger samples are clipped. Thus the decisions may
+    in rare cases differ from the floating point decoder.
+
+    The fixed-point decoder is only used for codes with at least 16
+    states (\a K >= 5) and at most eight generator polynomials. Other codes
+    are always decoded with the floating point decoder.
+  */
+  void set_fixed_point_viterbi(bool enable = true) { fixed_viterbi = enable; }
+
+  /*!
+    \brief Use the wrap-around Viterbi algorithm in decode_tailbite()
+
+    Instead of one Viterbi pass per start state, the wrap-around Viterbi
+    algorithm (WAVA) runs passes over the circular trellis, starting
+    with equal metrics in all states. Each following pass starts with the
+    final metrics of the previous one. The decoding stops when the
+    survivor of the best final state starts in that same state, i.e. it
+    is a tail-biting path. Otherwise, after \a max_passes passes, the
+    best tail-biting survivor seen in any pass is output.
+
+    The result may differ from the exhaustive search over all start
+    states, mostly at low SNR. A \a max_passes of zero restores the
+    exhaustive search (default).
+  */
+  void set_wrap_around_viterbi(int max_passes = 4) {
+    it_error_if(max_passes < 0, "Convolutional_Code::"
+                "set_wrap_around_viterbi(): Negative number of passes");
+    wava_passes = max_passes;
+  }
 
   //! Return rate of code (not including the rate-loss)
   virtual double get_rate(void) const { return rate; }
 
+  //! Create a copy of the codec (used by \c decode_batch())
+  virtual Channel_Code *clone() const { return new Convolutional_Code(*this); }
+
 
   //! Set encoder default start state.
   void set_start_state(int state) {
@@ -304,6 +397,23 @@ public:
   //! Get memory truncation length
   int get_truncation_length(void) const { return trunc_length; }
 
+  /*!
+    \brief Set the traceback depth of decode_stream()
+
+    A \a depth of zero (default) uses the truncation length. The depth
+    must be at least K and takes effect when the next stream is started.
+  */
+  void set_traceback_depth(int depth) {
+    it_error_if((depth < K) && (depth != 0), "Convolutional_Code::"
+                "set_traceback_depth(): Traceback depth shorter than K");
+    stream_depth = depth;
+  }
+
+  //! Get the traceback depth of decode_stream()
+  int get_traceback_depth(void) const {
+    return (stream_depth > 0) ? stream_depth : trunc_length;
+  }
+
 
   //! Check if catastrophic. Returns true if catastrophic
   bool catastrophic(void);
@@ -332,15 +442,17 @@ public:
     weight spectrum (Cd) and returns it as ivec:s in the 0:th and
     1:st component of spectrum, respectively. Suitable for
     calculating many terms in the spectra (uses an breadth first
-    algorithm). It is assumed that the code is non-catastrophic or
-    else it is a possibility for an eternal loop.
+    algorithm). Paths that cannot return to the zero state with a
+    weight below \a dmax + \a no_terms are dropped early. Returns \c
+    false, with an all-zero spectrum, if the code is catastrophic (has a
+    zero-weight cycle other than the zero state), and \c true otherwise.
     dmax = an upper bound on the free distance
     no_terms = no_terms including the dmax term that should be calculated
 
     Observe that there is a risk that some of the integers are
     overflow if many terms are calculated in the spectrum.
   */
-  void calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms);
+  bool calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms);
 
   /*!
     \brief Cederwall's fast algorithm
@@ -369,7 +481,7 @@ public:
 
 protected:
   //! Next state from instate given the input
-  int next_state(const int instate, const int input) {
+  int next_state(const int instate, const int input) const {
     return ((instate >> 1) | (input << (m - 1)));
   }
   //! The previous state from state given the input
@@ -403,7 +515,86 @@ protected:
   //! Calculate delta metrics for all possible codewords
   void calc_metric(const vec &rx_codeword, vec &delta_metrics);
   //! Returns the input that results in state, that is the MSB of state
-  int get_input(const int state) { return (state >> (m - 1)); }
+  int get_input(const int state) const { return (state >> (m - 1)); }
+
+  /*!
+    \brief Lowest weight from each state to the zero state
+
+    Column 2p + i of \a branch_weight holds the branch weights with input
+    \a i at phase \a p of a periodic (e.g. punctured) trellis. Element
+    (s, p) of \a dist is the lowest weight of the paths from state \a s
+    at phase \a p to the zero state.
+  */
+  void distance_to_zero(const imat &branch_weight, imat &dist) const;
+  //! True if the trellis in \a branch_weight has a zero-weight cycle that avoids the zero state
+  bool zero_weight_cycle(const imat &branch_weight) const;
+  /*!
+    \brief Weight spectrum of the paths that leave the zero state at phase
+    \a time, for the weights below \a wmax
+
+    The search is breadth-first. A path is dropped as soon as its weight
+    plus the lowest weight back to the zero state (see distance_to_zero())
+    reaches \a wmax. With many states, the states of each trellis step are
+    updated in parallel when OpenMP is enabled. Returns \c false, with an
+    all-zero spectrum, if the trellis has a zero-weight cycle.
+  */
+  bool trellis_spectrum(const imat &branch_weight, int time, int wmax,
+                        Array<ivec> &spectrum) const;
+  //! Tail-biting decoding with the wrap-around Viterbi algorithm
+  void decode_tailbite_wava(const vec &received_signal, bvec &output);
+  //! The survivor decision of state in step l of the last decoder pass
+  int survivor_decision(int l, int state) const {
+    if (use_fixed_viterbi())
+      return fixed_decision(fixed_path_memory._data() + l * (no_states / 16),
+                            state);
+    else
+      return path_memory(state, l);
+  }
+  //! The start state of the survivor ending in state after nrof_steps steps
+  int wava_start_state(int state, int nrof_steps) {
+    for (int l = nrof_steps - 1; l >= 0; l--) {
+      state = previous_state(state, survivor_decision(l, state));
+    }
+    return state;
+  }
+  //! Trace back the survivor ending in state into output
+  void wava_traceback(int state, bvec &output) {
+    for (int l = output.size() - 1; l >= 0; l--) {
+      output(l) = get_input(state);
+      state = previous_state(state, survivor_decision(l, state));
+    }
+  }
+
+  /*!
+    \brief Encode \a length bits from the current encoder state
+
+    With at most eight generators, eight input bits are encoded per table
+    lookup; see encode_table.
+  */
+  void encode_bits(const bin *input, int length, bin *output);
+
+  //! True if the fixed-point Viterbi decoder can be used for this code
+  bool use_fixed_viterbi() const {
+    return fixed_viterbi && (m >= 4) && (n <= 8);
+  }
+  //! Scale and round the received signal for the fixed-point decoder
+  void fixed_quantize(const vec &received_signal, Vec<short> &rx) const;
+  /*!
+    \brief Fixed-point add-compare-select over \a nrof_steps trellis steps
+
+    The path \a metrics are updated in place and the packed survivor
+    decisions of each step are written to \a decisions (no_states / 16
+    words per step). The metrics are normalized to a minimum of zero in
+    each step; the return value is the sum of the subtracted minima.
+  */
+  double fixed_acs(const short *rx, int nrof_steps, short *metrics,
+                   short *decisions) const;
+  //! The survivor decision of state in one step of packed decisions
+  int fixed_decision(const short *decisions, int state) const {
+    int j = state & (no_states / 2 - 1);
+    int bit = (j & 7) + ((state >= no_states / 2) ? 8 : 0);
+    return (static_cast<unsigned short>(decisions[j >> 3]) >> bit) & 1;
+  }
 
   //! Number of generators
   int n;
@@ -441,6 +632,38 @@ protected:
   int trunc_ptr;
   //! Truncated memory fill state
   int trunc_state;
+  //! Use the fixed-point Viterbi decoder when possible
+  bool fixed_viterbi;
+  /*!
+    \brief Code bits of eight encoder steps, one table of 256 words per
+    byte of the shift register
+
+    The encoder state and the next eight input bits form a register of
+    \a m + 8 bits. Bit \a i * \a n + \a j of the XOR of the words of
+    its bytes is the output of generator \a j in step \a i. Empty if
+    there are more than eight generators.
+  */
+  Vec<uint64_t> encode_table;
+  //! Branch metric sign masks of the fixed-point decoder
+  Vec<short> fixed_branch_sign;
+  //! Packed survivor decisions of the fixed-point decoder
+  Vec<short> fixed_path_memory;
+  //! Maximum number of wrap-around Viterbi passes (0 = try all states)
+  int wava_passes;
+  //! Traceback depth of the streaming decoder (0 = truncation length)
+  int stream_depth;
+  //! Path metrics of the streaming decoder
+  vec stream_metric;
+  //! Circular survivor memory of the streaming decoder, one row per step
+  bmat stream_path;
+  //! Samples of an incomplete received symbol
+  vec stream_rx;
+  //! Number of samples in stream_rx
+  int stream_rx_fill;
+  //! Row of the latest step in stream_path
+  int stream_ptr;
+  //! Number of steps in stream_path (up to its size)
+  int stream_fill;
 };
 
 // --------------- Some other functions that maybe should be moved -----------
@@ -29,6 +29,8 @@
 #include <itpp/comm/crc.h>
 #include <itpp/base/specmat.h>
 #include <itpp/base/matfunc.h>
+#include <itpp/base/packed_bvec.h>
+#include <algorithm>
 
 
 namespace itpp
@@ -40,6 +42,135 @@ void CRC_Code::set_generator(const bvec &poly)
   it_assert(poly(0) == 1, "CRC_Code::set_polynomial: not a valid polynomial");
   polynomial = poly;
   no_parity = polynomial.size() - 1;
+
+  crc_tables.set_size(0);
+  if (no_parity > 64) {
+    return;
+  }
+  poly_word = 0;
+  for (int i = 0; i < no_parity; i++) {
+    poly_word |= static_cast<uint64_t>(static_cast<int>(polynomial(i + 1))) << (63 - i);
+  }
+  // a byte shifted through the register one bit at a time, and then
+  // followed by k zero bytes for table k
+  crc_tables.set_size(8 * 256);
+  for (int v = 0; v < 256; v++) {
+    uint64_t crc = static_cast<uint64_t>(v) << 56;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc << 1) ^ ((crc >> 63) ? poly_word : 0);
+    }
+    crc_tables(v) = crc;
+  }
+  for (int k = 1; k < 8; k++) {
+    for (int v = 0; v < 256; v++) {
+      uint64_t crc = crc_tables(256 * (k - 1) + v);
+      crc_tables(256 * k + v) = (crc << 8) ^ crc_tables(static_cast<int>(crc >> 56));
+    }
+  }
+}
+
+//! \cond
+
+// Eight bytes at a time: the register with the next eight bytes added
+// is shifted through in one step, one table per byte
+static inline uint64_t crc_slice8(uint64_t x, const uint64_t *tables)
+{
+  return tables[7 * 256 + static_cast<int>(x >> 56)]
+         ^ tables[6 * 256 + static_cast<int>((x >> 48) & 255)]
+         ^ tables[5 * 256 + static_cast<int>((x >> 40) & 255)]
+         ^ tables[4 * 256 + static_cast<int>((x >> 32) & 255)]
+         ^ tables[3 * 256 + static_cast<int>((x >> 24) & 255)]
+         ^ tables[2 * 256 + static_cast<int>((x >> 16) & 255)]
+         ^ tables[256 + static_cast<int>((x >> 8) & 255)]
+         ^ tables[static_cast<int>(x & 255)];
+}
+
+//! \endcond
+
+uint64_t CRC_Code::update(uint64_t crc, const bin *bits, int nbits) const
+{
+  const uint64_t *tables = crc_tables._data();
+  int i = 0;
+  uint64_t words[16];
+  while (i + 64 <= nbits) {
+    int nwords = std::min((nbits - i) >> 6, 16);
+    Packed_Bvec::pack(bits + i, 64 * nwords, words);
+    for (int w = 0; w < nwords; w++) {
+      crc = crc_slice8(crc ^ words[w], tables);
+    }
+    i += 64 * nwords;
+  }
+  for (; i + 8 <= nbits; i += 8) {
+    int byte = 0;
+    for (int l = 0; l < 8; l++) {
+      byte = (byte << 1) | static_cast<int>(bits[i + l]);
+    }
+    crc = (crc << 8) ^ tables[static_cast<int>(crc >> 56) ^ byte];
+  }
+  for (; i < nbits; i++) {
+    bool feedback = ((crc >> 63) ^ static_cast<uint64_t>(static_cast<int>(bits[i]))) != 0;
+    crc = (crc << 1) ^ (feedback ? poly_word : 0);
+  }
+  return crc;
+}
+
+uint64_t CRC_Code::update(uint64_t crc, const uint8_t *bytes, int nbytes) const
+{
+  const uint64_t *tables = crc_tables._data();
+  int i = 0;
+  for (; i + 8 <= nbytes; i += 8) {
+    uint64_t word = 0;
+    for (int l = 0; l < 8; l++) {
+      word = (word << 8) | bytes[i + l];
+    }
+    crc = crc_slice8(crc ^ word, tables);
+  }
+  for (; i < nbytes; i++) {
+    crc = (crc << 8) ^ tables[static_cast<int>(crc >> 56) ^ bytes[i]];
+  }
+  return crc;
+}
+
+uint64_t CRC_Code::update(uint64_t crc, const uint64_t *words, int nbits) const
+{
+  const uint64_t *tables = crc_tables._data();
+  int nwords = nbits >> 6;
+  for (int w = 0; w < nwords; w++) {
+    crc = crc_slice8(crc ^ words[w], tables);
+  }
+  // the bits of the last word from the top, a byte and then a bit at a time
+  int rest = nbits & 63;
+  uint64_t word = (rest > 0) ? words[nwords] : 0;
+  for (; rest >= 8; rest -= 8) {
+    crc = (crc << 8) ^ tables[static_cast<int>((crc ^ word) >> 56)];
+    word <<= 8;
+  }
+  for (; rest > 0; rest--) {
+    bool feedback = ((crc ^ word) >> 63) != 0;
+    crc = (crc << 1) ^ (feedback ? poly_word : 0);
+    word <<= 1;
+  }
+  return crc;
+}
+
+void CRC_Code::parity_bits(uint64_t crc, Packed_Bvec &out) const
+{
+  out.set_size(no_parity);
+  out.zeros();
+  for (int i = 0; i < no_parity; i++) {
+    if ((crc >> (63 - i)) & 1) {
+      out.flip(reverse_parity ? no_parity - 1 - i : i);
+    }
+  }
+}
+
+void CRC_Code::parity_bits(uint64_t crc, bvec &out) const
+{
+  out.set_size(no_parity, false);
+  for (int i = 0; i < no_parity; i++) {
+    int bit = static_cast<int>((crc >> (63 - i)) & 1);
+    out(reverse_parity ? no_parity - 1 - i : i) = bit;
+  }
 }
 
 //! \cond
@@ -83,8 +214,39 @@ void CRC_Code::set_code(const std::string &code)
   set_generator(poly);
 }
 
-// Not optimized for speed!
 void CRC_Code::parity(const bvec &in_bits, bvec &out) const
+{
+  if (crc_tables.size() == 0) {
+    parity_bitwise(in_bits, out);
+    return;
+  }
+  parity_bits(update(0, in_bits._data(), in_bits.size()), out);
+}
+
+void CRC_Code::parity(const Vec<uint8_t> &in_bytes, bvec &out) const
+{
+  if (crc_tables.size() == 0) {
+    bvec in_bits(8 * in_bytes.size());
+    for (int i = 0; i < in_bytes.size(); i++) {
+      for (int j = 0; j < 8; j++) {
+        in_bits(8 * i + j) = (in_bytes(i) >> (7 - j)) & 1;
+      }
+    }
+    parity_bitwise(in_bits, out);
+    return;
+  }
+  parity_bits(update(0, in_bytes._data(), in_bytes.size()), out);
+}
+
+bool CRC_Code::check_parity(const Vec<uint8_t> &in_bytes, const bvec &parity_bits) const
+{
+  bvec p;
+  parity(in_bytes, p);
+  return (p == parity_bits);
+}
+
+// Not optimized for speed!
+void CRC_Code::parity_bitwise(const bvec &in_bits, bvec &out) const
 {
   bvec temp = concat(in_bits, zeros_b(no_parity));
 
@@ -102,10 +264,22 @@ void CRC_Code::parity(const bvec &in_bits, bvec &out) const
 
 }
 
-// Not optimized for speed
 bool CRC_Code::check_parity(const bvec &coded_bits) const
 {
   int n = coded_bits.size();
+  if ((crc_tables.size() > 0) && (n >= no_parity)) {
+    // the remainder of the whole word is zero exactly when the parity
+    // bits equal those of the message part
+    bvec p;
+    parity_bits(update(0, coded_bits._data(), n - no_parity), p);
+    for (int i = 0; i < no_parity; i++) {
+      if (p(i) != coded_bits(n - no_parity + i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   bvec temp;
 
   if (reverse_parity) {
@@ -161,4 +335,39 @@ bool CRC_Code::decode(bvec &coded_bits) const
     return false;
 }
 
+void CRC_Code::parity(const Packed_Bvec &in_bits, Packed_Bvec &out) const
+{
+  if (crc_tables.size() == 0) {
+    bvec p;
+    parity_bitwise(in_bits.to_bvec(), p);
+    out = p;
+    return;
+  }
+  parity_bits(update(0, in_bits._data(), in_bits.size()), out);
+}
+
+bool CRC_Code::check_parity(const Packed_Bvec &coded_bits) const
+{
+  int n = coded_bits.size();
+  if ((crc_tables.size() == 0) || (n < no_parity)) {
+    return check_parity(coded_bits.to_bvec());
+  }
+  Packed_Bvec p;
+  parity_bits(update(0, coded_bits._data(), n - no_parity), p);
+  return (p == coded_bits.right(no_parity));
+}
+
+void CRC_Code::encode(const Packed_Bvec &in_bits, Packed_Bvec &out) const
+{
+  Packed_Bvec p;
+  parity(in_bits, p);
+  out = concat(in_bits, p);
+}
+
+bool CRC_Code::decode(const Packed_Bvec &coded_bits, Packed_Bvec &out) const
+{
+  out = coded_bits.left(coded_bits.size() - no_parity);
+  return check_parity(coded_bits);
+}
+
 } // namespace itpp
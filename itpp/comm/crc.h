@@ -31,6 +31,8 @@
 
 #include <itpp/base/vec.h>
 #include <itpp/base/mat.h>
+#include <itpp/base/ittypes.h>
+#include <itpp/base/packed_bvec.h>
 
 
 namespace itpp
@@ -60,6 +62,13 @@ the order of the outbut bits will be:
   coded_bits = crc.encode(bits);
   error = crc.decode(rec_bits, decoded_bits);
   \endcode
+
+  For generator polynomials of degree up to 64 the parity is computed
+  with lookup tables, eight bytes of the message at a time (slice-by-8),
+  and for larger ones by bitwise long division.
+  The tables are built by set_generator(). Messages may also be given as
+  packed bytes, the first bit in the most significant bit of the first
+  byte, or as a Packed_Bvec.
 */
 class CRC_Code
 {
@@ -89,6 +98,12 @@ public:
   //! Return true if parity checks OK otherwise flase
   bool check_parity(const bvec &coded_bits) const;
 
+  //! Calulate the parity bits of a message of packed bytes
+  void parity(const Vec<uint8_t> &in_bytes, bvec &out) const;
+
+  //! Return true if \a parity_bits are the parity bits of the message of packed bytes \a in_bytes
+  bool check_parity(const Vec<uint8_t> &in_bytes, const bvec &parity_bits) const;
+
   //! Calculate and add parity to the in_bits.
   void encode(const bvec &in_bits, bvec &out) const;
 
@@ -101,10 +116,39 @@ public:
   //! Return true if parity checks OK otherwise flase. Also returns the message part in bits.
   bool decode(bvec &bits) const;
 
+  //! Calulate the parity bits of a packed binary vector
+  void parity(const Packed_Bvec &in_bits, Packed_Bvec &out) const;
+
+  //! Return true if parity checks OK otherwise false
+  bool check_parity(const Packed_Bvec &coded_bits) const;
+
+  //! Calculate and add parity to the packed in_bits
+  void encode(const Packed_Bvec &in_bits, Packed_Bvec &out) const;
+
+  //! Return true if parity checks OK otherwise false. Also returns the message part in out.
+  bool decode(const Packed_Bvec &coded_bits, Packed_Bvec &out) const;
+
 private:
   bool reverse_parity;
   bvec polynomial;
   int no_parity;
+
+  //! The generator without its leading term, in the top no_parity bits
+  uint64_t poly_word;
+  //! Eight tables of 256 entries: a byte followed by 0..7 zero bytes shifted through the register
+  Vec<uint64_t> crc_tables;
+  //! Shift \a nbits bits into the register \a crc, the remainder in its top no_parity bits
+  uint64_t update(uint64_t crc, const bin *bits, int nbits) const;
+  //! Shift \a nbytes packed bytes into the register \a crc
+  uint64_t update(uint64_t crc, const uint8_t *bytes, int nbytes) const;
+  //! Shift the first \a nbits bits of the packed words \a words into the register \a crc
+  uint64_t update(uint64_t crc, const uint64_t *words, int nbits) const;
+  //! The parity bits held in the register \a crc
+  void parity_bits(uint64_t crc, bvec &out) const;
+  //! The parity bits held in the register \a crc
+  void parity_bits(uint64_t crc, Packed_Bvec &out) const;
+  //! Bitwise long division, used for generators of degree above 64
+  void parity_bitwise(const bvec &in_bits, bvec &out) const;
 };
 
 } // namespace itpp
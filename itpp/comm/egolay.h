@@ -56,6 +56,11 @@ public:
   //! Destructor
   virtual ~Extended_Golay() { }
 
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
+
   //! Encoder. Will truncate some bits if not \a length = \c integer * 12
   virtual void encode(const bvec &uncoded_bits, bvec &coded_bits);
   //! Encoder. Will truncate some bits if not \a length = \c integer * 12
@@ -73,6 +78,9 @@ public:
   //! Get the code rate
   virtual double get_rate() const { return 0.5; };
 
+  //! Create a copy of the codec (used by \c decode_batch())
+  virtual Channel_Code *clone() const { return new Extended_Golay(*this); }
+
   //! Gets the generator matrix for the code (also the parity check matrix)
   bmat get_G() const { return G; }
 private:
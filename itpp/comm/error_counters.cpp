@@ -73,6 +73,18 @@ void BERC::count(const bvec &in1, const bvec &in2)
   }
 }
 
+void BERC::count(const Packed_Bvec &in1, const Packed_Bvec &in2)
+{
+  int countlength = std::min(in1.length(), in2.length()) - std::abs(delay)
+                    - ignorefirst - ignorelast;
+  if (countlength <= 0)
+    return;
+
+  double local_errors = count_errors(in1, in2, delay, ignorefirst, ignorelast);
+  errors += local_errors;
+  corrects += countlength - local_errors;
+}
+
 void BERC::estimate_delay(const bvec &in1, const bvec &in2, int mindelay,
                           int maxdelay)
 {
@@ -140,6 +152,19 @@ double BERC::count_errors(const bvec &in1, const bvec &in2, int indelay,
   return local_errors;
 }
 
+double BERC::count_errors(const Packed_Bvec &in1, const Packed_Bvec &in2,
+                          int indelay, int inignorefirst, int inignorelast)
+{
+  int countlength = std::min(in1.length(), in2.length()) - std::abs(indelay)
+                    - inignorefirst - inignorelast;
+  if (countlength <= 0)
+    return 0;
+
+  int start1 = inignorefirst + ((indelay < 0) ? -indelay : 0);
+  int start2 = inignorefirst + ((indelay > 0) ? indelay : 0);
+  return in1.mid(start1, countlength).hamming_distance(in2.mid(start2, countlength));
+}
+
 
 //-----------------------------------------------------------
 // The Block error rate counter class (BERC)
@@ -31,6 +31,7 @@
 #define ERROR_COUNTERS_H
 
 #include <itpp/base/vec.h>
+#include <itpp/base/packed_bvec.h>
 
 
 namespace itpp
@@ -79,6 +80,8 @@ public:
   BERC(int indelay = 0, int inignorefirst = 0, int inignorelast = 0);
   //! Cumulative error counter
   void count(const bvec &in1, const bvec &in2);
+  //! Cumulative error counter for packed vectors, 64 bits at a time
+  void count(const Packed_Bvec &in1, const Packed_Bvec &in2);
   //! Run this member function if the delay between \a in1 and
   //! \a in2 is unknown.
   void estimate_delay(const bvec &in1, const bvec &in2, int mindelay = -100,
@@ -110,6 +113,10 @@ public:
   static double count_errors(const bvec &in1, const bvec &in2,
                              int indelay = 0, int inignorefirst = 0,
                              int inignorelast = 0);
+  //! Number of errors between the packed vectors \a in1 and \a in2
+  static double count_errors(const Packed_Bvec &in1, const Packed_Bvec &in2,
+                             int indelay = 0, int inignorefirst = 0,
+                             int inignorelast = 0);
 
 private:
   int delay;
@@ -31,6 +31,24 @@
 #include <itpp/base/itcompat.h>
 #include <iostream>
 
+// The PSHUFB kernels are used when the compiler targets SSSE3. Otherwise,
+// with GCC or Clang on x86, they are compiled for SSSE3 separately and
+// used if the processor supports it.
+#if defined(__SSSE3__)
+#  define GF_SSSE3
+#  define GF_SSSE3_TARGET
+#elif (defined(__x86_64__) || defined(__i386__)) \
+  && (defined(__clang__) || (__GNUC__ > 4) \
+      || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#  define GF_SSSE3
+#  define GF_SSSE3_DISPATCH
+#  define GF_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+#if defined(GF_SSSE3)
+#  include <tmmintrin.h>
+#endif
+
 
 namespace itpp
 {
@@ -119,6 +137,259 @@ std::ostream &operator<<(std::ostream &os, const GFX &ingfx)
   return os;
 }
 
+// --------------- class GF_Bulk -----------------------
+
+void GF_Bulk::set_size(int qvalue)
+{
+  GF alpha(qvalue); // builds the tables of GF(q)
+  q = qvalue;
+  int n = q - 1;
+
+  exp_table.set_size(2 * n);
+  log_table.set_size(q);
+  log_table(0) = 0;
+  for (int i = 0; i < n; i++) {
+    exp_table(i) = exp_table(i + n)
+                   = static_cast<uint16_t>(bin2dec(GF(q, i).get_vectorspace()));
+    log_table(exp_table(i)) = static_cast<uint16_t>(i);
+  }
+
+  if (q <= 256) {
+    uint16_t table[64];
+    byte_products.set_size(32 * q);
+    for (int c = 0; c < q; c++) {
+      nibble_products(c, table);
+      for (int j = 0; j < 32; j++) {
+        byte_products(32 * c + j) = static_cast<uint8_t>(table[j]);
+      }
+    }
+  }
+  else {
+    byte_products.set_size(0);
+  }
+}
+
+void GF_Bulk::nibble_products(int c, uint16_t *table) const
+{
+  for (int p = 0; p < 4; p++) {
+    for (int j = 0; j < 16; j++) {
+      int x = j << (4 * p);
+      table[16 * p + j] = static_cast<uint16_t>((x < q) ? mul(c, x) : 0);
+    }
+  }
+}
+
+//! \cond
+
+#if defined(GF_SSSE3)
+// True if the processor can run the SSSE3 kernels
+static bool have_ssse3()
+{
+#  if defined(GF_SSSE3_DISPATCH)
+  static const bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+#  else
+  return true;
+#  endif
+}
+
+// Products of 16 bytes with the constant of the nibble tables lo and hi
+GF_SSSE3_TARGET static inline __m128i gf_mul_bytes(__m128i x, __m128i lo,
+                                                   __m128i hi)
+{
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  __m128i l = _mm_and_si128(x, mask);
+  __m128i h = _mm_and_si128(_mm_srli_epi64(x, 4), mask);
+  return _mm_xor_si128(_mm_shuffle_epi8(lo, l), _mm_shuffle_epi8(hi, h));
+}
+
+// Products of 8 words with the constant of the nibble tables. Each nibble
+// index has a zero high byte, which selects the zero product, so the high
+// byte of the product comes from a second table shifted into place.
+GF_SSSE3_TARGET static inline __m128i gf_mul_words(__m128i x,
+                                                   const __m128i *lo,
+                                                   const __m128i *hi)
+{
+  const __m128i mask = _mm_set1_epi16(0x000f);
+  __m128i r = _mm_setzero_si128();
+  for (int p = 0; p < 4; p++) {
+    __m128i idx = _mm_and_si128(_mm_srli_epi16(x, 4 * p), mask);
+    r = _mm_xor_si128(r, _mm_shuffle_epi8(lo[p], idx));
+    r = _mm_xor_si128(r, _mm_slli_epi16(_mm_shuffle_epi8(hi[p], idx), 8));
+  }
+  return r;
+}
+
+// dst[i] = c * src[i] (or dst[i] += c * src[i] if add is true) for the
+// multiples of 16 bytes, with the 32-entry nibble table t of c. Returns
+// the number of bytes done.
+GF_SSSE3_TARGET static int gf_mul_region_ssse3(const uint8_t *t,
+                                               const uint8_t *src,
+                                               uint8_t *dst, int len,
+                                               bool add)
+{
+  __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(t));
+  __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(t + 16));
+  int i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i y = gf_mul_bytes(x, lo, hi);
+    if (add) {
+      __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+      y = _mm_xor_si128(y, d);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), y);
+  }
+  return i;
+}
+
+// The same for the multiples of 8 words, with the 64-entry nibble table t
+GF_SSSE3_TARGET static int gf_mul_region_ssse3(const uint16_t *t,
+                                               const uint16_t *src,
+                                               uint16_t *dst, int len,
+                                               bool add)
+{
+  __m128i lo[4], hi[4];
+  for (int p = 0; p < 4; p++) {
+    uint8_t l[16], h[16];
+    for (int j = 0; j < 16; j++) {
+      l[j] = static_cast<uint8_t>(t[16 * p + j]);
+      h[j] = static_cast<uint8_t>(t[16 * p + j] >> 8);
+    }
+    lo[p] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l));
+    hi[p] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h));
+  }
+  int i = 0;
+  for (; i + 8 <= len; i += 8) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i y = gf_mul_words(x, lo, hi);
+    if (add) {
+      __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+      y = _mm_xor_si128(y, d);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), y);
+  }
+  return i;
+}
+#endif
+
+//! \endcond
+
+void GF_Bulk::mul_region(const uint8_t *src, uint8_t *dst, int len,
+                         int c) const
+{
+  it_assert_debug((q > 0) && (q <= 256), "GF_Bulk::mul_region(): "
+                  "Byte arrays need q <= 256");
+  const uint8_t *t = byte_products._data() + 32 * c;
+  int i = 0;
+#if defined(GF_SSSE3)
+  if (have_ssse3())
+    i = gf_mul_region_ssse3(t, src, dst, len, false);
+#endif
+  for (; i < len; i++) {
+    dst[i] = t[src[i] & 15] ^ t[16 + (src[i] >> 4)];
+  }
+}
+
+void GF_Bulk::mul_add_region(const uint8_t *src, uint8_t *dst, int len,
+                             int c) const
+{
+  it_assert_debug((q > 0) && (q <= 256), "GF_Bulk::mul_add_region(): "
+                  "Byte arrays need q <= 256");
+  const uint8_t *t = byte_products._data() + 32 * c;
+  int i = 0;
+#if defined(GF_SSSE3)
+  if (have_ssse3())
+    i = gf_mul_region_ssse3(t, src, dst, len, true);
+#endif
+  for (; i < len; i++) {
+    dst[i] ^= t[src[i] & 15] ^ t[16 + (src[i] >> 4)];
+  }
+}
+
+void GF_Bulk::mul_region(const uint16_t *src, uint16_t *dst, int len,
+                         int c) const
+{
+  it_assert_debug(q > 0, "GF_Bulk::mul_region(): Field not set");
+  uint16_t t[64];
+  nibble_products(c, t);
+  int i = 0;
+#if defined(GF_SSSE3)
+  if (have_ssse3())
+    i = gf_mul_region_ssse3(t, src, dst, len, false);
+#endif
+  for (; i < len; i++) {
+    uint16_t x = src[i];
+    dst[i] = t[x & 15] ^ t[16 + ((x >> 4) & 15)] ^ t[32 + ((x >> 8) & 15)]
+             ^ t[48 + (x >> 12)];
+  }
+}
+
+void GF_Bulk::mul_add_region(const uint16_t *src, uint16_t *dst, int len,
+                             int c) const
+{
+  it_assert_debug(q > 0, "GF_Bulk::mul_add_region(): Field not set");
+  uint16_t t[64];
+  nibble_products(c, t);
+  int i = 0;
+#if defined(GF_SSSE3)
+  if (have_ssse3())
+    i = gf_mul_region_ssse3(t, src, dst, len, true);
+#endif
+  for (; i < len; i++) {
+    uint16_t x = src[i];
+    dst[i] ^= t[x & 15] ^ t[16 + ((x >> 4) & 15)] ^ t[32 + ((x >> 8) & 15)]
+              ^ t[48 + (x >> 12)];
+  }
+}
+
+void GF_Bulk::add_region(const uint8_t *src, uint8_t *dst, int len)
+{
+  for (int i = 0; i < len; i++) {
+    dst[i] ^= src[i];
+  }
+}
+
+void GF_Bulk::add_region(const uint16_t *src, uint16_t *dst, int len)
+{
+  for (int i = 0; i < len; i++) {
+    dst[i] ^= src[i];
+  }
+}
+
+template<class T>
+void GF_Bulk::eval_poly_impl(const T *coeffs, int degree, const T *points,
+                             T *values, int npoints) const
+{
+  for (int i = 0; i < npoints; i++) {
+    values[i] = coeffs[degree];
+  }
+  for (int j = degree - 1; j >= 0; j--) {
+    for (int i = 0; i < npoints; i++) {
+      int v = values[i], x = points[i];
+      v = ((v == 0) || (x == 0)) ? 0 : exp_table(log_table(v) + log_table(x));
+      values[i] = static_cast<T>(v ^ coeffs[j]);
+    }
+  }
+}
+
+void GF_Bulk::eval_poly(const uint8_t *coeffs, int degree,
+                        const uint8_t *points, uint8_t *values,
+                        int npoints) const
+{
+  it_assert_debug((q > 0) && (q <= 256), "GF_Bulk::eval_poly(): "
+                  "Byte arrays need q <= 256");
+  eval_poly_impl(coeffs, degree, points, values, npoints);
+}
+
+void GF_Bulk::eval_poly(const uint16_t *coeffs, int degree,
+                        const uint16_t *points, uint16_t *values,
+                        int npoints) const
+{
+  it_assert_debug(q > 0, "GF_Bulk::eval_poly(): Field not set");
+  eval_poly_impl(coeffs, degree, points, values, npoints);
+}
+
 //----------------- Help Functions -----------------
 
 //! Division of two GFX (local help function)
@@ -33,6 +33,7 @@
 #include <itpp/base/array.h>
 #include <itpp/base/binary.h>
 #include <itpp/base/converters.h>
+#include <itpp/base/ittypes.h>
 
 
 namespace itpp
@@ -249,6 +250,93 @@ GFX divgfx(const GFX &c, const GFX &g);
 */
 GFX modgfx(const GFX &a, const GFX &b);
 
+/*!
+  \brief Bulk arithmetic on arrays of GF(q) elements, where q=2^m, m=1,...,16
+
+  The elements are stored as integers in the vector space representation
+  returned by GF::get_vectorspace(), that is, bit i is the coefficient of
+  alpha^i. Fields with q <= 256 may use \c uint8_t arrays, all fields may
+  use \c uint16_t arrays. Addition is a bitwise XOR.
+
+  Multiplication by a constant splits every element into nibbles and looks
+  up the product of each nibble in a 16-entry table. On x86 processors
+  with SSSE3 the lookups are done 16 bytes at a time with PSHUFB. With GCC
+  or Clang this is detected at run time, so it does not need -mssse3.
+
+  Example: c(x) = g(x) m(x) for many messages at once, stored symbol by
+  symbol (row j holds symbol j of all \c words messages)
+  \code
+  GF_Bulk field(256);
+  for (int l = 0; l <= deg_g; l++)
+    field.mul_add_region(msg, code + l * words, k * words, g[l]);
+  \endcode
+*/
+class GF_Bulk
+{
+public:
+  //! Default constructor
+  GF_Bulk(): q(0) {}
+  //! Constructor for GF(q)
+  GF_Bulk(int qvalue) { set_size(qvalue); }
+  //! Set q=2^m
+  void set_size(int qvalue);
+  //! Return q
+  int get_size() const { return q; }
+
+  //! Product of two elements
+  int mul(int a, int b) const {
+    return ((a == 0) || (b == 0)) ? 0 : exp_table(log_table(a) + log_table(b));
+  }
+  //! alpha^i, for 0 <= i < 2(q-1)
+  int alpha_pow(int i) const { return exp_table(i); }
+  //! Logarithm of the nonzero element \a a, in the range 0, ..., q-2
+  int log_alpha(int a) const { return log_table(a); }
+  //! The powers alpha^0, ..., alpha^(2q-3), e.g. as points for eval_poly()
+  const uint16_t *alpha_pow_table() const { return exp_table._data(); }
+
+  //! dst[i] = c * src[i] for \a len elements (q <= 256)
+  void mul_region(const uint8_t *src, uint8_t *dst, int len, int c) const;
+  //! dst[i] = c * src[i] for \a len elements
+  void mul_region(const uint16_t *src, uint16_t *dst, int len, int c) const;
+  //! dst[i] += c * src[i] for \a len elements (q <= 256)
+  void mul_add_region(const uint8_t *src, uint8_t *dst, int len, int c) const;
+  //! dst[i] += c * src[i] for \a len elements
+  void mul_add_region(const uint16_t *src, uint16_t *dst, int len, int c) const;
+  //! dst[i] += src[i] for \a len elements
+  static void add_region(const uint8_t *src, uint8_t *dst, int len);
+  //! dst[i] += src[i] for \a len elements
+  static void add_region(const uint16_t *src, uint16_t *dst, int len);
+
+  /*!
+    \brief Evaluate a polynomial at many points (q <= 256)
+
+    Computes values[i] = p(points[i]) for \a npoints points, where
+    p(x) = coeffs[0] + coeffs[1] x + ... + coeffs[degree] x^degree. The
+    Horner recursions of the points are interleaved, so they do not wait
+    for each other.
+  */
+  void eval_poly(const uint8_t *coeffs, int degree, const uint8_t *points,
+                 uint8_t *values, int npoints) const;
+  //! Evaluate a polynomial at many points
+  void eval_poly(const uint16_t *coeffs, int degree, const uint16_t *points,
+                 uint16_t *values, int npoints) const;
+
+private:
+  //! Products of c with a nibble at positions 0, 4, 8 and 12 (16 entries each)
+  void nibble_products(int c, uint16_t *table) const;
+  template<class T>
+  void eval_poly_impl(const T *coeffs, int degree, const T *points,
+                      T *values, int npoints) const;
+
+  int q;
+  //! Powers of alpha, stored twice so that a sum of two logarithms needs no modulo
+  Vec<uint16_t> exp_table;
+  //! Logarithms of the nonzero elements
+  Vec<uint16_t> log_table;
+  //! Products with the low and high nibble for every constant (q <= 256)
+  Vec<uint8_t> byte_products;
+};
+
 
 // --------------- Inlines ------------------------
 // --------------- class GF -----------------------
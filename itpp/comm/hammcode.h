@@ -50,6 +50,11 @@ public:
   //! Destructor
   virtual ~Hamming_Code() { }
 
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
+
   //! Hamming encoder. Will truncate some bits if not \a length = \c integer * \a k.
   virtual void encode(const bvec &uncoded_bits, bvec &coded_bits);
   //! Hamming encoder. Will truncate some bits if not \a length = \c integer * \a k.
@@ -67,6 +72,9 @@ public:
   //! Get the code rate
   virtual double get_rate() const { return static_cast<double>(k) / n; };
 
+  //! Create a copy of the codec (used by \c decode_batch())
+  virtual Channel_Code *clone() const { return new Hamming_Code(*this); }
+
   //! Gets the code length \a n.
   int get_n() const { return n; };
   //! Gets the number of information bits per code word, \a k.
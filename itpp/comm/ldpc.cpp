@@ -27,8 +27,14 @@
  */
 
 #include <itpp/comm/ldpc.h>
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <vector>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
 
 namespace itpp
 {
@@ -595,6 +601,223 @@ void LDPC_Parity_Unstructured::generate_random_H(const ivec& C,
   }
 }
 
+void LDPC_Parity_Unstructured::generate_PEG_H(const ivec& C, const ivec& R,
+    const ivec& cycopt)
+{
+  // Progressive edge-growth construction (X.-Y. Hu, E. Eleftheriou and
+  // D. M. Arnold, "Regular and irregular progressive edge-growth Tanner
+  // graphs", IEEE Trans. on Inf. Theory, Jan. 2005). The edges of each
+  // variable node are placed one by one, on a check node as far as
+  // possible from the variable node in the graph built so far, and on
+  // the least connected one among the candidates. The breadth-first
+  // search stops as soon as the girth target is met.
+
+  initialize(sum(R), sum(C));
+  // C, R: Target number of columns/rows with certain number of ones
+
+  // target degrees, variable nodes in ascending order of degree
+  ivec vd(nvar);
+  ivec cd(ncheck);
+  int l = 0;
+  for (int i = 0; i < C.length(); i++) {
+    for (int j = 0; j < C(i); j++) {
+      vd(l++) = i;
+    }
+  }
+  l = 0;
+  for (int i = 0; i < R.length(); i++) {
+    for (int j = 0; j < R(i); j++) {
+      cd(l++) = i;
+    }
+  }
+  it_assert(sum(vd) == sum(cd), "C/R mismatch");
+
+  // set the girth goal for various variable node degrees
+  ivec Laim = zeros_i(Nmax);
+  for (int i = 0; i < length(cycopt); i++) {
+    Laim(i + 2) = cycopt(i);
+  }
+  for (int i = length(cycopt); i < Nmax - 2; i++) {
+    Laim(i + 2) = cycopt(length(cycopt) - 1);
+  }
+  it_info_debug("Running with Laim=" << Laim.left(25));
+
+  // adjacency lists of the graph built so far
+  ivec v_start(nvar + 1);
+  ivec c_start(ncheck + 1);
+  v_start(0) = 0;
+  for (int i = 0; i < nvar; i++) {
+    v_start(i + 1) = v_start(i) + vd(i);
+  }
+  c_start(0) = 0;
+  for (int j = 0; j < ncheck; j++) {
+    c_start(j + 1) = c_start(j) + cd(j);
+  }
+  ivec v_adj(v_start(nvar));
+  ivec c_adj(c_start(ncheck));
+  ivec v_cnt = zeros_i(nvar);
+  ivec c_cnt = zeros_i(ncheck);
+
+  // check nodes which can take more edges, sorted by their current
+  // degree (b_pos is the position of a check node in its list)
+  std::vector<std::vector<int> > bucket(max(cd) + 1);
+  ivec b_pos(ncheck);
+  ivec rp = sort_index(randu(ncheck));
+  int nspare = 0;
+  for (int j = 0; j < ncheck; j++) {
+    if (cd(rp(j)) > 0) {
+      b_pos(rp(j)) = bucket[0].size();
+      bucket[0].push_back(rp(j));
+      nspare++;
+    }
+  }
+
+  // marks of the nodes visited by the current search
+  ivec v_mark = zeros_i(nvar);
+  ivec c_mark = zeros_i(ncheck);
+  int stamp = 0;
+  std::vector<int> reached;
+  std::vector<int> cur_vars;
+  std::vector<int> next_vars;
+
+  int failures = 0;
+  for (int v = 0; v < nvar; v++) {
+    if (v % 250 == 0) {
+      it_info_debug("Processing variable node: " << v << " out of " << nvar
+                    << ". Variable node degree: " << vd(v)
+                    << ". Girth target: " << Laim(vd(v))
+                    << ". Accumulated failures: " << failures);
+    }
+    const int L = Laim(vd(v));
+    for (int k = 0; k < vd(v); k++) {
+      stamp++;
+      reached.clear();
+      int first = 0;
+      bool all_reached = false;
+
+      if ((k == 0) || (L == 0)) {
+        // no search, only avoid double edges
+        for (int e = v_start(v); e < v_start(v) + v_cnt(v); e++) {
+          c_mark(v_adj(e)) = stamp;
+        }
+      }
+      else {
+        // expand the tree of v level by level; check nodes reached at
+        // level n would close cycles of length 2n+2
+        cur_vars.assign(1, v);
+        v_mark(v) = stamp;
+        int nspare_reached = 0;
+        for (int n = 0; 2 * n + 2 < L; n++) {
+          first = reached.size();
+          for (size_t i = 0; i < cur_vars.size(); i++) {
+            int u = cur_vars[i];
+            for (int e = v_start(u); e < v_start(u) + v_cnt(u); e++) {
+              int c = v_adj(e);
+              if (c_mark(c) != stamp) {
+                c_mark(c) = stamp;
+                reached.push_back(c);
+                if (c_cnt(c) < cd(c)) {
+                  nspare_reached++;
+                }
+              }
+            }
+          }
+          if (static_cast<int>(reached.size()) == first) {
+            break; // the tree does not grow anymore
+          }
+          if (nspare_reached == nspare) {
+            all_reached = true;
+            break;
+          }
+          next_vars.clear();
+          for (size_t i = first; i < reached.size(); i++) {
+            int c = reached[i];
+            for (int e = c_start(c); e < c_start(c) + c_cnt(c); e++) {
+              int w = c_adj(e);
+              if (v_mark(w) != stamp) {
+                v_mark(w) = stamp;
+                next_vars.push_back(w);
+              }
+            }
+          }
+          cur_vars.swap(next_vars);
+        }
+      }
+
+      int c = -1;
+      if (all_reached) {
+        // choose among the check nodes reached last, unless these are
+        // neighbours of v already
+        if (first > 0) {
+          int nties = 0;
+          for (size_t i = first; i < reached.size(); i++) {
+            int r = reached[i];
+            if (c_cnt(r) < cd(r)) {
+              if ((c < 0) || (c_cnt(r) < c_cnt(c))) {
+                c = r;
+                nties = 1;
+              }
+              else if ((c_cnt(r) == c_cnt(c)) && (randi(0, nties++) == 0)) {
+                c = r;
+              }
+            }
+          }
+        }
+      }
+      else {
+        // the least connected check node not reached by the search
+        for (size_t d = 0; (d < bucket.size()) && (c < 0); d++) {
+          int size = bucket[d].size();
+          if (size == 0) {
+            continue;
+          }
+          int offset = randi(0, size - 1);
+          for (int i = 0; i < size; i++) {
+            int r = bucket[d][(offset + i) % size];
+            if (c_mark(r) != stamp) {
+              c = r;
+              break;
+            }
+          }
+        }
+      }
+
+      if (c < 0) {
+        // every check node that can take more edges is a neighbour of v
+        // already, so no girth target would help: the edge is dropped
+        failures++;
+        continue;
+      }
+
+      // place the edge
+      set(c, v, 1);
+      v_adj(v_start(v) + v_cnt(v)++) = c;
+      c_adj(c_start(c) + c_cnt(c)) = v;
+      std::vector<int> &old_list = bucket[c_cnt(c)];
+      int moved = old_list.back();
+      old_list[b_pos(c)] = moved;
+      b_pos(moved) = b_pos(c);
+      old_list.pop_back();
+      c_cnt(c)++;
+      if (c_cnt(c) < cd(c)) {
+        b_pos(c) = bucket[c_cnt(c)].size();
+        bucket[c_cnt(c)].push_back(c);
+      }
+      else {
+        nspare--;
+      }
+    }
+  }
+
+  it_info_debug("PEG construction finished. Accumulated failures: "
+                << failures);
+  if (failures > 0) {
+    it_warning("LDPC_Parity_Unstructured::generate_PEG_H(): " << failures
+               << " edge(s) could not be placed without a double edge; "
+               "the node degrees differ from the requested ones");
+  }
+}
+
 void LDPC_Parity_Unstructured::compute_CR(const vec& var_deg, const vec& chk_deg, const int Nvar,
     ivec &C, ivec &R)
 {
@@ -681,6 +904,9 @@ void LDPC_Parity_Regular::generate(int Nvar, int k, int l,
   if (method == "rand") {
     generate_random_H(C, R, options);
   }
+  else if (method == "PEG") {
+    generate_PEG_H(C, R, options);
+  }
   else {
     it_error("not implemented");
   };
@@ -711,6 +937,9 @@ void LDPC_Parity_Irregular::generate(int Nvar, const vec& var_deg,
   if (method == "rand") {
     generate_random_H(C, R, options);
   }
+  else if (method == "PEG") {
+    generate_PEG_H(C, R, options);
+  }
   else {
     it_error("not implemented");
   };
@@ -898,9 +1127,6 @@ ivec LDPC_Generator_Systematic::construct(LDPC_Parity* const H,
   int nvar = H->get_nvar();
   int ncheck = H->get_ncheck();
 
-  // create dense representation of parity check matrix
-  GF2mat Hd(H->get_H());
-
   // -- Determine initial column ordering --
   ivec col_order(nvar);
   if (natural_ordering) {
@@ -921,71 +1147,75 @@ ivec LDPC_Generator_Systematic::construct(LDPC_Parity* const H,
 
   // Now partition P as P=[P1 P2]. Then find G so [P1 P2][I G]'=0.
 
-  // -- Create P1 and P2 --
-  GF2mat P1; //(ncheck,nvar-ncheck);      // non-invertible part
-  GF2mat P2; //(ncheck,ncheck);           // invertible part
-
   it_info_debug("Computing a systematic generator matrix...");
 
+  // -- Reduce the reordered parity check matrix R = P2^{-1} [P1 P2] --
+  // The columns that get a pivot are those that are independent of the
+  // columns before them in col_order: they form the invertible part P2,
+  // and the other columns of R are P2^{-1} P1.
+  GF2mat R(H->get_H(), col_order);
+  ivec pivots;
+  int rank = R.rref(pivots);
+
+  bvec is_pivot = zeros_b(nvar);
+  for (int i = 0; i < rank; i++) {
+    is_pivot(pivots(i)) = 1;
+  }
+
+  // -- Create P1 and P2 --
+  ivec R_cols(nvar);
   int j1 = 0, j2 = 0;
-  int rank;
-  ivec perm;
-  GF2mat T, U;
   for (int k = 0; k < nvar; k++) {
     it_error_if(j1 >= nvar - ncheck, "LDPC_Generator_Systematic::construct(): "
                 "Unable to obtain enough independent columns.");
 
-    bvec c = Hd.get_col(col_order(k));
-    if (j2 == 0) {     // first column in P2 is number col_order(k)
-      P2 = GF2mat(c);
-      rank = P2.T_fact(T, U, perm);
-      actual_ordering(k) = nvar - ncheck;
+    if (is_pivot(k) == 1) {
+      actual_ordering(k) = nvar - ncheck + j2;
       j2++;
     }
     else {
-      if (j2 < ncheck) {
-        if (P2.T_fact_update_addcol(T, U, perm, c)) {
-          P2 = P2.concatenate_horizontal(c);
-          actual_ordering(k) = nvar - ncheck + j2;
-          j2++;
-          continue;
-        }
-      }
-      if (j1 == 0) {
-        P1 = GF2mat(c);
-        actual_ordering(k) = j1;
-      }
-      else {
-        P1 = P1.concatenate_horizontal(c);
-        actual_ordering(k) = j1;
-      }
+      actual_ordering(k) = j1;
       j1++;
     }
+    R_cols(actual_ordering(k)) = k;
   }
 
   it_info_debug("Rank of parity check matrix: " << j2);
 
   // -- Compute the systematic part of the generator matrix --
-  G = (P2.inverse() * P1).transpose();
+  // (stored in transposed form, that is G = P2^{-1} P1)
+  R.permute_cols(R_cols, 0);
+  G = R.get_submatrix(0, 0, ncheck - 1, nvar - ncheck - 1);
 
   // -- Permute the columns of the parity check matrix --
-  GF2mat P = P1.concatenate_horizontal(P2);
+  // (row by row, in the order that P=[P1 P2] was copied to H before)
+  ivec new_col(nvar);
+  for (int k = 0; k < nvar; k++) {
+    new_col(col_order(k)) = actual_ordering(k);
+  }
+  GF2mat_sparse Ht = H->get_H(true);
   *H = LDPC_Parity(ncheck, nvar);
-  // brute force copy from P to H
   for (int i = 0; i < ncheck; i++) {
-    for (int j = 0; j < nvar; j++) {
-      if (P.get(i, j)) {
-        H->set(i, j, 1);
+    GF2vec_sparse row = Ht.get_col(i);
+    ivec cols(row.nnz());
+    int n = 0;
+    for (int l = 0; l < row.nnz(); l++) {
+      if (row.get_nz_data(l) == 1) {
+        cols(n++) = new_col(row.get_nz_index(l));
       }
     }
+    cols.set_size(n, true);
+    sort(cols);
+    for (int l = 0; l < n; l++) {
+      H->set(i, cols(l), 1);
+    }
   }
 
   // -- Check that the result was correct --
   it_assert_debug((GF2mat(H->get_H())
-                   * (gf2dense_eye(nvar - ncheck).concatenate_horizontal(G)).transpose()).is_zero(),
+                   * gf2dense_eye(nvar - ncheck).concatenate_vertical(G)).is_zero(),
                   "LDPC_Generator_Systematic::construct(): Incorrect generator matrix G");
 
-  G = G.transpose();  // store the generator matrix in transposed form
   it_info_debug("Systematic generator matrix computed.");
 
   init_flag = true;
@@ -1201,434 +1431,1602 @@ void BLDPC_Generator::load(const std::string& filename)
 
 
 // ----------------------------------------------------------------------
-// LDPC_Code
+// LDPC_Generator_Sparse
 // ----------------------------------------------------------------------
 
-LDPC_Code::LDPC_Code(): H_defined(false), G_defined(false), dec_method("BP"),
-    max_iters(50), psc(true), pisc(false),
-    llrcalc(LLR_calc_unit()) { }
-
-LDPC_Code::LDPC_Code(const LDPC_Parity* const H,
-                     LDPC_Generator* const G_in,
-                     bool perform_integrity_check):
-    H_defined(false), G_defined(false), dec_method("BP"), max_iters(50),
-    psc(true), pisc(false), llrcalc(LLR_calc_unit())
+//! \cond
+
+/*
+  Greedy reduction of a parity check matrix to approximate lower
+  triangular form. The variables flagged in "known" are never used as
+  pivots. While some check has a single unknown variable, this variable
+  becomes the pivot of a new row of T. Otherwise, all unknown variables
+  but the one of lowest degree of a check with the fewest unknowns are
+  declared known. The checks are returned in encoding order, i.e. the
+  rows of T first, and the function returns the number of rows of T.
+*/
+static int ldpc_alt_triangulate(const ivec &c_ptr, const ivec &c_var,
+                                const ivec &v_ptr, const ivec &v_chk,
+                                bvec known, ivec &order, ivec &pivots,
+                                ivec &declared)
 {
-    set_code(H, G_in, perform_integrity_check);
-}
+  int ncheck = c_ptr.size() - 1;
+  int nvar = v_ptr.size() - 1;
+
+  // number of unknown variables of each check
+  ivec degree(ncheck);
+  bvec done(ncheck);
+  done.zeros();
+  int max_degree = 0;
+  for (int c = 0; c < ncheck; c++) {
+    degree(c) = 0;
+    for (int e = c_ptr(c); e < c_ptr(c + 1); e++) {
+      if (known(c_var(e)) == bin(0)) {
+        degree(c)++;
+      }
+    }
+    max_degree = std::max(max_degree, degree(c));
+  }
+  // checks sorted by their degrees (outdated entries are skipped)
+  std::vector<std::vector<int> > bucket(max_degree + 1);
+  for (int c = 0; c < ncheck; c++) {
+    bucket[degree(c)].push_back(c);
+  }
 
-LDPC_Code::LDPC_Code(const std::string& filename,
-                     LDPC_Generator* const G_in):
-    H_defined(false), G_defined(false), dec_method("BP"), max_iters(50),
-    psc(true), pisc(false), llrcalc(LLR_calc_unit())
-{
-  load_code(filename, G_in);
-}
+  order.set_size(ncheck);
+  pivots.set_size(ncheck);
+  declared.set_size(nvar);
+  int t = 0;
+  int nd = 0;
+  while (true) {
+    int c = -1;
+    for (int d = 1; (d <= max_degree) && (c < 0); d++) {
+      while (!bucket[d].empty()) {
+        int cand = bucket[d].back();
+        bucket[d].pop_back();
+        if ((done(cand) == bin(0)) && (degree(cand) == d)) {
+          c = cand;
+          break;
+        }
+      }
+    }
+    if (c < 0) {
+      break;
+    }
+    done(c) = 1;
+
+    int pivot = -1;
+    for (int e = c_ptr(c); e < c_ptr(c + 1); e++) {
+      int v = c_var(e);
+      if ((known(v) == bin(0)) && ((pivot < 0)
+                                   || (v_ptr(v + 1) - v_ptr(v)
+                                       < v_ptr(pivot + 1) - v_ptr(pivot)))) {
+        pivot = v;
+      }
+    }
+    for (int e = c_ptr(c); e < c_ptr(c + 1); e++) {
+      int v = c_var(e);
+      if (known(v) == bin(1)) {
+        continue;
+      }
+      if (v != pivot) {
+        declared(nd++) = v;
+      }
+      known(v) = 1;
+      for (int f = v_ptr(v); f < v_ptr(v + 1); f++) {
+        int c2 = v_chk(f);
+        if (done(c2) == bin(0)) {
+          degree(c2)--;
+          if (degree(c2) > 0) {
+            bucket[degree(c2)].push_back(c2);
+          }
+        }
+      }
+    }
+    order(t) = c;
+    pivots(t) = pivot;
+    t++;
+  }
 
+  // variables not connected to any of the remaining checks
+  for (int v = 0; v < nvar; v++) {
+    if (known(v) == bin(0)) {
+      declared(nd++) = v;
+    }
+  }
+  // the remaining checks form the last g rows
+  int r = t;
+  for (int c = 0; c < ncheck; c++) {
+    if (done(c) == bin(0)) {
+      order(r++) = c;
+    }
+  }
+  pivots.set_size(t, true);
+  declared.set_size(nd, true);
+  return t;
+}
 
-void LDPC_Code::set_code(const LDPC_Parity* const H,
-                         LDPC_Generator* const G_in,
-                         bool perform_integrity_check)
+/*
+  Coefficients of the variables "cols" in the checks left over by the
+  triangulation, after the pivots of T have been eliminated from them,
+  i.e. the columns "cols" of [C D] + E T^{-1} [A B].
+*/
+static GF2mat ldpc_alt_gap_matrix(const ivec &c_ptr, const ivec &c_var,
+                                  const ivec &order, const ivec &pivots,
+                                  const ivec &cols, int nvar)
 {
-  decoder_parameterization(H);
-  setup_decoder();
-  G = G_in;
-  if (G != 0) {
-    G_defined = true;
-    if (perform_integrity_check) {
-      integrity_check();
-    } else {
-      it_info_debug("LDPC_Code::set_code(): integrity check was not performed");
+  int t = pivots.size();
+  int g = order.size() - t;
+  GF2mat phi(g, cols.size());
+  bvec y(nvar);
+  for (int i = 0; i < g; i++) {
+    y.zeros();
+    int c = order(t + i);
+    for (int e = c_ptr(c); e < c_ptr(c + 1); e++) {
+      y(c_var(e)) = 1;
+    }
+    // substitute the pivots in reverse order of the rows of T
+    for (int s = t - 1; s >= 0; s--) {
+      if (y(pivots(s)) == bin(1)) {
+        c = order(s);
+        for (int e = c_ptr(c); e < c_ptr(c + 1); e++) {
+          y(c_var(e)) += 1;
+        }
+      }
+    }
+    for (int j = 0; j < cols.size(); j++) {
+      if (y(cols(j)) == bin(1)) {
+        phi.set(i, j, 1);
+      }
     }
   }
+  return phi;
 }
 
-void LDPC_Code::load_code(const std::string& filename,
-                          LDPC_Generator* const G_in)
+//! \endcond
+
+
+LDPC_Generator_Sparse::LDPC_Generator_Sparse(LDPC_Parity* const H,
+    bool natural_ordering):
+    LDPC_Generator("sparse"), N(0), M(0), K(0), row_ptr(), row_col(),
+    pivots(), gap_cols(), phi_inv()
 {
-  it_info_debug("LDPC_Code::load_code(): Loading LDPC codec from "
-                << filename);
+  ivec tmp;
+  tmp = construct(H, natural_ordering);
+}
 
-  it_ifile f(filename);
-  int ver;
-  f >> Name("Fileversion") >> ver;
-  it_assert(ver == LDPC_binary_file_version, "LDPC_Code::load_code(): "
-            "Unsupported file format");
-  f >> Name("H_defined") >> H_defined;
-  f >> Name("G_defined") >> G_defined;
-  f >> Name("nvar") >> nvar;
-  f >> Name("ncheck") >> ncheck;
-  f >> Name("C") >> C;
-  f >> Name("V") >> V;
-  f >> Name("sumX1") >> sumX1;
-  f >> Name("sumX2") >> sumX2;
-  f >> Name("iind") >> iind;
-  f >> Name("jind") >> jind;
-  f.close();
 
-  // load generator data
-  if (G_defined) {
-    it_assert(G_in != 0, "LDPC_Code::load_code(): Generator object is "
-              "missing. Can not load the generator data from a file.");
-    G = G_in;
-    G->load(filename);
+ivec LDPC_Generator_Sparse::construct(LDPC_Parity* const H,
+                                      bool natural_ordering)
+{
+  N = H->get_nvar();
+  M = H->get_ncheck();
+  K = N - M;
+
+  // -- Sparse row and column structure of H --
+  ivec c_ptr(M + 1);
+  c_ptr(0) = 0;
+  for (int i = 0; i < M; i++) {
+    c_ptr(i + 1) = c_ptr(i) + H->get_row(i).nnz();
   }
-  else {
-    G = 0;
-    it_info_debug("LDPC_Code::load_code(): Generator data not loaded. "
-                  "Generator object will not be used.");
+  ivec c_var(c_ptr(M));
+  ivec v_ptr(N + 1);
+  v_ptr.zeros();
+  for (int i = 0; i < M; i++) {
+    Sparse_Vec<bin> row = H->get_row(i);
+    for (int e = 0; e < row.nnz(); e++) {
+      c_var(c_ptr(i) + e) = row.get_nz_index(e);
+      v_ptr(row.get_nz_index(e) + 1)++;
+    }
+  }
+  for (int j = 0; j < N; j++) {
+    v_ptr(j + 1) += v_ptr(j);
+  }
+  ivec v_chk(c_ptr(M));
+  ivec v_fill = v_ptr.left(N);
+  for (int i = 0; i < M; i++) {
+    for (int e = c_ptr(i); e < c_ptr(i + 1); e++) {
+      v_chk(v_fill(c_var(e))++) = i;
+    }
   }
 
-  it_info_debug("LDPC_Code::load_code(): Successfully loaded LDPC codec "
-                "from " << filename);
+  ivec perm(N);
+  for (int j = 0; j < N; j++) {
+    perm(j) = j;
+  }
 
-  setup_decoder();
-}
+  // -- Triangulation with the information bits on the first K columns --
+  bvec known(N);
+  known.zeros();
+  for (int j = 0; j < K; j++) {
+    known(j) = 1;
+  }
+  ivec order, piv, gaps;
+  int t = ldpc_alt_triangulate(c_ptr, c_var, v_ptr, v_chk, known, order,
+                               piv, gaps);
+  GF2mat phi;
+  if (t < M) {
+    phi = ldpc_alt_gap_matrix(c_ptr, c_var, order, piv, gaps, N);
+  }
 
-void LDPC_Code::save_code(const std::string& filename) const
-{
-  it_assert(H_defined, "LDPC_Code::save_to_file(): There is no parity "
-            "check matrix");
-  it_info_debug("LDPC_Code::save_to_file(): Saving LDPC codec to "
-                << filename);
+  if ((t < M) && (phi.row_rank() < M - t)) {
+    it_assert(!natural_ordering, "LDPC_Generator_Sparse::construct(): "
+              "The last " << M << " columns of H are not invertible");
+    it_info_debug("LDPC_Generator_Sparse::construct(): Permuting the "
+                  "columns of H...");
+
+    // -- Triangulation with the information bits chosen freely --
+    known.zeros();
+    t = ldpc_alt_triangulate(c_ptr, c_var, v_ptr, v_chk, known, order, piv,
+                             gaps);
+    // the first M-t independent declared columns become gap variables
+    ivec info(K);
+    if (t < M) {
+      GF2mat T, U;
+      ivec P;
+      int rank = ldpc_alt_gap_matrix(c_ptr, c_var, order, piv, gaps,
+                                     N).T_fact(T, U, P);
+      it_assert(rank == M - t, "LDPC_Generator_Sparse::construct(): "
+                "The parity check matrix is not of full rank");
+      for (int j = 0; j < K; j++) {
+        info(j) = gaps(P(M - t + j));
+      }
+      ivec gaps_tmp = gaps;
+      gaps.set_size(M - t);
+      for (int j = 0; j < M - t; j++) {
+        gaps(j) = gaps_tmp(P(j));
+      }
+    }
+    else {
+      info = gaps;
+      gaps.set_size(0);
+    }
 
-  it_file f;
-  f.open(filename, true);
-  f << Name("Fileversion") << LDPC_binary_file_version;
-  f << Name("H_defined") << H_defined;
-  f << Name("G_defined") << G_defined;
-  f << Name("nvar") << nvar;
-  f << Name("ncheck") << ncheck;
-  f << Name("C") << C;
-  f << Name("V") << V;
-  f << Name("sumX1") << sumX1;
-  f << Name("sumX2") << sumX2;
-  f << Name("iind") << iind;
-  f << Name("jind") << jind;
-  f.close();
+    // -- Permute the columns of H: information bits first --
+    bvec is_info(N);
+    is_info.zeros();
+    for (int j = 0; j < K; j++) {
+      is_info(info(j)) = 1;
+    }
+    int next_info = 0;
+    int next_parity = K;
+    for (int j = 0; j < N; j++) {
+      perm(j) = (is_info(j) == bin(1)) ? next_info++ : next_parity++;
+    }
+    for (int e = 0; e < c_var.size(); e++) {
+      c_var(e) = perm(c_var(e));
+    }
+    for (int i = 0; i < t; i++) {
+      piv(i) = perm(piv(i));
+    }
+    for (int i = 0; i < gaps.size(); i++) {
+      gaps(i) = perm(gaps(i));
+    }
+    *H = LDPC_Parity(M, N);
+    for (int i = 0; i < M; i++) {
+      for (int e = c_ptr(i); e < c_ptr(i + 1); e++) {
+        H->set(i, c_var(e), 1);
+      }
+    }
+    if (t < M) {
+      phi = ldpc_alt_gap_matrix(c_ptr, c_var, order, piv, gaps, N);
+    }
+  }
 
-  // save generator data;
-  if (G_defined)
-    G->save(filename);
-  else
-    it_info_debug("LDPC_Code::save_code(): Missing generator object - "
-                  "generator data not saved");
+  // -- Store the checks in encoding order --
+  row_ptr.set_size(M + 1);
+  row_col.set_size(c_ptr(M));
+  row_ptr(0) = 0;
+  for (int i = 0; i < M; i++) {
+    int c = order(i);
+    int d = c_ptr(c + 1) - c_ptr(c);
+    row_col.set_subvector(row_ptr(i), c_var.mid(c_ptr(c), d));
+    row_ptr(i + 1) = row_ptr(i) + d;
+  }
+  pivots = piv;
+  gap_cols = gaps;
+  phi_inv = (t < M) ? phi.inverse() : GF2mat();
+  it_info_debug("LDPC_Generator_Sparse::construct(): Gap of the "
+                "triangular form: " << M - t);
 
-  it_info_debug("LDPC_Code::save_code(): Successfully saved LDPC codec to "
-                << filename);
+  init_flag = true;
+
+  return perm;
 }
 
 
-void LDPC_Code::set_decoding_method(const std::string& method_in)
+void LDPC_Generator_Sparse::back_substitute(bvec &output) const
 {
-  it_assert((method_in == "bp") || (method_in == "BP"),
-            "LDPC_Code::set_decoding_method(): Not implemented decoding method");
-  dec_method = method_in;
+  // each row of T is solved for its pivot; the current value of the
+  // pivot cancels out since it is part of the row sum
+  bin *out = output._data();
+  const int *ptr = row_ptr._data();
+  const int *col = row_col._data();
+  for (int i = 0; i < pivots.size(); i++) {
+    bin sum = 0;
+    for (int e = ptr[i]; e < ptr[i + 1]; e++) {
+      sum += out[col[e]];
+    }
+    out[pivots(i)] += sum;
+  }
 }
 
-void LDPC_Code::set_exit_conditions(int max_iters_in,
-                                    bool syndr_check_each_iter,
+
+void LDPC_Generator_Sparse::encode(const bvec &input, bvec &output)
+{
+  it_assert(init_flag, "LDPC_Generator_Sparse::encode(): Sparse generator "
+            "not set up");
+  it_assert(input.size() == K, "LDPC_Generator_Sparse::encode(): Improper "
+            "input vector size (" << input.size() << " != " << K << ")");
+
+  output.set_size(N);
+  output.zeros();
+  output.set_subvector(0, input);
+
+  // parity bits with the gap variables set to zero
+  back_substitute(output);
+
+  int t = pivots.size();
+  int g = gap_cols.size();
+  if (g > 0) {
+    // the syndrome of the last g checks determines the gap variables
+    bvec s(g);
+    for (int i = 0; i < g; i++) {
+      bin sum = 0;
+      for (int e = row_ptr(t + i); e < row_ptr(t + i + 1); e++) {
+        sum += output(row_col(e));
+      }
+      s(i) = sum;
+    }
+    bvec p = phi_inv * s;
+    for (int i = 0; i < g; i++) {
+      output(gap_cols(i)) = p(i);
+    }
+    back_substitute(output);
+  }
+}
+
+
+void LDPC_Generator_Sparse::save(const std::string& filename) const
+{
+  it_assert(init_flag, "LDPC_Generator_Sparse::save(): Can not save not "
+            "initialized generator");
+  it_file f(filename);
+  int ver;
+  f >> Name("Fileversion") >> ver;
+  it_assert(ver == LDPC_binary_file_version,
+            "LDPC_Generator_Sparse::save(): Unsupported file format");
+  f << Name("G_type") << type;
+  f << Name("G_nvar") << N;
+  f << Name("G_row_ptr") << row_ptr;
+  f << Name("G_row_col") << row_col;
+  f << Name("G_pivots") << pivots;
+  f << Name("G_gap_cols") << gap_cols;
+  if (gap_cols.size() > 0) {
+    f << Name("G_phi_inv") << phi_inv;
+  }
+  f.close();
+}
+
+
+void LDPC_Generator_Sparse::load(const std::string& filename)
+{
+  it_ifile f(filename);
+  int ver;
+  f >> Name("Fileversion") >> ver;
+  it_assert(ver == LDPC_binary_file_version,
+            "LDPC_Generator_Sparse::load(): Unsupported file format");
+  std::string gen_type;
+  f >> Name("G_type") >> gen_type;
+  it_assert(gen_type == type,
+            "LDPC_Generator_Sparse::load(): Wrong generator type");
+  f >> Name("G_nvar") >> N;
+  f >> Name("G_row_ptr") >> row_ptr;
+  f >> Name("G_row_col") >> row_col;
+  f >> Name("G_pivots") >> pivots;
+  f >> Name("G_gap_cols") >> gap_cols;
+  if (gap_cols.size() > 0) {
+    f >> Name("G_phi_inv") >> phi_inv;
+  }
+  else {
+    phi_inv = GF2mat();
+  }
+  f.close();
+
+  M = row_ptr.size() - 1;
+  K = N - M;
+
+  init_flag = true;
+}
+
+
+// ----------------------------------------------------------------------
+// 16-bit lane arithmetic used by the multi-frame LDPC decoder
+// ----------------------------------------------------------------------
+
+//! \cond
+
+//! Number of frames decoded in parallel by LDPC_Code::decode_batch()
+static const int LDPC_batch_lanes = 8;
+//! Number of fractional bits of the 16-bit LLRs used by decode_batch()
+static const int LDPC_batch_frac_bits = 3;
+
+#if defined(__SSE2__)
+
+typedef __m128i lanes16;
+
+static inline lanes16 lanes_load(const short *p)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+static inline void lanes_store(short *p, lanes16 a)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a);
+}
+static inline lanes16 lanes_set(short x) { return _mm_set1_epi16(x); }
+static inline lanes16 lanes_adds(lanes16 a, lanes16 b)
+{
+  return _mm_adds_epi16(a, b);
+}
+static inline lanes16 lanes_subs(lanes16 a, lanes16 b)
+{
+  return _mm_subs_epi16(a, b);
+}
+static inline lanes16 lanes_min(lanes16 a, lanes16 b)
+{
+  return _mm_min_epi16(a, b);
+}
+static inline lanes16 lanes_max(lanes16 a, lanes16 b)
+{
+  return _mm_max_epi16(a, b);
+}
+static inline lanes16 lanes_xor(lanes16 a, lanes16 b)
+{
+  return _mm_xor_si128(a, b);
+}
+static inline lanes16 lanes_or(lanes16 a, lanes16 b)
+{
+  return _mm_or_si128(a, b);
+}
+// all ones in the lanes where a == b
+static inline lanes16 lanes_cmpeq(lanes16 a, lanes16 b)
+{
+  return _mm_cmpeq_epi16(a, b);
+}
+// all ones in the lanes where a is negative
+static inline lanes16 lanes_sign(lanes16 a) { return _mm_srai_epi16(a, 15); }
+// b in the lanes where mask is set, a elsewhere
+static inline lanes16 lanes_select(lanes16 mask, lanes16 a, lanes16 b)
+{
+  return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+// (a * f) >> 16, for non-negative a
+static inline lanes16 lanes_scale(lanes16 a, unsigned short f)
+{
+  return _mm_mulhi_epu16(a, _mm_set1_epi16(static_cast<short>(f)));
+}
+// bit l is set if lane l is negative
+static inline int lanes_sign_bits(lanes16 a)
+{
+  int m = _mm_movemask_epi8(a);
+  int r = 0;
+  for (int l = 0; l < LDPC_batch_lanes; l++)
+    r |= ((m >> (2 * l + 1)) & 1) << l;
+  return r;
+}
+
+#else // standard C++
+
+struct lanes16 { short x[LDPC_batch_lanes]; };
+
+static inline short lanes_sat(int a)
+{
+  return static_cast<short>(a > 32767 ? 32767 : (a < -32768 ? -32768 : a));
+}
+static inline lanes16 lanes_load(const short *p)
+{
+  lanes16 r;
+  for (int l = 0; l < LDPC_batch_lanes; l++) r.x[l] = p[l];
+  return r;
+}
+static inline void lanes_store(short *p, lanes16 a)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) p[l] = a.x[l];
+}
+static inline lanes16 lanes_set(short x)
+{
+  lanes16 r;
+  for (int l = 0; l < LDPC_batch_lanes; l++) r.x[l] = x;
+  return r;
+}
+static inline lanes16 lanes_adds(lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] = lanes_sat(a.x[l] + b.x[l]);
+  return a;
+}
+static inline lanes16 lanes_subs(lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] = lanes_sat(a.x[l] - b.x[l]);
+  return a;
+}
+static inline lanes16 lanes_min(lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] = std::min(a.x[l], b.x[l]);
+  return a;
+}
+static inline lanes16 lanes_max(lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] = std::max(a.x[l], b.x[l]);
+  return a;
+}
+static inline lanes16 lanes_xor(lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] ^= b.x[l];
+  return a;
+}
+static inline lanes16 lanes_or(lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] |= b.x[l];
+  return a;
+}
+static inline lanes16 lanes_cmpeq(lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] = (a.x[l] == b.x[l] ? -1 : 0);
+  return a;
+}
+static inline lanes16 lanes_sign(lanes16 a)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++) a.x[l] = (a.x[l] < 0 ? -1 : 0);
+  return a;
+}
+static inline lanes16 lanes_select(lanes16 mask, lanes16 a, lanes16 b)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++)
+    a.x[l] = ((a.x[l] & ~mask.x[l]) | (b.x[l] & mask.x[l]));
+  return a;
+}
+static inline lanes16 lanes_scale(lanes16 a, unsigned short f)
+{
+  for (int l = 0; l < LDPC_batch_lanes; l++)
+    a.x[l] = static_cast<short>((static_cast<unsigned int>(a.x[l]) * f) >> 16);
+  return a;
+}
+static inline int lanes_sign_bits(lanes16 a)
+{
+  int r = 0;
+  for (int l = 0; l < LDPC_batch_lanes; l++)
+    r |= (a.x[l] < 0 ? 1 : 0) << l;
+  return r;
+}
+
+#endif // __SSE2__
+
+static inline lanes16 lanes_abs(lanes16 a)
+{
+  return lanes_max(a, lanes_subs(lanes_set(0), a));
+}
+// -a in the lanes where mask is set, a elsewhere
+static inline lanes16 lanes_negate(lanes16 mask, lanes16 a)
+{
+  return lanes_subs(lanes_xor(a, mask), mask);
+}
+// all ones in the lanes with a bit set in m
+static inline lanes16 lanes_from_bits(int m)
+{
+  short x[LDPC_batch_lanes];
+  for (int l = 0; l < LDPC_batch_lanes; l++)
+    x[l] = (((m >> l) & 1) ? -1 : 0);
+  return lanes_load(x);
+}
+
+//! \endcond
+
+
+// ----------------------------------------------------------------------
+// LDPC_Code
+// ----------------------------------------------------------------------
+
+LDPC_Code::LDPC_Code(): H_defined(false), G_defined(false), dec_method("BP"),
+    max_iters(50), psc(true), pisc(false),
+    llrcalc(LLR_calc_unit()), layered(false), ms_factor(0.75),
+    ms_offset(0.5), edge_ordered(false), rcm_ordered(false),
+    cn_update(CN_SPA), qc_Z(0) { }
+
+LDPC_Code::LDPC_Code(const LDPC_Parity* const H,
+                     LDPC_Generator* const G_in,
+                     bool perform_integrity_check):
+    H_defined(false), G_defined(false), dec_method("BP"), max_iters(50),
+    psc(true), pisc(false), llrcalc(LLR_calc_unit()), layered(false),
+    ms_factor(0.75), ms_offset(0.5), edge_ordered(false), rcm_ordered(false),
+    cn_update(CN_SPA), qc_Z(0)
+{
+    set_code(H, G_in, perform_integrity_check);
+}
+
+LDPC_Code::LDPC_Code(const std::string& filename,
+                     LDPC_Generator* const G_in):
+    H_defined(false), G_defined(false), dec_method("BP"), max_iters(50),
+    psc(true), pisc(false), llrcalc(LLR_calc_unit()), layered(false),
+    ms_factor(0.75), ms_offset(0.5), edge_ordered(false), rcm_ordered(false),
+    cn_update(CN_SPA), qc_Z(0)
+{
+  load_code(filename, G_in);
+}
+
+
+void LDPC_Code::set_code(const LDPC_Parity* const H,
+                         LDPC_Generator* const G_in,
+                         bool perform_integrity_check)
+{
+  decoder_parameterization(H);
+  setup_decoder();
+  G = G_in;
+  if (G != 0) {
+    G_defined = true;
+    if (perform_integrity_check) {
+      integrity_check();
+    } else {
+      it_info_debug("LDPC_Code::set_code(): integrity check was not performed");
+    }
+  }
+}
+
+void LDPC_Code::load_code(const std::string& filename,
+                          LDPC_Generator* const G_in)
+{
+  it_info_debug("LDPC_Code::load_code(): Loading LDPC codec from "
+                << filename);
+
+  it_ifile f(filename);
+  int ver;
+  f >> Name("Fileversion") >> ver;
+  it_assert(ver == LDPC_binary_file_version, "LDPC_Code::load_code(): "
+            "Unsupported file format");
+  f >> Name("H_defined") >> H_defined;
+  f >> Name("G_defined") >> G_defined;
+  f >> Name("nvar") >> nvar;
+  f >> Name("ncheck") >> ncheck;
+  f >> Name("C") >> C;
+  f >> Name("V") >> V;
+  f >> Name("sumX1") >> sumX1;
+  f >> Name("sumX2") >> sumX2;
+  f >> Name("iind") >> iind;
+  f >> Name("jind") >> jind;
+  // the quasi-cyclic structure is optional
+  if (f.seek("qc_Z")) {
+    f >> qc_Z;
+    f >> Name("qc_ptr") >> qc_ptr;
+    f >> Name("qc_col") >> qc_col;
+    f >> Name("qc_shift") >> qc_shift;
+  }
+  else {
+    qc_Z = 0;
+  }
+  // the message layout is optional as well (see set_edge_ordering())
+  if (f.seek("edge_ordered")) {
+    f >> edge_ordered;
+    f >> Name("rcm_ordered") >> rcm_ordered;
+  }
+  f.close();
+
+  // load generator data
+  if (G_defined) {
+    it_assert(G_in != 0, "LDPC_Code::load_code(): Generator object is "
+              "missing. Can not load the generator data from a file.");
+    G = G_in;
+    G->load(filename);
+  }
+  else {
+    G = 0;
+    it_info_debug("LDPC_Code::load_code(): Generator data not loaded. "
+                  "Generator object will not be used.");
+  }
+
+  it_info_debug("LDPC_Code::load_code(): Successfully loaded LDPC codec "
+                "from " << filename);
+
+  setup_decoder();
+}
+
+void LDPC_Code::save_code(const std::string& filename) const
+{
+  it_assert(H_defined, "LDPC_Code::save_to_file(): There is no parity "
+            "check matrix");
+  it_info_debug("LDPC_Code::save_to_file(): Saving LDPC codec to "
+                << filename);
+
+  it_file f;
+  f.open(filename, true);
+  f << Name("Fileversion") << LDPC_binary_file_version;
+  f << Name("H_defined") << H_defined;
+  f << Name("G_defined") << G_defined;
+  f << Name("nvar") << nvar;
+  f << Name("ncheck") << ncheck;
+  f << Name("C") << C;
+  f << Name("V") << V;
+  f << Name("sumX1") << sumX1;
+  f << Name("sumX2") << sumX2;
+  f << Name("iind") << iind;
+  f << Name("jind") << jind;
+  if (qc_Z > 0) {
+    f << Name("qc_Z") << qc_Z;
+    f << Name("qc_ptr") << qc_ptr;
+    f << Name("qc_col") << qc_col;
+    f << Name("qc_shift") << qc_shift;
+  }
+  f << Name("edge_ordered") << edge_ordered;
+  f << Name("rcm_ordered") << rcm_ordered;
+  f.close();
+
+  // save generator data;
+  if (G_defined)
+    G->save(filename);
+  else
+    it_info_debug("LDPC_Code::save_code(): Missing generator object - "
+                  "generator data not saved");
+
+  it_info_debug("LDPC_Code::save_code(): Successfully saved LDPC codec to "
+                << filename);
+}
+
+
+void LDPC_Code::set_decoding_method(const std::string& method_in)
+{
+  if ((method_in == "bp") || (method_in == "BP")) {
+    layered = false;
+    cn_update = CN_SPA;
+  }
+  else if ((method_in == "nms") || (method_in == "NMS")) {
+    layered = false;
+    cn_update = CN_NMS;
+  }
+  else if ((method_in == "oms") || (method_in == "OMS")) {
+    layered = false;
+    cn_update = CN_OMS;
+  }
+  else if ((method_in == "lbp") || (method_in == "LBP")) {
+    layered = true;
+    cn_update = CN_SPA;
+  }
+  else if ((method_in == "lnms") || (method_in == "LNMS")) {
+    layered = true;
+    cn_update = CN_NMS;
+  }
+  else if ((method_in == "loms") || (method_in == "LOMS")) {
+    layered = true;
+    cn_update = CN_OMS;
+  }
+  else {
+    it_error("LDPC_Code::set_decoding_method(): Not implemented decoding "
+             "method");
+  }
+  dec_method = method_in;
+}
+
+void LDPC_Code::set_min_sum_params(double norm_factor, double offset)
+{
+  it_assert((norm_factor > 0.0) && (norm_factor <= 1.0),
+            "LDPC_Code::set_min_sum_params(): Normalization factor must be "
+            "in the range (0, 1]");
+  it_assert(offset >= 0.0, "LDPC_Code::set_min_sum_params(): Offset can "
+            "not be negative");
+  ms_factor = norm_factor;
+  ms_offset = offset;
+}
+
+void LDPC_Code::set_edge_ordering(bool ordered, bool rcm)
+{
+  edge_ordered = ordered;
+  rcm_ordered = rcm;
+  setup_decoder();
+}
+
+void LDPC_Code::set_exit_conditions(int max_iters_in,
+                                    bool syndr_check_each_iter,
                                     bool syndr_check_at_start)
 {
-  it_assert(max_iters >= 0, "LDPC_Code::set_nrof_iterations(): Maximum "
-            "number of iterations can not be negative");
-  max_iters = max_iters_in;
-  psc = syndr_check_each_iter;
-  pisc = syndr_check_at_start;
+  it_assert(max_iters >= 0, "LDPC_Code::set_nrof_iterations(): Maximum "
+            "number of iterations can not be negative");
+  max_iters = max_iters_in;
+  psc = syndr_check_each_iter;
+  pisc = syndr_check_at_start;
+}
+
+void LDPC_Code::set_llrcalc(const LLR_calc_unit& llrcalc_in)
+{
+  llrcalc = llrcalc_in;
+}
+
+
+void LDPC_Code::encode(const bvec &input, bvec &output)
+{
+  it_assert(G_defined, "LDPC_Code::encode(): LDPC Generator is required "
+            "for encoding");
+  G->encode(input, output);
+  it_assert_debug(syndrome_check(output), "LDPC_Code::encode(): Syndrome "
+                  "check failed");
+}
+
+bvec LDPC_Code::encode(const bvec &input)
+{
+  bvec result;
+  encode(input, result);
+  return result;
+}
+
+void LDPC_Code::decode(const vec &llr_in, bvec &syst_bits)
+{
+  QLLRvec qllrin = llrcalc.to_qllr(llr_in);
+  QLLRvec qllrout;
+  bp_decode(qllrin, qllrout);
+  syst_bits = (qllrout.left(nvar - ncheck) < 0);
+}
+
+bvec LDPC_Code::decode(const vec &llr_in)
+{
+  bvec syst_bits;
+  decode(llr_in, syst_bits);
+  return syst_bits;
+}
+
+void LDPC_Code::decode_soft_out(const vec &llr_in, vec &llr_out)
+{
+  QLLRvec qllrin = llrcalc.to_qllr(llr_in);
+  QLLRvec qllrout;
+  bp_decode(qllrin, qllrout);
+  llr_out = llrcalc.to_double(qllrout);
+}
+
+vec LDPC_Code::decode_soft_out(const vec &llr_in)
+{
+  vec llr_out;
+  decode_soft_out(llr_in, llr_out);
+  return llr_out;
+}
+
+int LDPC_Code::bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout)
+{
+  // Note the IT++ convention that a sure zero corresponds to
+  // LLR=+infinity
+  it_assert(H_defined, "LDPC_Code::bp_decode(): Parity check matrix not "
+            "defined");
+  it_assert((LLRin.size() == nvar) && (sumX1.size() == nvar)
+            && (sumX2.size() == ncheck), "LDPC_Code::bp_decode(): Wrong "
+            "input dimensions");
+
+  if (pisc && syndrome_check(LLRin)) {
+    LLRout = LLRin;
+    return 0;
+  }
+
+  if (qc_Z > 0) {
+    return qc_bp_decode(LLRin, LLRout);
+  }
+
+  if (e_ptr.size() > 0) {
+    return edge_bp_decode(LLRin, LLRout);
+  }
+
+  if (layered) {
+    return layered_bp_decode(LLRin, LLRout);
+  }
+
+  LLRout.set_size(LLRin.size());
+
+  // allocate temporary variables used for the check node update
+  ivec jj(max_cnd);
+  QLLRvec m(max_cnd);
+  QLLRvec out(max_cnd);
+  QLLRvec ml(max_cnd);
+  QLLRvec mr(max_cnd);
+  QLLR offset = llrcalc.to_qllr(ms_offset);
+
+  // initial step
+  for (int i = 0; i < nvar; i++) {
+    int index = i;
+    for (int j = 0; j < sumX1(i); j++) {
+      mvc[index] = LLRin(i);
+      index += nvar;
+    }
+  }
+
+  bool is_valid_codeword = false;
+  int iter = 0;
+  do {
+    iter++;
+    if (nvar >= 100000) { it_info_no_endl_debug("."); }
+    // --------- Step 1: check to variable nodes ----------
+    // (the same check node updates as for the other message layouts)
+    for (int j = 0; j < ncheck; j++) {
+      int nodes = sumX2(j);
+      it_error_if((nodes < 2) || (nodes > max_cnd), "LDPC_Code::bp_decode(): "
+                  "Unsupported check node degree " << nodes);
+      jj[0] = j;
+      m[0] = mvc[jind[j]];
+      for (int i = 1; i < nodes; i++) {
+        jj[i] = jj[i-1] + ncheck;
+        m[i] = mvc[jind[jj[i]]];
+      }
+      if (cn_update == CN_SPA)
+        spa_check_update(nodes, m, out, ml, mr);
+      else
+        min_sum_check_update(nodes, m, out, offset);
+      for (int i = 0; i < nodes; i++) {
+        mcv[jj[i]] = out[i];
+      }
+    }
+    
+    // step 2: variable to check nodes
+    for (int i = 0; i < nvar; i++) {
+      switch (sumX1(i)) {
+      case 0:
+        it_error("LDPC_Code::bp_decode(): sumX1(i)=0");
+      case 1: {
+        /* This case is rare but apparently occurs for codes used in
+	   the DVB-T2 standard.
+	 */
+	QLLR m0 = mcv[iind[i]];
+        mvc[i] = LLRin(i);
+        LLRout(i) = LLRin(i) + m0;
+        break;
+      }
+      case 2: {
+        QLLR m0 = mcv[iind[i]];
+        int i1 = i + nvar;
+        QLLR m1 = mcv[iind[i1]];
+        mvc[i] = LLRin(i) + m1;
+        mvc[i1] = LLRin(i) + m0;
+        LLRout(i) = mvc[i1] + m1;
+        break;
+      }
+      case 3: {
+        int i0 = i;
+        QLLR m0 = mcv[iind[i0]];
+        int i1 = i0 + nvar;
+        QLLR m1 = mcv[iind[i1]];
+        int i2 = i1 + nvar;
+        QLLR m2 = mcv[iind[i2]];
+        LLRout(i) = LLRin(i) + m0 + m1 + m2;
+        mvc[i0] = LLRout(i) - m0;
+        mvc[i1] = LLRout(i) - m1;
+        mvc[i2] = LLRout(i) - m2;
+        break;
+      }
+      case 4: {
+        int i0 = i;
+        QLLR m0 = mcv[iind[i0]];
+        int i1 = i0 + nvar;
+        QLLR m1 = mcv[iind[i1]];
+        int i2 = i1 + nvar;
+        QLLR m2 = mcv[iind[i2]];
+        int i3 = i2 + nvar;
+        QLLR m3 = mcv[iind[i3]];
+        LLRout(i) = LLRin(i) + m0 + m1 + m2 + m3;
+        mvc[i0] = LLRout(i) - m0;
+        mvc[i1] = LLRout(i) - m1;
+        mvc[i2] = LLRout(i) - m2;
+        mvc[i3] = LLRout(i) - m3;
+        break;
+      }
+      default:   { // differential update
+        QLLR mvc_temp = LLRin(i);
+        int index_iind = i; // tracks i+jp*nvar
+        for (int jp = 0; jp < sumX1(i); jp++) {
+          mvc_temp +=  mcv[iind[index_iind]];
+          index_iind += nvar;
+        }
+        LLRout(i) = mvc_temp;
+        index_iind = i;  // tracks i+j*nvar
+        for (int j = 0; j < sumX1[i]; j++) {
+          mvc[index_iind] = mvc_temp - mcv[iind[index_iind]];
+          index_iind += nvar;
+        }
+      }
+      }
+    }
+
+    if (psc && syndrome_check(LLRout)) {
+      is_valid_codeword = true;
+      break;
+    }
+  }
+  while (iter < max_iters);
+
+  if (nvar >= 100000) { it_info_debug(""); }
+  return (is_valid_codeword ? iter : -iter);
+}
+
+int LDPC_Code::layered_bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout)
+{
+  // allocate temporary variables used for the check node update
+  QLLRvec m(max_cnd);
+  QLLRvec out(max_cnd);
+  QLLRvec ml(max_cnd);
+  QLLRvec mr(max_cnd);
+  QLLR offset = llrcalc.to_qllr(ms_offset);
+
+  // The a posteriori LLRs are kept in LLRout and refreshed after each
+  // check node update. Only the check to variable messages need to be
+  // stored between the iterations.
+  LLRout = LLRin;
+  mcv.zeros();
+
+  bool is_valid_codeword = false;
+  int iter = 0;
+  do {
+    iter++;
+    if (nvar >= 100000) { it_info_no_endl_debug("."); }
+    for (int j = 0; j < ncheck; j++) {
+      int nodes = sumX2(j);
+      it_error_if((nodes < 2) || (nodes > max_cnd), "LDPC_Code::bp_decode(): "
+                  "Unsupported check node degree " << nodes);
+
+      // variable to check messages: remove the previous contribution of
+      // this check node from the a posteriori LLRs
+      int index = j; // tracks j+i*ncheck
+      for (int i = 0; i < nodes; i++) {
+        m[i] = LLRout(V(index)) - mcv[index];
+        index += ncheck;
+      }
+
+      if (cn_update == CN_SPA)
+        spa_check_update(nodes, m, out, ml, mr);
+      else
+        min_sum_check_update(nodes, m, out, offset);
+
+      index = j;
+      for (int i = 0; i < nodes; i++) {
+        mcv[index] = out[i];
+        LLRout(V(index)) = m[i] + out[i];
+        index += ncheck;
+      }
+    }
+
+    if (psc && syndrome_check(LLRout)) {
+      is_valid_codeword = true;
+      break;
+    }
+  }
+  while (iter < max_iters);
+
+  if (nvar >= 100000) { it_info_debug(""); }
+  return (is_valid_codeword ? iter : -iter);
 }
 
-void LDPC_Code::set_llrcalc(const LLR_calc_unit& llrcalc_in)
+int LDPC_Code::edge_bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout)
 {
-  llrcalc = llrcalc_in;
+  // allocate temporary variables used for the check node update
+  QLLRvec m(max_cnd);
+  QLLRvec out(max_cnd);
+  QLLRvec ml(max_cnd);
+  QLLRvec mr(max_cnd);
+  QLLR offset = llrcalc.to_qllr(ms_offset);
+
+  // The messages are stored in mcv in edge order. With the flooding
+  // schedule, the check to variable messages are replaced in place by
+  // the variable to check messages during the variable node update.
+  const int *p_ptr = e_ptr._data();
+  const int *p_var = e_var._data();
+  QLLR *p_msg = mcv._data();
+  if (layered) {
+    LLRout = LLRin;
+    mcv.zeros();
+  }
+  else {
+    LLRout.set_size(nvar);
+    for (int e = 0; e < e_var.size(); e++) {
+      p_msg[e] = LLRin(p_var[e]);
+    }
+  }
+
+  bool is_valid_codeword = false;
+  int iter = 0;
+  do {
+    iter++;
+    if (nvar >= 100000) { it_info_no_endl_debug("."); }
+    for (int k = 0; k < ncheck; k++) {
+      int nodes = p_ptr[k+1] - p_ptr[k];
+      it_error_if((nodes < 2) || (nodes > max_cnd), "LDPC_Code::bp_decode(): "
+                  "Unsupported check node degree " << nodes);
+      const int *var = p_var + p_ptr[k];
+      QLLR *msg = p_msg + p_ptr[k];
+
+      if (layered) {
+        for (int i = 0; i < nodes; i++) {
+          m[i] = LLRout(var[i]) - msg[i];
+        }
+      }
+      else {
+        for (int i = 0; i < nodes; i++) {
+          m[i] = msg[i];
+        }
+      }
+
+      if (cn_update == CN_SPA)
+        spa_check_update(nodes, m, out, ml, mr);
+      else
+        min_sum_check_update(nodes, m, out, offset);
+
+      for (int i = 0; i < nodes; i++) {
+        msg[i] = out[i];
+      }
+      if (layered) {
+        for (int i = 0; i < nodes; i++) {
+          LLRout(var[i]) = m[i] + out[i];
+        }
+      }
+    }
+
+    if (!layered) {
+      for (int k = 0; k < nvar; k++) {
+        const int *edge = v_edge._data() + v_ptr(k);
+        int nodes = v_ptr(k + 1) - v_ptr(k);
+        QLLR sum = LLRin(v_order(k));
+        for (int i = 0; i < nodes; i++) {
+          sum += p_msg[edge[i]];
+        }
+        LLRout(v_order(k)) = sum;
+        for (int i = 0; i < nodes; i++) {
+          p_msg[edge[i]] = sum - p_msg[edge[i]];
+        }
+      }
+    }
+
+    if (psc && syndrome_check(LLRout)) {
+      is_valid_codeword = true;
+      break;
+    }
+  }
+  while (iter < max_iters);
+
+  if (nvar >= 100000) { it_info_debug(""); }
+  return (is_valid_codeword ? iter : -iter);
+}
+
+void LDPC_Code::spa_check_update(int d, const QLLRvec &m, QLLRvec &out,
+                                 QLLRvec &ml, QLLRvec &mr) const
+{
+  if (d == 2) {
+    out[0] = m[1];
+    out[1] = m[0];
+    return;
+  }
+
+  // compute partial sums from the left and from the right
+  int nodes = d - 1;
+  ml[0] = m[0];
+  mr[0] = m[nodes];
+  for (int i = 1; i < nodes; i++) {
+    ml[i] = llrcalc.Boxplus(ml[i-1], m[i]);
+    mr[i] = llrcalc.Boxplus(mr[i-1], m[nodes-i]);
+  }
+
+  // merge partial sums
+  out[0] = mr[nodes-1];
+  out[nodes] = ml[nodes-1];
+  for (int i = 1; i < nodes; i++)
+    out[i] = llrcalc.Boxplus(ml[i-1], mr[nodes-1-i]);
+}
+
+void LDPC_Code::min_sum_check_update(int d, const QLLRvec &m, QLLRvec &out,
+                                     QLLR offset) const
+{
+  // find the two smallest magnitudes and the parity of the signs
+  QLLR min1 = QLLR_MAX;
+  QLLR min2 = QLLR_MAX;
+  int min_pos = 0;
+  int sign = 0;
+  for (int i = 0; i < d; i++) {
+    QLLR a = m[i];
+    if (a < 0) {
+      sign ^= 1;
+      a = -a;
+    }
+    if (a < min1) {
+      min2 = min1;
+      min1 = a;
+      min_pos = i;
+    }
+    else if (a < min2) {
+      min2 = a;
+    }
+  }
+
+  // apply the correction to the magnitudes
+  if (cn_update == CN_NMS) {
+    min1 = static_cast<QLLR>(ms_factor * min1);
+    min2 = static_cast<QLLR>(ms_factor * min2);
+  }
+  else {
+    min1 = (min1 > offset ? min1 - offset : 0);
+    min2 = (min2 > offset ? min2 - offset : 0);
+  }
+
+  // the extrinsic sign is the overall parity times the own sign
+  for (int i = 0; i < d; i++) {
+    QLLR mag = (i == min_pos ? min2 : min1);
+    out[i] = ((sign ^ (m[i] < 0)) ? -mag : mag);
+  }
 }
 
+int LDPC_Code::qc_bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout)
+{
+  const int Z = qc_Z;
+  int nrows = qc_ptr.size() - 1;
+  int dmax = 0;
+  for (int r = 0; r < nrows; r++) {
+    dmax = std::max(dmax, qc_ptr(r + 1) - qc_ptr(r));
+  }
+  it_error_if(dmax > max_cnd, "LDPC_Code::bp_decode(): check node degrees >"
+              << max_cnd << " not supported in this version");
+
+  // Temporary variables used for the check node update. The k-th
+  // message of row i of the current block row is stored at k*Z+i.
+  QLLRvec m(dmax * Z);
+  QLLRvec out(dmax * Z);
+  QLLRvec ml(dmax * Z);
+  QLLRvec mr(dmax * Z);
+  QLLRvec min1(Z), min2(Z);
+  ivec min_pos(Z), sign(Z);
+  QLLR offset = llrcalc.to_qllr(ms_offset);
+
+  // The check to variable messages of block b are stored in mcv, at
+  // b*Z+i for row i of the block. The a posteriori LLRs are updated in
+  // place (layered schedule) or accumulated in acc (flooding schedule).
+  LLRout = LLRin;
+  QLLRvec acc;
+  mcv.zeros();
+  QLLR *p_app = LLRout._data();
+  QLLR *p_msg = mcv._data();
+  QLLR *p_m = m._data();
+  QLLR *p_out = out._data();
+  QLLR *p_ml = ml._data();
+  QLLR *p_mr = mr._data();
+
+  bool is_valid_codeword = false;
+  int iter = 0;
+  do {
+    iter++;
+    if (nvar >= 100000) { it_info_no_endl_debug("."); }
+    if (!layered) {
+      acc = LLRin;
+    }
+    QLLR *p_upd = (layered ? p_app : acc._data());
+
+    for (int r = 0; r < nrows; r++) {
+      int b0 = qc_ptr(r);
+      int d = qc_ptr(r + 1) - b0;
+      it_error_if(d < 2, "LDPC_Code::bp_decode(): Unsupported check node "
+                  "degree " << d);
+
+      // variable to check messages; row i of block b is connected to
+      // variable node qc_col(b)*Z + (i+qc_shift(b)) mod Z
+      for (int k = 0; k < d; k++) {
+        int s = qc_shift(b0 + k);
+        const QLLR *a = p_app + qc_col(b0 + k) * Z;
+        const QLLR *c = p_msg + (b0 + k) * Z;
+        QLLR *mk = p_m + k * Z;
+        for (int i = 0; i < Z - s; i++)
+          mk[i] = a[i + s] - c[i];
+        for (int i = Z - s; i < Z; i++)
+          mk[i] = a[i + s - Z] - c[i];
+      }
+
+      // check node update, for all the Z rows at once
+      if (d == 2) {
+        for (int i = 0; i < Z; i++) {
+          p_out[i] = p_m[Z + i];
+          p_out[Z + i] = p_m[i];
+        }
+      }
+      else if (cn_update == CN_SPA) {
+        int nodes = d - 1;
+        for (int i = 0; i < Z; i++) {
+          ml[i] = m[i];
+          mr[i] = m[nodes * Z + i];
+        }
+        for (int k = 1; k < nodes; k++) {
+          llrcalc.Boxplus(p_ml + (k - 1) * Z, p_m + k * Z, p_ml + k * Z, Z);
+          llrcalc.Boxplus(p_mr + (k - 1) * Z, p_m + (nodes - k) * Z,
+                          p_mr + k * Z, Z);
+        }
+        for (int i = 0; i < Z; i++) {
+          out[i] = mr[(nodes - 1) * Z + i];
+          out[nodes * Z + i] = ml[(nodes - 1) * Z + i];
+        }
+        for (int k = 1; k < nodes; k++) {
+          llrcalc.Boxplus(p_ml + (k - 1) * Z, p_mr + (nodes - 1 - k) * Z,
+                          p_out + k * Z, Z);
+        }
+      }
+      else {
+        for (int i = 0; i < Z; i++) {
+          min1[i] = QLLR_MAX;
+          min2[i] = QLLR_MAX;
+          min_pos[i] = 0;
+          sign[i] = 0;
+        }
+        for (int k = 0; k < d; k++) {
+          LLR_calc_unit::min_sum_update(p_m + k * Z, k, min1._data(),
+                                        min2._data(), min_pos._data(),
+                                        sign._data(), Z);
+        }
+        for (int i = 0; i < Z; i++) {
+          if (cn_update == CN_NMS) {
+            min1[i] = static_cast<QLLR>(ms_factor * min1[i]);
+            min2[i] = static_cast<QLLR>(ms_factor * min2[i]);
+          }
+          else {
+            min1[i] = (min1[i] > offset ? min1[i] - offset : 0);
+            min2[i] = (min2[i] > offset ? min2[i] - offset : 0);
+          }
+        }
+        for (int k = 0; k < d; k++) {
+          const QLLR *mk = p_m + k * Z;
+          QLLR *ok = p_out + k * Z;
+          for (int i = 0; i < Z; i++) {
+            QLLR mag = (min_pos[i] == k ? min2[i] : min1[i]);
+            ok[i] = ((sign[i] ^ (mk[i] < 0)) ? -mag : mag);
+          }
+        }
+      }
+
+      // store the check to variable messages and update the a
+      // posteriori LLRs
+      for (int k = 0; k < d; k++) {
+        int s = qc_shift(b0 + k);
+        QLLR *u = p_upd + qc_col(b0 + k) * Z;
+        QLLR *c = p_msg + (b0 + k) * Z;
+        const QLLR *mk = p_m + k * Z;
+        const QLLR *ok = p_out + k * Z;
+        for (int i = 0; i < Z; i++)
+          c[i] = ok[i];
+        if (layered) {
+          for (int i = 0; i < Z - s; i++)
+            u[i + s] = mk[i] + ok[i];
+          for (int i = Z - s; i < Z; i++)
+            u[i + s - Z] = mk[i] + ok[i];
+        }
+        else {
+          for (int i = 0; i < Z - s; i++)
+            u[i + s] += ok[i];
+          for (int i = Z - s; i < Z; i++)
+            u[i + s - Z] += ok[i];
+        }
+      }
+    }
+
+    if (!layered) {
+      LLRout = acc;
+      p_app = LLRout._data();
+    }
+
+    if (psc && qc_syndrome_check(LLRout)) {
+      is_valid_codeword = true;
+      break;
+    }
+  }
+  while (iter < max_iters);
 
-void LDPC_Code::encode(const bvec &input, bvec &output)
-{
-  it_assert(G_defined, "LDPC_Code::encode(): LDPC Generator is required "
-            "for encoding");
-  G->encode(input, output);
-  it_assert_debug(syndrome_check(output), "LDPC_Code::encode(): Syndrome "
-                  "check failed");
+  if (nvar >= 100000) { it_info_debug(""); }
+  return (is_valid_codeword ? iter : -iter);
 }
 
-bvec LDPC_Code::encode(const bvec &input)
+bool LDPC_Code::qc_syndrome_check(const QLLRvec &LLR) const
 {
-  bvec result;
-  encode(input, result);
-  return result;
+  const int Z = qc_Z;
+  const QLLR *p_llr = LLR._data();
+  ivec synd(Z);
+  for (int r = 0; r < qc_ptr.size() - 1; r++) {
+    synd.zeros();
+    for (int b = qc_ptr(r); b < qc_ptr(r + 1); b++) {
+      int s = qc_shift(b);
+      const QLLR *a = p_llr + qc_col(b) * Z;
+      for (int i = 0; i < Z - s; i++)
+        synd[i] ^= (a[i + s] < 0);
+      for (int i = Z - s; i < Z; i++)
+        synd[i] ^= (a[i + s - Z] < 0);
+    }
+    for (int i = 0; i < Z; i++) {
+      if (synd[i] == 1) {
+        return false;  // codeword is invalid
+      }
+    }
+  }
+  return true;   // codeword is valid
 }
 
-void LDPC_Code::decode(const vec &llr_in, bvec &syst_bits)
+void LDPC_Code::decode_batch(const mat &llr_in, bmat &syst_bits,
+                             ivec &nrof_iters)
 {
-  QLLRvec qllrin = llrcalc.to_qllr(llr_in);
-  QLLRvec qllrout;
-  bp_decode(qllrin, qllrout);
-  syst_bits = (qllrout.left(nvar - ncheck) < 0);
-}
+  it_assert(H_defined, "LDPC_Code::decode_batch(): Parity check matrix not "
+            "defined");
+  it_assert(llr_in.rows() == nvar, "LDPC_Code::decode_batch(): Wrong "
+            "input dimensions");
 
-bvec LDPC_Code::decode(const vec &llr_in)
-{
-  bvec syst_bits;
-  decode(llr_in, syst_bits);
-  return syst_bits;
-}
+  const int L = LDPC_batch_lanes;
+  const double scale = 1 << LDPC_batch_frac_bits;
+  int nframes = llr_in.cols();
+  int ninfo = nvar - ncheck;
+  syst_bits.set_size(ninfo, nframes);
+  nrof_iters.set_size(nframes);
+
+  svec llr(nvar * L);
+  svec app;
+  ivec lane_iters;
+  for (int f0 = 0; f0 < nframes; f0 += L) {
+    int nlanes = std::min(L, nframes - f0);
+    // interleave the frames, unused lanes are padded with zeros
+    llr.zeros();
+    for (int l = 0; l < nlanes; l++) {
+      for (int i = 0; i < nvar; i++) {
+        double x = std::floor(0.5 + scale * llr_in(i, f0 + l));
+        llr(i * L + l) = static_cast<short>(x > 32767.0 ? 32767.0
+                                            : (x < -32767.0 ? -32767.0 : x));
+      }
+    }
 
-void LDPC_Code::decode_soft_out(const vec &llr_in, vec &llr_out)
-{
-  QLLRvec qllrin = llrcalc.to_qllr(llr_in);
-  QLLRvec qllrout;
-  bp_decode(qllrin, qllrout);
-  llr_out = llrcalc.to_double(qllrout);
+    decode_lanes(llr, app, (1 << nlanes) - 1, lane_iters);
+
+    for (int l = 0; l < nlanes; l++) {
+      for (int i = 0; i < ninfo; i++) {
+        syst_bits(i, f0 + l) = (app(i * L + l) < 0);
+      }
+      nrof_iters(f0 + l) = lane_iters(l);
+    }
+  }
 }
 
-vec LDPC_Code::decode_soft_out(const vec &llr_in)
+void LDPC_Code::decode_batch(const mat &llr_in, bmat &syst_bits)
 {
-  vec llr_out;
-  decode_soft_out(llr_in, llr_out);
-  return llr_out;
+  ivec nrof_iters;
+  decode_batch(llr_in, syst_bits, nrof_iters);
 }
 
-int LDPC_Code::bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout)
+void LDPC_Code::decode_lanes(const svec &llr, svec &app, int active_mask,
+                             ivec &nrof_iters)
 {
-  // Note the IT++ convention that a sure zero corresponds to
-  // LLR=+infinity
-  it_assert(H_defined, "LDPC_Code::bp_decode(): Parity check matrix not "
-            "defined");
-  it_assert((LLRin.size() == nvar) && (sumX1.size() == nvar)
-            && (sumX2.size() == ncheck), "LDPC_Code::bp_decode(): Wrong "
-            "input dimensions");
-
-  if (pisc && syndrome_check(LLRin)) {
-    LLRout = LLRin;
-    return 0;
+  const int L = LDPC_batch_lanes;
+  const lanes16 zero = lanes_set(0);
+  const lanes16 max_mag = lanes_set(32767);
+
+  // min-sum correction terms in the 16-bit representation
+  bool use_offset = (cn_update == CN_OMS);
+  double off = std::floor(0.5 + ms_offset * (1 << LDPC_batch_frac_bits));
+  const lanes16 offset = lanes_set(static_cast<short>(off > 32767.0 ? 32767.0
+                                                      : off));
+  unsigned short factor = static_cast<unsigned short>(
+                            std::min(65535.0, std::floor(0.5 + ms_factor * 65536)));
+
+  // check to variable messages, stored in the check node order
+  svec msg(max(sumX2) * ncheck * L);
+  msg.zeros();
+  // a posteriori LLRs of the next iteration (flooding schedule only)
+  svec acc;
+  // variable to check messages of the current check node
+  svec m(max_cnd * L);
+
+  short *p_msg = msg._data();
+  short *p_m = m._data();
+  app = llr;
+  short *p_app = app._data();
+  if (!layered) {
+    acc.set_size(nvar * L);
   }
+  short *p_acc = acc._data();
 
-  LLRout.set_size(LLRin.size());
+  nrof_iters.set_size(L);
+  nrof_iters.zeros();
 
-  // allocate temporary variables used for the check node update
-  ivec jj(max_cnd);
-  QLLRvec m(max_cnd);
-  QLLRvec ml(max_cnd);
-  QLLRvec mr(max_cnd);
-  
-  // initial step
-  for (int i = 0; i < nvar; i++) {
-    int index = i;
-    for (int j = 0; j < sumX1(i); j++) {
-      mvc[index] = LLRin(i);
-      index += nvar;
-    }
+  // lanes of the converged (or unused) frames are frozen
+  int active = active_mask;
+  if (pisc) {
+    active &= ~lanes_syndrome_check(app);
   }
+  lanes16 frozen = lanes_from_bits(~active);
 
-  bool is_valid_codeword = false;
   int iter = 0;
-  do {
+  while (active != 0) {
     iter++;
-    if (nvar >= 100000) { it_info_no_endl_debug("."); }
-    // --------- Step 1: check to variable nodes ----------
+    if (!layered) {
+      acc = llr;
+    }
+
     for (int j = 0; j < ncheck; j++) {
-      // The check node update calculations are hardcoded for degrees
-      // up to 6.  For larger degrees, a general algorithm is used.
-      switch (sumX2(j)) {
-      case 0:
-        it_error("LDPC_Code::bp_decode(): sumX2(j)=0");
-      case 1:
-        it_error("LDPC_Code::bp_decode(): sumX2(j)=1");
-      case 2: {
-        mcv[j+ncheck] = mvc[jind[j]];
-        mcv[j] = mvc[jind[j+ncheck]];
-        break;
-      }
-      case 3: {
-        int j0 = j;
-        QLLR m0 = mvc[jind[j0]];
-        int j1 = j0 + ncheck;
-        QLLR m1 = mvc[jind[j1]];
-        int j2 = j1 + ncheck;
-        QLLR m2 = mvc[jind[j2]];
-        mcv[j0] = llrcalc.Boxplus(m1, m2);
-        mcv[j1] = llrcalc.Boxplus(m0, m2);
-        mcv[j2] = llrcalc.Boxplus(m0, m1);
-        break;
-      }
-      case 4: {
-        int j0 = j;
-        QLLR m0 = mvc[jind[j0]];
-        int j1 = j0 + ncheck;
-        QLLR m1 = mvc[jind[j1]];
-        int j2 = j1 + ncheck;
-        QLLR m2 = mvc[jind[j2]];
-        int j3 = j2 + ncheck;
-        QLLR m3 = mvc[jind[j3]];
-        QLLR m01 = llrcalc.Boxplus(m0, m1);
-        QLLR m23 = llrcalc.Boxplus(m2, m3);
-        mcv[j0] = llrcalc.Boxplus(m1, m23);
-        mcv[j1] = llrcalc.Boxplus(m0, m23);
-        mcv[j2] = llrcalc.Boxplus(m01, m3);
-        mcv[j3] = llrcalc.Boxplus(m01, m2);
-        break;
+      int nodes = sumX2(j);
+      it_error_if((nodes < 2) || (nodes > max_cnd), "LDPC_Code::"
+                  "decode_batch(): Unsupported check node degree " << nodes);
+
+      // variable to check messages, their sign parity and the two
+      // smallest magnitudes
+      lanes16 parity = zero;
+      lanes16 min1 = max_mag;
+      lanes16 min2 = max_mag;
+      int index = j; // tracks j+i*ncheck
+      for (int i = 0; i < nodes; i++) {
+        lanes16 mi = lanes_subs(lanes_load(p_app + V(index) * L),
+                                lanes_load(p_msg + index * L));
+        lanes_store(p_m + i * L, mi);
+        parity = lanes_xor(parity, mi);
+        lanes16 a = lanes_abs(mi);
+        min2 = lanes_min(min2, lanes_max(min1, a));
+        min1 = lanes_min(min1, a);
+        index += ncheck;
       }
-      case 5: {
-        int j0 = j;
-        QLLR m0 = mvc[jind[j0]];
-        int j1 = j0 + ncheck;
-        QLLR m1 = mvc[jind[j1]];
-        int j2 = j1 + ncheck;
-        QLLR m2 = mvc[jind[j2]];
-        int j3 = j2 + ncheck;
-        QLLR m3 = mvc[jind[j3]];
-        int j4 = j3 + ncheck;
-        QLLR m4 = mvc[jind[j4]];
-        QLLR m01 = llrcalc.Boxplus(m0, m1);
-        QLLR m02 = llrcalc.Boxplus(m01, m2);
-        QLLR m34 = llrcalc.Boxplus(m3, m4);
-        QLLR m24 = llrcalc.Boxplus(m2, m34);
-        mcv[j0] = llrcalc.Boxplus(m1, m24);
-        mcv[j1] = llrcalc.Boxplus(m0, m24);
-        mcv[j2] = llrcalc.Boxplus(m01, m34);
-        mcv[j3] = llrcalc.Boxplus(m02, m4);
-        mcv[j4] = llrcalc.Boxplus(m02, m3);
-        break;
+
+      lanes16 c1, c2;
+      if (use_offset) {
+        c1 = lanes_max(lanes_subs(min1, offset), zero);
+        c2 = lanes_max(lanes_subs(min2, offset), zero);
       }
-      case 6: {
-        int j0 = j;
-        QLLR m0 = mvc[jind[j0]];
-        int j1 = j0 + ncheck;
-        QLLR m1 = mvc[jind[j1]];
-        int j2 = j1 + ncheck;
-        QLLR m2 = mvc[jind[j2]];
-        int j3 = j2 + ncheck;
-        QLLR m3 = mvc[jind[j3]];
-        int j4 = j3 + ncheck;
-        QLLR m4 = mvc[jind[j4]];
-        int j5 = j4 + ncheck;
-        QLLR m5 = mvc[jind[j5]];
-        QLLR m01 = llrcalc.Boxplus(m0, m1);
-        QLLR m23 = llrcalc.Boxplus(m2, m3);
-        QLLR m45 = llrcalc.Boxplus(m4, m5);
-        QLLR m03 = llrcalc.Boxplus(m01, m23);
-        QLLR m25 = llrcalc.Boxplus(m23, m45);
-        QLLR m0145 = llrcalc.Boxplus(m01, m45);
-        mcv[j0] = llrcalc.Boxplus(m1, m25);
-        mcv[j1] = llrcalc.Boxplus(m0, m25);
-        mcv[j2] = llrcalc.Boxplus(m0145, m3);
-        mcv[j3] = llrcalc.Boxplus(m0145, m2);
-        mcv[j4] = llrcalc.Boxplus(m03, m5);
-        mcv[j5] = llrcalc.Boxplus(m03, m4);
-        break;
+      else {
+        c1 = lanes_scale(min1, factor);
+        c2 = lanes_scale(min2, factor);
       }
-      default: {
-        int nodes = sumX2(j);
-        if( nodes > max_cnd ) {
-          std::ostringstream m_sout;
-          m_sout << "check node degrees >" << max_cnd << " not supported in this version";
-          it_error( m_sout.str() );
-        }
 
-        nodes--;
-        jj[0] = j;
-        m[0] = mvc[jind[jj[0]]];
-        for(int i = 1; i <= nodes; i++ ) {
-          jj[i] = jj[i-1] + ncheck;
-          m[i] = mvc[jind[jj[i]]];
+      index = j;
+      for (int i = 0; i < nodes; i++) {
+        lanes16 mi = lanes_load(p_m + i * L);
+        lanes16 mag = lanes_select(lanes_cmpeq(lanes_abs(mi), min1), c1, c2);
+        lanes16 out = lanes_negate(lanes_sign(lanes_xor(parity, mi)), mag);
+        lanes_store(p_msg + index * L, out);
+        int v = V(index) * L;
+        if (layered) {
+          lanes16 a = lanes_adds(mi, out);
+          lanes_store(p_app + v, lanes_select(frozen, a, lanes_load(p_app + v)));
         }
-
-	// compute partial sums from the left and from the right
-        ml[0] = m[0];
-        mr[0] = m[nodes];
-        for(int i = 1; i < nodes; i++ ) {
-          ml[i] = llrcalc.Boxplus( ml[i-1], m[i] );
-          mr[i] = llrcalc.Boxplus( mr[i-1], m[nodes-i] );
+        else {
+          lanes_store(p_acc + v, lanes_adds(lanes_load(p_acc + v), out));
         }
-
-	// merge partial sums
-        mcv[jj[0]] = mr[nodes-1];
-        mcv[jj[nodes]] = ml[nodes-1];
-        for(int i = 1; i < nodes; i++ )
-          mcv[jj[i]] = llrcalc.Boxplus( ml[i-1], mr[nodes-1-i] );
+        index += ncheck;
       }
-      }  // switch statement
     }
-    
-    // step 2: variable to check nodes
-    for (int i = 0; i < nvar; i++) {
-      switch (sumX1(i)) {
-      case 0:
-        it_error("LDPC_Code::bp_decode(): sumX1(i)=0");
-      case 1: {
-        /* This case is rare but apparently occurs for codes used in
-	   the DVB-T2 standard.
-	 */
-	QLLR m0 = mcv[iind[i]];
-        mvc[i] = LLRin(i);
-        LLRout(i) = LLRin(i) + m0;
-        break;
-      }
-      case 2: {
-        QLLR m0 = mcv[iind[i]];
-        int i1 = i + nvar;
-        QLLR m1 = mcv[iind[i1]];
-        mvc[i] = LLRin(i) + m1;
-        mvc[i1] = LLRin(i) + m0;
-        LLRout(i) = mvc[i1] + m1;
-        break;
-      }
-      case 3: {
-        int i0 = i;
-        QLLR m0 = mcv[iind[i0]];
-        int i1 = i0 + nvar;
-        QLLR m1 = mcv[iind[i1]];
-        int i2 = i1 + nvar;
-        QLLR m2 = mcv[iind[i2]];
-        LLRout(i) = LLRin(i) + m0 + m1 + m2;
-        mvc[i0] = LLRout(i) - m0;
-        mvc[i1] = LLRout(i) - m1;
-        mvc[i2] = LLRout(i) - m2;
-        break;
-      }
-      case 4: {
-        int i0 = i;
-        QLLR m0 = mcv[iind[i0]];
-        int i1 = i0 + nvar;
-        QLLR m1 = mcv[iind[i1]];
-        int i2 = i1 + nvar;
-        QLLR m2 = mcv[iind[i2]];
-        int i3 = i2 + nvar;
-        QLLR m3 = mcv[iind[i3]];
-        LLRout(i) = LLRin(i) + m0 + m1 + m2 + m3;
-        mvc[i0] = LLRout(i) - m0;
-        mvc[i1] = LLRout(i) - m1;
-        mvc[i2] = LLRout(i) - m2;
-        mvc[i3] = LLRout(i) - m3;
-        break;
+
+    if (!layered) {
+      for (int i = 0; i < nvar * L; i += L) {
+        lanes_store(p_app + i, lanes_select(frozen, lanes_load(p_acc + i),
+                                            lanes_load(p_app + i)));
       }
-      default:   { // differential update
-        QLLR mvc_temp = LLRin(i);
-        int index_iind = i; // tracks i+jp*nvar
-        for (int jp = 0; jp < sumX1(i); jp++) {
-          mvc_temp +=  mcv[iind[index_iind]];
-          index_iind += nvar;
-        }
-        LLRout(i) = mvc_temp;
-        index_iind = i;  // tracks i+j*nvar
-        for (int j = 0; j < sumX1[i]; j++) {
-          mvc[index_iind] = mvc_temp - mcv[iind[index_iind]];
-          index_iind += nvar;
+    }
+
+    if (psc) {
+      int valid = lanes_syndrome_check(app) & active;
+      for (int l = 0; l < L; l++) {
+        if ((valid >> l) & 1) {
+          nrof_iters(l) = iter;
         }
       }
-      }
+      active &= ~valid;
+      frozen = lanes_from_bits(~active);
     }
 
-    if (psc && syndrome_check(LLRout)) {
-      is_valid_codeword = true;
+    if (iter >= max_iters) {
       break;
     }
   }
-  while (iter < max_iters);
 
-  if (nvar >= 100000) { it_info_debug(""); }
-  return (is_valid_codeword ? iter : -iter);
+  for (int l = 0; l < L; l++) {
+    if ((active >> l) & 1) {
+      nrof_iters(l) = -iter;
+    }
+  }
+}
+
+int LDPC_Code::lanes_syndrome_check(const svec &app) const
+{
+  const int L = LDPC_batch_lanes;
+  const short *p_app = app._data();
+  lanes16 fail = lanes_set(0);
+  for (int j = 0; j < ncheck; j++) {
+    lanes16 parity = lanes_set(0);
+    int vind = j; // tracks j+i*ncheck
+    for (int i = 0; i < sumX2(j); i++) {
+      parity = lanes_xor(parity, lanes_load(p_app + V(vind) * L));
+      vind += ncheck;
+    }
+    fail = lanes_or(fail, parity);
+  }
+  return (~lanes_sign_bits(fail)) & ((1 << L) - 1);
 }
 
 
@@ -1732,15 +3130,212 @@ void LDPC_Code::decoder_parameterization(const LDPC_Parity* const Hmat)
     }
   }
 
+  // keep the block structure of quasi-cyclic codes
+  qc_Z = 0;
+  const BLDPC_Parity* const Hb = dynamic_cast<const BLDPC_Parity*>(Hmat);
+  if ((Hb != 0) && Hb->is_valid()) {
+    qc_parameterization(Hb);
+  }
+
   H_defined = true;
 }
 
 
+void LDPC_Code::qc_parameterization(const BLDPC_Parity* const Hmat)
+{
+  int Z = Hmat->get_exp_factor();
+  imat H_b = Hmat->get_base_matrix();
+  if ((Z <= 0) || (H_b.rows() * Z != ncheck) || (H_b.cols() * Z != nvar)) {
+    return;
+  }
+
+  int nblocks = 0;
+  for (int r = 0; r < H_b.rows(); r++) {
+    for (int c = 0; c < H_b.cols(); c++) {
+      if (H_b(r, c) >= 0) {
+        nblocks++;
+      }
+    }
+  }
+  ivec ptr(H_b.rows() + 1);
+  ivec col(nblocks);
+  ivec shift(nblocks);
+
+  int b = 0;
+  for (int r = 0; r < H_b.rows(); r++) {
+    ptr(r) = b;
+    for (int c = 0; c < H_b.cols(); c++) {
+      if (H_b(r, c) >= 0) {
+        col(b) = c;
+        shift(b) = H_b(r, c) % Z;
+        b++;
+      }
+    }
+  }
+  ptr(H_b.rows()) = b;
+
+  // The parity check matrix may have been modified after the expansion
+  // of the base matrix (e.g. columns permuted by a generator), so check
+  // that it still has the expected block structure
+  if (nblocks * Z != sum(sumX2)) {
+    return;
+  }
+  for (int r = 0; r < H_b.rows(); r++) {
+    for (int k = ptr(r); k < ptr(r + 1); k++) {
+      for (int i = 0; i < Z; i++) {
+        if (Hmat->get(r * Z + i, col(k) * Z + (i + shift(k)) % Z) != 1) {
+          return;
+        }
+      }
+    }
+  }
+
+  qc_Z = Z;
+  qc_ptr = ptr;
+  qc_col = col;
+  qc_shift = shift;
+}
+
+
 void LDPC_Code::setup_decoder()
 {
   if (H_defined) {
-    mcv.set_size(max(sumX2) * ncheck);
-    mvc.set_size(max(sumX1) * nvar);
+    if (edge_ordered) {
+      edge_parameterization();
+      mcv.set_size(e_var.size());
+      mvc.set_size(0);
+    }
+    else {
+      e_ptr.set_size(0);
+      e_var.set_size(0);
+      v_ptr.set_size(0);
+      v_edge.set_size(0);
+      v_order.set_size(0);
+      mcv.set_size(max(sumX2) * ncheck);
+      mvc.set_size(max(sumX1) * nvar);
+    }
+  }
+}
+
+
+void LDPC_Code::edge_parameterization()
+{
+  ivec c_order(ncheck), pos(nvar);
+  v_order.set_size(nvar);
+  if (rcm_ordered) {
+    rcm_ordering(c_order, v_order);
+  }
+  else {
+    for (int j = 0; j < ncheck; j++) {
+      c_order(j) = j;
+    }
+    for (int i = 0; i < nvar; i++) {
+      v_order(i) = i;
+    }
+  }
+
+  // edges sorted by check node
+  e_ptr.set_size(ncheck + 1);
+  e_var.set_size(sum(sumX2));
+  e_ptr(0) = 0;
+  for (int k = 0; k < ncheck; k++) {
+    int j = c_order(k);
+    for (int i = 0; i < sumX2(j); i++) {
+      e_var(e_ptr(k) + i) = V(j + i * ncheck);
+    }
+    e_ptr(k + 1) = e_ptr(k) + sumX2(j);
+  }
+
+  // edge indices of each variable node
+  v_ptr.set_size(nvar + 1);
+  v_ptr(0) = 0;
+  for (int k = 0; k < nvar; k++) {
+    pos(v_order(k)) = v_ptr(k);
+    v_ptr(k + 1) = v_ptr(k) + sumX1(v_order(k));
+  }
+  v_edge.set_size(v_ptr(nvar));
+  for (int e = 0; e < e_var.size(); e++) {
+    v_edge(pos(e_var(e))++) = e;
+  }
+}
+
+
+void LDPC_Code::rcm_ordering(ivec &c_order, ivec &v_order) const
+{
+  // Cuthill-McKee breadth-first search on the Tanner graph, starting
+  // from a variable node of lowest degree in each connected component.
+  // Nodes 0..nvar-1 are the variable nodes and nvar..nvar+ncheck-1 the
+  // check nodes. The neighbours are visited in order of increasing
+  // degree.
+  int cmax = max(sumX1);
+  int nnodes = nvar + ncheck;
+  ivec queue(nnodes);
+  bvec visited(nnodes);
+  visited.zeros();
+  ivec start = sort_index(sumX1);
+  ivec nb(std::max(cmax, max(sumX2)));
+  int head = 0;
+  int tail = 0;
+  for (int s = 0; s < nvar; s++) {
+    if (visited(start(s)) == bin(1)) {
+      continue;
+    }
+    visited(start(s)) = 1;
+    queue(tail++) = start(s);
+    while (head < tail) {
+      int u = queue(head++);
+      int d = 0;
+      if (u < nvar) {
+        for (int k = 0; k < sumX1(u); k++) {
+          int w = nvar + C(k + u * cmax);
+          if (visited(w) == bin(0)) {
+            nb(d++) = w;
+          }
+        }
+      }
+      else {
+        for (int k = 0; k < sumX2(u - nvar); k++) {
+          int w = V(u - nvar + k * ncheck);
+          if (visited(w) == bin(0)) {
+            nb(d++) = w;
+          }
+        }
+      }
+      // insertion sort by node degree
+      for (int k = 1; k < d; k++) {
+        int w = nb(k);
+        int dw = (w < nvar) ? sumX1(w) : sumX2(w - nvar);
+        int l = k - 1;
+        while ((l >= 0) && (((nb(l) < nvar) ? sumX1(nb(l)) : sumX2(nb(l) - nvar))
+                            > dw)) {
+          nb(l + 1) = nb(l);
+          l--;
+        }
+        nb(l + 1) = w;
+      }
+      for (int k = 0; k < d; k++) {
+        visited(nb(k)) = 1;
+        queue(tail++) = nb(k);
+      }
+    }
+  }
+  // check nodes without any edges
+  for (int j = 0; j < ncheck; j++) {
+    if (visited(nvar + j) == bin(0)) {
+      queue(tail++) = nvar + j;
+    }
+  }
+
+  // reverse the order and split it into variable and check nodes
+  int nv = 0;
+  int nc = 0;
+  for (int k = nnodes - 1; k >= 0; k--) {
+    if (queue(k) < nvar) {
+      v_order(nv++) = queue(k);
+    }
+    else {
+      c_order(nc++) = queue(k) - nvar;
+    }
   }
 }
 
@@ -1793,7 +3388,15 @@ std::ostream &operator<<(std::ostream &os, const LDPC_Code &C)
   << " - method : " << C.dec_method << "\n"
   << " - max. iterations : " << C.max_iters << "\n"
   << " - syndrome check at each iteration : " << C.psc << "\n"
-  << " - syndrome check at start : " << C.pisc << "\n"
+  << " - syndrome check at start : " << C.pisc << "\n";
+  if (C.qc_Z > 0) {
+    os << " - quasi-cyclic decoder, expansion factor : " << C.qc_Z << "\n";
+  }
+  else if (C.e_ptr.size() > 0) {
+    os << " - edge-ordered messages" << (C.rcm_ordered ? ", RCM ordering" : "")
+       << "\n";
+  }
+  os
   << "-------------------------------------------------\n"
   << C.llrcalc << "\n";
   return os;
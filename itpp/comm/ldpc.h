@@ -301,6 +301,9 @@ protected:
   //! Generate a random parity check matrix
   void generate_random_H(const ivec& C, const ivec& R, const ivec& cycopt);
 
+  //! Generate a parity check matrix by progressive edge-growth (PEG)
+  void generate_PEG_H(const ivec& C, const ivec& R, const ivec& cycopt);
+
   /*! \brief Compute target number of columns (C) and rows (R) with
       a specific number of ones.
 
@@ -346,7 +349,7 @@ public:
     perspective
     \param chk_deg vector of check degree distributions, from an edge
     perspective
-    \param method currently the only provided method is "rand" (see below)
+    \param method "rand" or "PEG" (see below)
     \param options Determines the level of matrix optimization.
 
     The "rand" method generates a fully unstructured random
@@ -373,6 +376,22 @@ public:
     graphs by placing pairs or n-tuples of edges at time, for
     example, column by column.
 
+    The "PEG" method builds the graph by progressive edge-growth (Hu,
+    Eleftheriou and Arnold). The variable nodes are processed in
+    ascending order of degree, and each of their edges is placed on a
+    check node as far away as possible from the variable node in the
+    graph built so far, found by a breadth-first search. Among the
+    candidates, the check node with the fewest edges is chosen. The
+    parameter \c options sets the girth targets in the same way as
+    for the "rand" method: the search stops as soon as no cycle shorter
+    than the target can be closed, so that the targets bound the
+    construction time. The targets are not guaranteed: when every check
+    node that can take more edges is close to the variable node, the
+    farthest one is taken. For example, "200 10" maximizes the local girth
+    of the degree-2 nodes and targets girth 10 for the other nodes. The
+    value "0 0" only avoids double edges. This method is much faster
+    than the cycle removal of the "rand" method for large graphs.
+
     \note Alternative (user-defined) methods for code generation can
     be implemented by inheriting \c LDPC_Parity_Irregular.
   */
@@ -668,6 +687,101 @@ protected:
 };
 
 
+// ----------------------------------------------------------------------
+// LDPC_Generator_Sparse
+// ----------------------------------------------------------------------
+
+/*!
+  \brief Sparse LDPC Generator class
+
+  This generator encodes directly from the sparse parity check matrix,
+  i.e. no dense generator matrix is computed or stored. The rows and
+  the parity columns of the parity check matrix are reordered to the
+  approximate lower triangular form of Richardson and Urbanke:
+  \f[ H = \left[ \begin{array}{ccc} A & B & T \\ C & D & E
+  \end{array} \right] \f]
+  where \f$ T \f$ is lower triangular with ones on its diagonal and the
+  gap \f$ g \f$ (the number of rows of \f$ [C\ D\ E] \f$) is small. The
+  parity bits are then computed by two back-substitutions through
+  \f$ T \f$ and a multiplication with the dense \f$ g \times g \f$
+  matrix \f$ \phi^{-1} = (E T^{-1} B + D)^{-1} \f$. Both the encoding
+  complexity and the storage requirements are thus proportional to the
+  number of ones in \f$ H \f$ (plus \f$ g^2 \f$).
+
+  The information bits are placed on the first \f$ N-M \f$ columns of
+  \f$ H \f$. If the last \f$ M \f$ columns of \f$ H \f$ do not form an
+  invertible matrix, the columns of \f$ H \f$ are permuted, as done by
+  \c LDPC_Generator_Systematic. The columns of \c BLDPC_Parity matrices
+  are never permuted, since their parity part has a dual-diagonal
+  structure. In this case the gap does not exceed the expansion factor.
+
+  Example:
+  \code
+  LDPC_Parity_Regular H(1000, 3, 6, "rand", "150 8");
+  LDPC_Generator_Sparse G(&H); // may permute the columns of H
+  LDPC_Code C(&H, &G);
+  \endcode
+*/
+class LDPC_Generator_Sparse : public LDPC_Generator
+{
+public:
+  //! Default constructor
+  LDPC_Generator_Sparse(): LDPC_Generator("sparse"), N(0), M(0), K(0),
+      row_ptr(), row_col(), pivots(), gap_cols(), phi_inv() {}
+  //! Parametrized constructor
+  LDPC_Generator_Sparse(LDPC_Parity* const H, bool natural_ordering = false);
+
+  //! Virtual destructor
+  virtual ~LDPC_Generator_Sparse() {}
+
+  //! Generator specific encode function
+  virtual void encode(const bvec &input, bvec &output);
+
+  /*!
+    \brief Construct the sparse generator
+
+    \param H A pointer to the parity check matrix \c H
+
+    \param natural_ordering If this flag is true, the columns of \c H
+    are never permuted. An error is reported if the last \f$ M \f$
+    columns of \c H are not invertible.
+
+    \return This function returns the permutation vector \c P on the
+    variable nodes that was applied to the columns of \c H. The k-th
+    column of the original \c H is the \c P(k)-th column of the
+    rearranged \c H.
+  */
+  ivec construct(LDPC_Parity* const H, bool natural_ordering = false);
+
+  //! Get the gap of the approximate lower triangular form
+  int get_gap() const { return gap_cols.size(); }
+
+protected:
+  //! Save generator data to a file
+  virtual void save(const std::string& filename) const;
+  //! Read generator data from a file
+  virtual void load(const std::string& filename);
+
+  int N;  //!< Codeword length
+  int M;  //!< Number of parity check bits
+  int K;  //!< Number of information bits = N-M
+  //! Pointers to the checks in \c row_col, in encoding order
+  ivec row_ptr;
+  //! Variables connected to each check
+  ivec row_col;
+  //! Parity variable computed by each row of \f$ T \f$
+  ivec pivots;
+  //! Parity variables determined through \f$ \phi^{-1} \f$
+  ivec gap_cols;
+  //! Inverse of the \f$ g \times g \f$ gap matrix \f$ \phi \f$
+  GF2mat phi_inv;
+
+private:
+  //! Back-substitution through the triangular part \f$ T \f$
+  void back_substitute(bvec &output) const;
+};
+
+
 // ----------------------------------------------------------------------
 // LDPC_Code
 // ----------------------------------------------------------------------
@@ -756,6 +870,9 @@ public:
     \brief Set the codec, from a parity check matrix and optionally a
     generator
 
+    If \c H is a valid \c BLDPC_Parity matrix, the decoder also keeps
+    its quasi-cyclic structure (see \c bp_decode()).
+
     \param H The parity check matrix
     \param G A pointer to the optional generator object
     \param perform_integrity_check if true, then check that the parity and generator matrices are consistent
@@ -784,7 +901,9 @@ public:
     \param filename Name of the file where to store the codec
 
     \note The decoder parameters (\c max_iters, \c syndr_check_each_iter,
-    \c syndr_check_at_start and \c llrcalc) are not saved to a file.
+    \c syndr_check_at_start and \c llrcalc) are not saved to a file. The
+    message layout set with \c set_edge_ordering() is saved, and restored
+    by \c load_code(); files without it leave the current layout.
   */
   void save_code(const std::string& filename) const;
 
@@ -792,13 +911,71 @@ public:
   /*!
     \brief Set the decoding method
 
-    Currently only a belief propagation method ("BP" or "bp") is
-    supported.
+    The following belief propagation methods are supported (the
+    names are not case sensitive):
+    - "BP": sum-product decoding with a flooding schedule, i.e. all
+      check nodes are updated, then all variable nodes
+    - "NMS": normalized min-sum decoding, flooding schedule
+    - "OMS": offset min-sum decoding, flooding schedule
+    - "LBP": sum-product decoding with a layered (row-by-row)
+      schedule
+    - "LNMS": normalized min-sum decoding, layered schedule
+    - "LOMS": offset min-sum decoding, layered schedule
+
+    With the layered schedule, the a posteriori LLRs are refreshed
+    after each check node update, so that the next check nodes
+    already use the new information. This typically requires about
+    half the number of iterations of the flooding schedule.
+
+    The correction terms of the min-sum methods can be changed with
+    \c set_min_sum_params().
 
     \note The default method set in the class constructors is "BP".
   */
   void set_decoding_method(const std::string& method);
 
+  /*!
+    \brief Set the correction terms of the min-sum check node update
+
+    \param norm_factor Scaling factor applied to the check node output
+    magnitudes by the normalized min-sum methods ("NMS" and "LNMS")
+    \param offset Offset (in real LLR units) subtracted from the check
+    node output magnitudes by the offset min-sum methods ("OMS" and
+    "LOMS")
+
+    \note The default values set in the class constructors are "0.75"
+    and "0.5", respectively.
+  */
+  void set_min_sum_params(double norm_factor, double offset);
+
+  /*!
+    \brief Set the memory layout of the decoder messages
+
+    By default, the messages of check node \c j (variable node \c i)
+    are stored with a stride of \c ncheck (\c nvar), and the other
+    half-iteration reaches them through an index table, so that each
+    node update touches memory scattered over the whole message arrays.
+
+    If \c ordered is true, the edges of the Tanner graph are sorted by
+    check node when the decoder is set up. The messages of each check
+    node are then contiguous and the check node updates stream through
+    memory, while the variable node updates access the messages through
+    a compact list of edge indices. A single message array is used for
+    both directions. If \c rcm is true as well, the check and variable
+    nodes are renumbered in reverse Cuthill-McKee order of the Tanner
+    graph, which keeps the edges of neighbouring nodes close in memory.
+    This mainly pays off for codes whose messages do not fit into the
+    cache.
+
+    \note With the layered schedule, the RCM renumbering changes the
+    order in which the check nodes are processed. The quasi-cyclic
+    decoder (see \c bp_decode()) is not affected by this setting.
+
+    \note By default, the edges are not reordered. The setting is saved
+    with the codec by \c save_code().
+  */
+  void set_edge_ordering(bool ordered, bool rcm = false);
+
   /*!
     \brief Set the decoding loop exit conditions
 
@@ -834,6 +1011,10 @@ public:
   virtual void encode(const bvec &input, bvec &output);
   //! \brief Encode codeword
   virtual bvec encode(const bvec &input);
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
 
 
   // ------------ Decoding  ---------------------
@@ -862,7 +1043,9 @@ public:
 
     This function implements the sum-product message passing decoder
     (Pearl's belief propagation) using LLR values as messages.  A
-    fast update mechanism is used for nodes with large degrees.
+    fast update mechanism is used for nodes with large degrees. The
+    min-sum approximations of the check node update and the layered
+    schedule can be selected with \c set_decoding_method().
 
     \param LLRin  vector of \c nvar input LLR values
     \param LLRout vector of \c nvar output LLR values
@@ -879,9 +1062,53 @@ public:
     provided in \c set_llrcalc(), one can change the resolution, for
     example to use a logmax approximation. See the documentation of \c
     LLR_calc_unit for details on how to do this.
+
+    For quasi-cyclic codes set up from a \c BLDPC_Parity matrix, the
+    messages are stored per circulant block and addressed by cyclic
+    shifts of the variable node LLRs, so that all Z rows of a block row
+    are processed with contiguous memory accesses instead of the
+    per-edge index tables. With the layered schedule, each block row is
+    one layer. The layered and min-sum results are identical to those of
+    the generic decoder, whereas the flooding sum-product update may
+    differ slightly due to a different order of the boxplus operations.
   */
   int bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout);
 
+  /*! \brief Decode a batch of codewords, several frames at a time
+
+    This function decodes many independent codewords of the same code.
+    The frames are interleaved into 16-bit fixed-point lanes (8 frames
+    per SSE2 register), so that a single pass over the Tanner graph
+    serves all frames of a group. The check node update is always a
+    min-sum update: the offset correction is used for the "OMS" and
+    "LOMS" methods and the normalization otherwise (see \c
+    set_min_sum_params()). The schedule (flooding or layered) and the
+    exit conditions follow the settings of the codec.
+
+    Each frame stops being counted as active as soon as it satisfies
+    the syndrome check, and the decoding of a group of frames ends when
+    all its frames have converged.
+
+    \param llr_in matrix of input LLR values, one codeword (\c nvar
+    values) per column
+    \param syst_bits decoded systematic bits, one codeword per column
+    \param nrof_iters number of iterations performed for each frame,
+    with a negative sign if no valid codeword was found (same
+    convention as for \c bp_decode())
+
+    \note The messages are represented with a resolution of 1/8 and
+    saturate at magnitude 4096, so the results may slightly differ
+    from those of \c bp_decode(). With an LLR calculation unit of the
+    same resolution and no correction table (\c LLR_calc_unit(3, 0, 0))
+    and no saturation, \c bp_decode() gives the same decisions and
+    iteration counts.
+  */
+  void decode_batch(const mat &llr_in, bmat &syst_bits, ivec &nrof_iters);
+  //! Decode a batch of codewords, several frames at a time
+  void decode_batch(const mat &llr_in, bmat &syst_bits);
+  //! Decode a batch of codewords using several threads
+  using Channel_Code::decode_batch;
+
   /*! \brief Syndrome check, on QLLR vector
 
     This function performs a syndrome check on a softbit (LLR
@@ -902,6 +1129,9 @@ public:
     return (1.0 - static_cast<double>(ncheck) / nvar);
   }
 
+  //! Create a copy of the codec (used by \c decode_batch())
+  virtual Channel_Code *clone() const { return new LDPC_Code(*this); }
+
   //! Get the number of variable nodes
   int get_nvar() const { return nvar; }
 
@@ -920,6 +1150,9 @@ public:
   //! Get LLR calculation unit used in decoder
   LLR_calc_unit get_llrcalc() const { return llrcalc; }
 
+  //! Get the expansion factor used by the quasi-cyclic decoder (0 if not used)
+  int get_qc_exp_factor() const { return qc_Z; }
+
   //! Print some properties of the codec in plain text
   friend std::ostream &operator<<(std::ostream &os, const LDPC_Code &C);
 
@@ -936,6 +1169,19 @@ protected:
   bool psc;   //!< check syndrom after each iteration
   bool pisc;   //!< check syndrom before first iteration
   LLR_calc_unit llrcalc; //!< LLR calculation unit
+  bool layered;  //!< true if the layered schedule is used
+  double ms_factor;  //!< normalization factor of the NMS check node update
+  double ms_offset;  //!< offset of the OMS check node update
+  bool edge_ordered;  //!< true if the messages are stored in edge order
+  bool rcm_ordered;  //!< true if the nodes are renumbered in RCM order
+
+  //! Check node update rules
+  enum CN_Update {
+    CN_SPA,  //!< Sum-product (boxplus) update
+    CN_NMS,  //!< Normalized min-sum update
+    CN_OMS   //!< Offset min-sum update
+  };
+  CN_Update cn_update; //!< Check node update rule
 
   //! Function to compute decoder parameterization
   void decoder_parameterization(const LDPC_Parity* const H);
@@ -946,10 +1192,77 @@ protected:
   //! Initialize decoder
   void setup_decoder();
 
+  //! Function to compute the quasi-cyclic decoder parameterization
+  void qc_parameterization(const BLDPC_Parity* const H);
+
+  //! Belief propagation decoding of quasi-cyclic codes
+  int qc_bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout);
+
+  //! Syndrome check of quasi-cyclic codes
+  bool qc_syndrome_check(const QLLRvec &LLR) const;
+
+  //! Belief propagation decoding with the layered schedule
+  int layered_bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout);
+
+  //! Function to compute the edge-ordered decoder parameterization
+  void edge_parameterization();
+
+  //! Reverse Cuthill-McKee ordering of the check and variable nodes
+  void rcm_ordering(ivec &c_order, ivec &v_order) const;
+
+  //! Belief propagation decoding with edge-ordered messages
+  int edge_bp_decode(const QLLRvec &LLRin, QLLRvec &LLRout);
+
+  /*!
+    \brief Sum-product check node update of a degree \c d node
+
+    The extrinsic outputs computed from the incoming messages
+    \c m(0..d-1) are written to \c out. \c ml and \c mr are used as
+    temporary storage for the partial sums.
+  */
+  void spa_check_update(int d, const QLLRvec &m, QLLRvec &out,
+                        QLLRvec &ml, QLLRvec &mr) const;
+
+  /*!
+    \brief Min-sum check node update of a degree \c d node
+
+    The normalization (\c cn_update == CN_NMS) or offset (\c cn_update ==
+    CN_OMS) correction is applied to the output magnitudes. The offset
+    is given in the QLLR domain.
+  */
+  void min_sum_check_update(int d, const QLLRvec &m, QLLRvec &out,
+                            QLLR offset) const;
+
+  /*!
+    \brief Decode a group of interleaved frames (used by \c decode_batch())
+
+    \c llr holds \c nvar x \c lanes 16-bit input LLRs, the LLR of
+    variable node \c i in frame \c l is stored at \c llr(i*lanes+l). The
+    a posteriori LLRs are returned in \c app in the same format. Lanes
+    without a bit set in \c active_mask are padding and are ignored.
+  */
+  void decode_lanes(const svec &llr, svec &app, int active_mask,
+                    ivec &nrof_iters);
+
+  //! Syndrome check on interleaved frames, bit \c l set if frame \c l is valid
+  int lanes_syndrome_check(const svec &app) const;
+
 private:
   // Parity check matrix parameterization
   ivec C, V, sumX1, sumX2, iind, jind;
 
+  // Quasi-cyclic structure: the blocks of block row r are
+  // qc_ptr(r)..qc_ptr(r+1)-1, with column block qc_col and cyclic shift
+  // qc_shift. qc_Z is the expansion factor, or 0 if not used.
+  int qc_Z;
+  ivec qc_ptr, qc_col, qc_shift;
+
+  // Edge-ordered structure: the edges of the k-th check node are
+  // e_ptr(k)..e_ptr(k+1)-1, connected to the variable nodes e_var. The
+  // edges of variable node v_order(k) are v_edge(v_ptr(k)..v_ptr(k+1)-1).
+  // e_ptr is empty if the edges are not reordered.
+  ivec e_ptr, e_var, v_ptr, v_edge, v_order;
+
   // temporary storage for decoder (memory allocated when codec defined)
   QLLRvec mvc, mcv;
 
@@ -29,6 +29,13 @@
 
 #include <itpp/comm/llr.h>
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
 
 namespace itpp
 {
@@ -62,12 +69,15 @@ void LLR_calc_unit::init_llr_tables(short int d1, short int d2, short int d3)
 
 ivec LLR_calc_unit::construct_logexp_table()
 {
-  ivec result(Dint2);
+  // The extra zero entry lets the vector functions clamp the table
+  // index to Dint2 instead of testing it
+  ivec result(Dint2 + 1);
   for (int i = 0; i < Dint2; i++) {
     double x = pow2(static_cast<double>(Dint3 - Dint1)) * i;
     result(i) = to_qllr(std::log(1 + std::exp(-x)));
   }
-  it_assert(length(result) == Dint2, "Ldpc_codec::construct_logexp_table()");
+  result(Dint2) = 0;
+  it_assert(length(result) == Dint2 + 1, "Ldpc_codec::construct_logexp_table()");
 
   return result;
 }
@@ -159,6 +169,209 @@ QLLR LLR_calc_unit::Boxplus(QLLR a, QLLR b) const
   return result;
 }
 
+// ----------------------------------------------------------------------
+// Vector functions
+// ----------------------------------------------------------------------
+
+//! \cond
+
+#if defined(__SSE2__)
+
+// SSE2 has no 32-bit min/max/abs, so they are built from compares
+static inline __m128i qllr4_select(__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+static inline __m128i qllr4_min(__m128i a, __m128i b)
+{
+  return qllr4_select(_mm_cmpgt_epi32(a, b), a, b);
+}
+static inline __m128i qllr4_max(__m128i a, __m128i b)
+{
+  return qllr4_select(_mm_cmpgt_epi32(a, b), b, a);
+}
+static inline __m128i qllr4_abs(__m128i a)
+{
+  __m128i s = _mm_srai_epi32(a, 31);
+  return _mm_sub_epi32(_mm_xor_si128(a, s), s);
+}
+static inline __m128i qllr4_load(const QLLR *p)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+static inline void qllr4_store(QLLR *p, __m128i a)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a);
+}
+
+// table(min(x >> shift, last)) for non-negative x
+static inline __m128i qllr4_lookup(const int *table, __m128i x, int shift,
+                                   int last)
+{
+  __m128i ind = qllr4_min(_mm_sra_epi32(x, _mm_cvtsi32_si128(shift)),
+                          _mm_set1_epi32(last));
+#if defined(__AVX2__)
+  return _mm_i32gather_epi32(table, ind, 4);
+#else
+  int i[4];
+  qllr4_store(i, ind);
+  return _mm_set_epi32(table[i[3]], table[i[2]], table[i[1]], table[i[0]]);
+#endif
+}
+
+#endif // __SSE2__
+
+//! \endcond
+
+void LLR_calc_unit::Boxplus(const QLLRvec &a, const QLLRvec &b,
+                            QLLRvec &out) const
+{
+  it_assert_debug(a.size() == b.size(), "LLR_calc_unit::Boxplus(): "
+                  "Vector sizes do not match");
+  out.set_size(a.size());
+  Boxplus(a._data(), b._data(), out._data(), a.size());
+}
+
+void LLR_calc_unit::Boxplus(const QLLR *a, const QLLR *b, QLLR *out,
+                            int n) const
+{
+  int i = 0;
+#if defined(__SSE2__)
+  const int *table = logexp_table._data();
+  const __m128i qmax = _mm_set1_epi32(QLLR_MAX);
+  const __m128i qmin = _mm_set1_epi32(-QLLR_MAX);
+  for (; i + 4 <= n; i += 4) {
+    __m128i va = qllr4_load(a + i);
+    __m128i vb = qllr4_load(b + i);
+    // sign(a) * sign(b) * min(|a|, |b|)
+    __m128i minabs = qllr4_min(qllr4_abs(va), qllr4_abs(vb));
+    __m128i s = _mm_srai_epi32(_mm_xor_si128(va, vb), 31);
+    __m128i r = _mm_sub_epi32(_mm_xor_si128(minabs, s), s);
+    // + f(|a+b|) - f(|a-b|)
+    r = _mm_add_epi32(r, qllr4_lookup(table, qllr4_abs(_mm_add_epi32(va, vb)),
+                                      Dint3, Dint2));
+    r = _mm_sub_epi32(r, qllr4_lookup(table, qllr4_abs(_mm_sub_epi32(va, vb)),
+                                      Dint3, Dint2));
+    qllr4_store(out + i, qllr4_max(qllr4_min(r, qmax), qmin));
+  }
+#endif
+  for (; i < n; i++)
+    out[i] = Boxplus(a[i], b[i]);
+}
+
+void LLR_calc_unit::jaclog(const QLLRvec &a, const QLLRvec &b,
+                           QLLRvec &out) const
+{
+  it_assert_debug(a.size() == b.size(), "LLR_calc_unit::jaclog(): "
+                  "Vector sizes do not match");
+  out.set_size(a.size());
+  jaclog(a._data(), b._data(), out._data(), a.size());
+}
+
+void LLR_calc_unit::jaclog(const QLLR *a, const QLLR *b, QLLR *out,
+                           int n) const
+{
+  int i = 0;
+#if defined(__SSE2__)
+  const int *table = logexp_table._data();
+  const __m128i qmax = _mm_set1_epi32(QLLR_MAX);
+  for (; i + 4 <= n; i += 4) {
+    __m128i va = qllr4_load(a + i);
+    __m128i vb = qllr4_load(b + i);
+    __m128i maxab = qllr4_max(va, vb);
+    __m128i r = _mm_add_epi32(maxab, qllr4_lookup(table,
+                              qllr4_abs(_mm_sub_epi32(va, vb)), Dint3, Dint2));
+    // maxab >= QLLR_MAX saturates
+    __m128i sat = _mm_cmpgt_epi32(maxab, _mm_sub_epi32(qmax, _mm_set1_epi32(1)));
+    qllr4_store(out + i, qllr4_select(sat, r, qmax));
+  }
+#endif
+  for (; i < n; i++)
+    out[i] = jaclog(a[i], b[i]);
+}
+
+void LLR_calc_unit::min_sum_update(const QLLR *l, int k, QLLR *min1,
+                                   QLLR *min2, int *min_pos, int *sign, int n)
+{
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128i vk = _mm_set1_epi32(k);
+  for (; i + 4 <= n; i += 4) {
+    __m128i a = qllr4_load(l + i);
+    __m128i m1 = qllr4_load(min1 + i);
+    __m128i m2 = qllr4_load(min2 + i);
+    qllr4_store(sign + i, _mm_xor_si128(qllr4_load(sign + i),
+                                        _mm_srli_epi32(a, 31)));
+    a = qllr4_abs(a);
+    __m128i lt1 = _mm_cmpgt_epi32(m1, a);
+    __m128i lt2 = _mm_cmpgt_epi32(m2, a);
+    qllr4_store(min2 + i, qllr4_select(lt1, qllr4_select(lt2, m2, a), m1));
+    qllr4_store(min1 + i, qllr4_select(lt1, m1, a));
+    qllr4_store(min_pos + i, qllr4_select(lt1, qllr4_load(min_pos + i), vk));
+  }
+#endif
+  for (; i < n; i++) {
+    QLLR a = l[i];
+    if (a < 0) {
+      sign[i] ^= 1;
+      a = -a;
+    }
+    if (a < min1[i]) {
+      min2[i] = min1[i];
+      min1[i] = a;
+      min_pos[i] = k;
+    }
+    else if (a < min2[i]) {
+      min2[i] = a;
+    }
+  }
+}
+
+void LLR_calc_unit::min_sum_reduce(const QLLRvec &l, QLLR &min1, QLLR &min2,
+                                   int &min_pos, int &sign)
+{
+  const int n = l.size();
+  const QLLR *p = l._data();
+  min1 = QLLR_MAX;
+  min2 = QLLR_MAX;
+  min_pos = 0;
+  sign = 0;
+  int i = 0;
+
+  // four interleaved reductions, element 4*k+j going to lane j
+  const int nl = 4;
+  if (n >= 2 * nl) {
+    QLLR m1[nl], m2[nl];
+    int pos[nl], sgn[nl];
+    for (int j = 0; j < nl; j++) {
+      m1[j] = QLLR_MAX;
+      m2[j] = QLLR_MAX;
+      pos[j] = 0;
+      sgn[j] = 0;
+    }
+    for (; i + nl <= n; i += nl)
+      min_sum_update(p + i, i, m1, m2, pos, sgn, nl);
+    // merge the lanes; the first lane holding the smallest minimum at
+    // the lowest index wins
+    int best = 0;
+    for (int j = 0; j < nl; j++) {
+      sign ^= sgn[j];
+      if (m1[j] < m1[best] || (m1[j] == m1[best] && pos[j] + j < pos[best] + best))
+        best = j;
+    }
+    min1 = m1[best];
+    min_pos = pos[best] + best;
+    min2 = m2[best];
+    for (int j = 0; j < nl; j++) {
+      if (j != best && m1[j] < min2)
+        min2 = m1[j];
+    }
+  }
+
+  for (; i < n; i++)
+    min_sum_update(p + i, i, &min1, &min2, &min_pos, &sign, 1);
+}
+
 std::ostream &operator<<(std::ostream &os, const LLR_calc_unit &lcu)
 {
   os << "---------- LLR calculation unit -----------------" << std::endl;
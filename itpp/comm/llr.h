@@ -191,6 +191,20 @@ public:
   // Note: a version of this function taking "double" values as input
   // is deliberately omitted, because this is rather slow.
 
+  /*!
+   * \brief Element-wise Jacobian logarithm of two vectors.
+   *
+   * Computes <tt>out(i) = jaclog(a(i), b(i))</tt>, see Boxplus() for
+   * the vector implementation. \c out is resized if needed.
+   */
+  void jaclog(const QLLRvec &a, const QLLRvec &b, QLLRvec &out) const;
+
+  /*!
+   * \brief Element-wise Jacobian logarithm of \c n values stored at \c a
+   * and \c b. \c out may be equal to \c a or \c b.
+   */
+  void jaclog(const QLLR *a, const QLLR *b, QLLR *out, int n) const;
+
   /*!
    * \brief Hagenauer's "Boxplus" operator.
    *
@@ -201,6 +215,24 @@ public:
    */
   QLLR Boxplus(QLLR a, QLLR b) const;
 
+  /*!
+   * \brief Element-wise "Boxplus" of two vectors.
+   *
+   * Computes <tt>out(i) = Boxplus(a(i), b(i))</tt> with the same result
+   * as the scalar function, several elements at a time when SSE2 is
+   * available. The table lookups are done per element (or with gathers
+   * when AVX2 is available). \c out is resized if needed.
+   */
+  void Boxplus(const QLLRvec &a, const QLLRvec &b, QLLRvec &out) const;
+
+  /*!
+   * \brief Element-wise "Boxplus" of \c n values stored at \c a and \c b.
+   *
+   * Raw memory version of the above, meant for the inner loops of
+   * decoders. \c out may be equal to \c a or \c b.
+   */
+  void Boxplus(const QLLR *a, const QLLR *b, QLLR *out, int n) const;
+
   /*!
    * \brief Logexp operator.
    *
@@ -208,6 +240,31 @@ public:
    */
   inline QLLR logexp(QLLR x) const;
 
+  /*!
+   * \brief Smallest and second smallest magnitude of a vector of LLRs.
+   *
+   * This is the reduction used by the min-sum check node update:
+   * \c min1 and \c min2 are the two smallest values of |l(i)| (equal
+   * if the minimum occurs twice), \c min_pos is the first index where
+   * |l(i)| equals \c min1 and \c sign is 1 if an odd number of elements
+   * are negative, 0 otherwise. For an empty vector \c min1 and \c min2
+   * are QLLR_MAX.
+   */
+  static void min_sum_reduce(const QLLRvec &l, QLLR &min1, QLLR &min2,
+                             int &min_pos, int &sign);
+
+  /*!
+   * \brief Running min/second-min update over \c n independent lanes.
+   *
+   * Folds the k-th message of each lane, \c l[i], into the state
+   * (\c min1[i], \c min2[i], \c min_pos[i], \c sign[i]) of that lane, in
+   * the same way as min_sum_reduce(). Calling this for k = 0, 1, ...
+   * after setting \c min1 and \c min2 to QLLR_MAX and \c min_pos and
+   * \c sign to zero performs \c n check node reductions at once.
+   */
+  static void min_sum_update(const QLLR *l, int k, QLLR *min1, QLLR *min2,
+                             int *min_pos, int *sign, int n);
+
   //! Retrieve the table resolution values
   ivec get_Dint();
 
@@ -218,7 +275,7 @@ private:
   //! Compute the table for \f[ f(x) = \log(1+\exp(-x)) \f]
   ivec construct_logexp_table();
 
-  //! The lookup tables for the decoder
+  //! The lookup tables for the decoder (with a trailing zero entry)
   ivec logexp_table;
 
   //! Decoder (lookup-table) parameters
@@ -35,6 +35,65 @@
 namespace itpp
 {
 
+//! \cond
+
+/*
+  Soft bits of one Gray-mapped PAM dimension with L = 2^nb levels
+  x_j = L-1-2j, whose bits are row j of graycode(nb). The received value u
+  is in the same units and gain is 1/N0 in these units. Bit p (counted from
+  the LSB) of the Gray code of j is ((j + 2^p) >> (p + 1)) & 1, so it flips
+  between the levels j-1 and j when j = 2^p modulo 2^(p+1). The max-log
+  LLRs therefore only need the nearest level and the nearest levels with
+  the other bit value on both sides. The log-MAP LLRs use all L levels.
+*/
+static void pam_soft_bits(double u, double gain, int nb, Soft_Method method,
+                          double *metric, double *soft_bits)
+{
+  int L = 1 << nb;
+  if (method == LOGMAP) {
+    // metrics relative to the nearest level, so they cannot all underflow
+    double d_min = std::numeric_limits<double>::max();
+    for (int j = 0; j < L; j++) {
+      metric[j] = sqr(u - (L - 1 - 2 * j)) * gain;
+      d_min = std::min(d_min, metric[j]);
+    }
+    for (int j = 0; j < L; j++) {
+      metric[j] = std::exp(d_min - metric[j]);
+    }
+    for (int i = 0; i < nb; i++) {
+      int p = nb - 1 - i;
+      double P0 = 0.0, P1 = 0.0;
+      for (int j = 0; j < L; j++) {
+        if (((j + (1 << p)) >> (p + 1)) & 1)
+          P1 += metric[j];
+        else
+          P0 += metric[j];
+      }
+      soft_bits[i] = trunc_log(P0) - trunc_log(P1);
+    }
+  }
+  else { // method == APPROX
+    int j = round_i(((L - 1) - u) / 2.0);
+    j = (j < 0) ? 0 : ((j > L - 1) ? L - 1 : j);
+    double d = sqr(u - (L - 1 - 2 * j));
+    for (int i = 0; i < nb; i++) {
+      int p = nb - 1 - i, T = 2 << p;
+      int j_below = j - ((j + (1 << p)) & (T - 1)) - 1, j_above = j_below + 1 + T;
+      double d_other = std::numeric_limits<double>::max();
+      if (j_below >= 0)
+        d_other = sqr(u - (L - 1 - 2 * j_below));
+      if (j_above < L)
+        d_other = std::min(d_other, sqr(u - (L - 1 - 2 * j_above)));
+      if (((j + (1 << p)) >> (p + 1)) & 1)
+        soft_bits[i] = (d - d_other) * gain;
+      else
+        soft_bits[i] = (d_other - d) * gain;
+    }
+  }
+}
+
+//! \endcond
+
 
 // ----------------------------------------------------------------------
 // QAM
@@ -104,6 +163,68 @@ bvec QAM::demodulate_bits(const cvec &signal) const
   return out;
 }
 
+void QAM::demodulate_soft_bits(const cvec &rx_symbols, double N0,
+                               vec &soft_bits, Soft_Method method) const
+{
+  it_assert_debug(setup_done, "QAM::demodulate_soft_bits(): Modulator not ready.");
+  int nb = k / 2;
+  double gain = 1.0 / (sqr(scaling_factor) * N0);
+  vec metric(L);
+
+  soft_bits.set_size(k * rx_symbols.size());
+  for (int l = 0; l < rx_symbols.size(); l++) {
+    // the first k/2 bits select the imaginary part, the others the real one
+    pam_soft_bits(std::imag(rx_symbols(l)) * scaling_factor, gain, nb,
+                  method, metric._data(), soft_bits._data() + l * k);
+    pam_soft_bits(std::real(rx_symbols(l)) * scaling_factor, gain, nb,
+                  method, metric._data(), soft_bits._data() + l * k + nb);
+  }
+}
+
+vec QAM::demodulate_soft_bits(const cvec &rx_symbols, double N0,
+                              Soft_Method method) const
+{
+  vec output;
+  demodulate_soft_bits(rx_symbols, N0, output, method);
+  return output;
+}
+
+void QAM::demodulate_soft_bits(const cvec &rx_symbols, const cvec &channel,
+                               double N0, vec &soft_bits,
+                               Soft_Method method) const
+{
+  it_assert_debug(setup_done, "QAM::demodulate_soft_bits(): Modulator not ready.");
+  int nb = k / 2;
+  vec metric(L);
+
+  soft_bits.set_size(k * rx_symbols.size());
+  for (int l = 0; l < rx_symbols.size(); l++) {
+    // |r - c s|^2 = |c|^2 |r/c - s|^2
+    double energy = sqr(channel(l));
+    if (energy == 0.0) {
+      for (int i = 0; i < k; i++) {
+        soft_bits(l * k + i) = 0.0;
+      }
+      continue;
+    }
+    std::complex<double> z = rx_symbols(l) * std::conj(channel(l))
+                             * (scaling_factor / energy);
+    double gain = energy / (sqr(scaling_factor) * N0);
+    pam_soft_bits(std::imag(z), gain, nb, method, metric._data(),
+                  soft_bits._data() + l * k);
+    pam_soft_bits(std::real(z), gain, nb, method, metric._data(),
+                  soft_bits._data() + l * k + nb);
+  }
+}
+
+vec QAM::demodulate_soft_bits(const cvec &rx_symbols, const cvec &channel,
+                              double N0, Soft_Method method) const
+{
+  vec output;
+  demodulate_soft_bits(rx_symbols, channel, N0, output, method);
+  return output;
+}
+
 
 // ----------------------------------------------------------------------
 // PSK
@@ -431,43 +552,13 @@ void PAM_c::demodulate_soft_bits(const cvec &rx_symbols, double N0,
                                  vec &soft_bits, Soft_Method method) const
 {
   it_assert_debug(setup_done, "PAM_c::demodulate_soft_bits(): Modulator not ready.");
-  double P0, P1, d0min, d1min, temp;
+  double gain = 1.0 / (sqr(scaling_factor) * N0);
   vec metric(M);
 
   soft_bits.set_size(k * rx_symbols.size());
-
-  if (method == LOGMAP) {
-    for (int l = 0; l < rx_symbols.size(); l++) {
-      for (int j = 0; j < M; j++) {
-        metric(j) = std::exp(-sqr(std::real(rx_symbols(l) - symbols(j)))
-                             / N0);
-      }
-      for (int i = 0; i < k; i++) {
-        P0 = P1 = 0;
-        for (int j = 0; j < (M >> 1); j++) {
-          P0 += metric(S0(i, j));
-          P1 += metric(S1(i, j));
-        }
-        soft_bits(l*k + i) = trunc_log(P0) - trunc_log(P1);
-      }
-    }
-  }
-  else { // method == APPROX
-    for (int l = 0; l < rx_symbols.size(); l++) {
-      for (int j = 0; j < M; j++) {
-        metric(j) = sqr(std::real(rx_symbols(l) - symbols(j)));
-      }
-      for (int i = 0; i < k; i++) {
-        d0min = d1min = std::numeric_limits<double>::max();
-        for (int j = 0; j < (M >> 1); j++) {
-          temp = metric(S0(i, j));
-          if (temp < d0min) { d0min = temp; }
-          temp = metric(S1(i, j));
-          if (temp < d1min) { d1min = temp; }
-        }
-        soft_bits(l*k + i) = (-d0min + d1min) / N0;
-      }
-    }
+  for (int l = 0; l < rx_symbols.size(); l++) {
+    pam_soft_bits(std::real(rx_symbols(l)) * scaling_factor, gain, k, method,
+                  metric._data(), soft_bits._data() + l * k);
   }
 }
 
@@ -485,43 +576,23 @@ void PAM_c::demodulate_soft_bits(const cvec &rx_symbols, const cvec &channel,
                                  Soft_Method method) const
 {
   it_assert_debug(setup_done, "PAM_c::demodulate_soft_bits(): Modulator not ready.");
-  double P0, P1, d0min, d1min, temp;
   vec metric(M);
 
   soft_bits.set_size(k * rx_symbols.size());
-
-  if (method == LOGMAP) {
-    for (int l = 0; l < rx_symbols.size(); l++) {
-      for (int j = 0; j < M; j++) {
-        metric(j) = std::exp(-sqr(std::real(rx_symbols(l)
-                                            - channel(l) * symbols(j))) / N0);
-      }
+  for (int l = 0; l < rx_symbols.size(); l++) {
+    // the symbols are real, so |r - c s|^2 = |c|^2 (Re(r c^*) / |c|^2 - s)^2
+    // plus a term that does not depend on s
+    double energy = sqr(channel(l));
+    if (energy == 0.0) {
       for (int i = 0; i < k; i++) {
-        P0 = P1 = 0;
-        for (int j = 0; j < (M >> 1); j++) {
-          P0 += metric(S0(i, j));
-          P1 += metric(S1(i, j));
-        }
-        soft_bits(l*k + i) = trunc_log(P0) - trunc_log(P1);
-      }
-    }
-  }
-  else { // method == APPROX
-    for (int l = 0; l < rx_symbols.size(); l++) {
-      for (int j = 0; j < M; j++) {
-        metric(j) = sqr(std::real(rx_symbols(l) - channel(l) * symbols(j)));
-      }
-      for (int i = 0; i < k; i++) {
-        d0min = d1min = std::numeric_limits<double>::max();
-        for (int j = 0; j < (M >> 1); j++) {
-          temp = metric(S0(i, j));
-          if (temp < d0min) { d0min = temp; }
-          temp = metric(S1(i, j));
-          if (temp < d1min) { d1min = temp; }
-        }
-        soft_bits(l*k + i) = (-d0min + d1min) / N0;
+        soft_bits(l * k + i) = 0.0;
       }
+      continue;
     }
+    double z = std::real(rx_symbols(l) * std::conj(channel(l))) / energy;
+    double gain = energy / (sqr(scaling_factor) * N0);
+    pam_soft_bits(z * scaling_factor, gain, k, method, metric._data(),
+                  soft_bits._data() + l * k);
   }
 }
 
@@ -584,4 +655,57 @@ bvec PAM::demodulate_bits(const vec &signal) const
   return temp;
 }
 
+void PAM::demodulate_soft_bits(const vec &rx_symbols, double N0,
+                               vec &soft_bits, Soft_Method method) const
+{
+  it_assert_debug(setup_done, "PAM::demodulate_soft_bits(): Modulator not ready.");
+  double gain = 1.0 / (sqr(scaling_factor) * N0);
+  vec metric(M);
+
+  soft_bits.set_size(k * rx_symbols.size());
+  for (int l = 0; l < rx_symbols.size(); l++) {
+    pam_soft_bits(rx_symbols(l) * scaling_factor, gain, k, method,
+                  metric._data(), soft_bits._data() + l * k);
+  }
+}
+
+vec PAM::demodulate_soft_bits(const vec &rx_symbols, double N0,
+                              Soft_Method method) const
+{
+  vec output;
+  demodulate_soft_bits(rx_symbols, N0, output, method);
+  return output;
+}
+
+void PAM::demodulate_soft_bits(const vec &rx_symbols, const vec &channel,
+                               double N0, vec &soft_bits,
+                               Soft_Method method) const
+{
+  it_assert_debug(setup_done, "PAM::demodulate_soft_bits(): Modulator not ready.");
+  vec metric(M);
+
+  soft_bits.set_size(k * rx_symbols.size());
+  for (int l = 0; l < rx_symbols.size(); l++) {
+    // (r - c s)^2 = c^2 (r/c - s)^2
+    double c = channel(l);
+    if (c == 0.0) {
+      for (int i = 0; i < k; i++) {
+        soft_bits(l * k + i) = 0.0;
+      }
+      continue;
+    }
+    double gain = sqr(c) / (sqr(scaling_factor) * N0);
+    pam_soft_bits(rx_symbols(l) / c * scaling_factor, gain, k, method,
+                  metric._data(), soft_bits._data() + l * k);
+  }
+}
+
+vec PAM::demodulate_soft_bits(const vec &rx_symbols, const vec &channel,
+                              double N0, Soft_Method method) const
+{
+  vec output;
+  demodulate_soft_bits(rx_symbols, channel, N0, output, method);
+  return output;
+}
+
 } // namespace itpp
@@ -573,6 +573,12 @@ void Modulator<T>::calculate_softbit_matrices()
 
   It is also assumed that the channel estimates are perfect when
   calculating the soft bits.
+
+  Since the Gray mapping is separable, the soft bits are calculated
+  independently for the in-phase and quadrature components, each one
+  being a Gray-mapped \f$\sqrt{M}\f$-PAM. The approximate method only
+  needs the nearest levels for each bit, so its cost grows with \f$k\f$
+  instead of \f$M\f$.
 */
 class QAM : public Modulator<std::complex<double> >
 {
@@ -591,6 +597,23 @@ public:
   //! Hard demodulation of bits
   bvec demodulate_bits(const cvec& signal) const;
 
+  //! Soft demodulator for AWGN channels, computed per dimension
+  virtual void demodulate_soft_bits(const cvec& rx_symbols, double N0,
+                                    vec& soft_bits,
+                                    Soft_Method method = LOGMAP) const;
+  //! Soft demodulator for AWGN channels, computed per dimension
+  virtual vec demodulate_soft_bits(const cvec& rx_symbols, double N0,
+                                   Soft_Method method = LOGMAP) const;
+  //! Soft demodulator for known fading channels, computed per dimension
+  virtual void demodulate_soft_bits(const cvec& rx_symbols,
+                                    const cvec& channel, double N0,
+                                    vec& soft_bits,
+                                    Soft_Method method = LOGMAP) const;
+  //! Soft demodulator for known fading channels, computed per dimension
+  virtual vec demodulate_soft_bits(const cvec& rx_symbols,
+                                   const cvec& channel, double N0,
+                                   Soft_Method method = LOGMAP) const;
+
 protected:
   //! The square-root of M
   int L;
@@ -1109,6 +1132,23 @@ public:
   //! Hard demodulation of PAM symbols in complex domain to bits
   bvec demodulate_bits(const vec& signal) const;
 
+  //! Soft demodulator for AWGN channels (APPROX uses the nearest levels only)
+  virtual void demodulate_soft_bits(const vec& rx_symbols, double N0,
+                                    vec& soft_bits,
+                                    Soft_Method method = LOGMAP) const;
+  //! Soft demodulator for AWGN channels (APPROX uses the nearest levels only)
+  virtual vec demodulate_soft_bits(const vec& rx_symbols, double N0,
+                                   Soft_Method method = LOGMAP) const;
+  //! Soft demodulator for known fading channels (APPROX uses the nearest levels only)
+  virtual void demodulate_soft_bits(const vec& rx_symbols,
+                                    const vec& channel, double N0,
+                                    vec& soft_bits,
+                                    Soft_Method method = LOGMAP) const;
+  //! Soft demodulator for known fading channels (APPROX uses the nearest levels only)
+  virtual vec demodulate_soft_bits(const vec& rx_symbols,
+                                   const vec& channel, double N0,
+                                   Soft_Method method = LOGMAP) const;
+
 protected:
   //! Scaling factor used to normalize the average energy to 1
   double scaling_factor;
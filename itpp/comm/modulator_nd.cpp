@@ -31,8 +31,10 @@
 #include <itpp/base/algebra/cholesky.h>
 #include <itpp/base/algebra/inv.h>
 #include <itpp/base/math/elem_math.h>
+#include <itpp/base/math/min_max.h>
 #include <itpp/base/converters.h>
 #include <itpp/base/itcompat.h>
+#include <algorithm>
 
 namespace itpp
 {
@@ -121,6 +123,374 @@ void Modulator_ND::update_LLR(const Array<QLLRvec> &logP_apriori,
   }
 }
 
+//! \cond
+
+static inline double conj_nd(double x) { return x; }
+
+static inline std::complex<double> conj_nd(const std::complex<double> &x)
+{
+  return std::conj(x);
+}
+
+/*
+  Sorted QR decomposition H(:, perm) = Q R by modified Gram-Schmidt,
+  taking the remaining column with the least energy first (SQRD, Wubben
+  et al., 2001). The tree searches start from the last row of R, so the
+  strongest layers are detected first. Only R and z = Q^H y are returned.
+*/
+template<class T>
+static void sorted_qr(const Mat<T> &H, const Vec<T> &y, Mat<T> &R,
+                      Vec<T> &z, ivec &perm)
+{
+  int nr = H.rows();
+  int nt = H.cols();
+  Mat<T> Q(H);
+  vec energy(nt);
+  R.set_size(nt, nt);
+  R.zeros();
+  z.set_size(nt);
+  perm.set_size(nt);
+  for (int i = 0; i < nt; i++) {
+    perm(i) = i;
+    energy(i) = 0.0;
+    for (int p = 0; p < nr; p++) {
+      energy(i) += sqr(Q(p, i));
+    }
+  }
+
+  for (int i = 0; i < nt; i++) {
+    int m = i;
+    for (int l = i + 1; l < nt; l++) {
+      if (energy(l) < energy(m)) {
+        m = l;
+      }
+    }
+    if (m != i) {
+      Q.swap_cols(i, m);
+      R.swap_cols(i, m);
+      std::swap(energy(i), energy(m));
+      std::swap(perm(i), perm(m));
+    }
+
+    double norm = 0.0;
+    for (int p = 0; p < nr; p++) {
+      norm += sqr(Q(p, i));
+    }
+    norm = std::sqrt(norm);
+    it_assert(norm > 0.0, "sorted_qr(): The channel matrix is rank deficient");
+    R(i, i) = norm;
+    for (int p = 0; p < nr; p++) {
+      Q(p, i) /= norm;
+    }
+
+    for (int l = i + 1; l < nt; l++) {
+      T r = T(0);
+      for (int p = 0; p < nr; p++) {
+        r += conj_nd(Q(p, i)) * Q(p, l);
+      }
+      R(i, l) = r;
+      for (int p = 0; p < nr; p++) {
+        Q(p, l) -= r * Q(p, i);
+      }
+      energy(l) -= sqr(r);
+    }
+
+    T zi = T(0);
+    for (int p = 0; p < nr; p++) {
+      zi += conj_nd(Q(p, i)) * y(p);
+    }
+    z(i) = zi;
+  }
+}
+
+// Orders the candidate indices of the K-best search by their metrics
+class Metric_Less
+{
+public:
+  Metric_Less(const vec &metric_in): metric(metric_in) {}
+  bool operator()(int a, int b) const { return metric(a) < metric(b); }
+private:
+  const vec &metric;
+};
+
+//! \endcond
+
+void Modulator_ND::apriori_costs(const QLLRvec &LLR_apriori,
+                                 Array<vec> &cost) const
+{
+  // costs are relative to the most likely bit values, so they are >= 0
+  cost.set_size(nt);
+  int b = 0;
+  for (int j = 0; j < nt; j++) {
+    cost(j).set_size(M(j));
+    cost(j).zeros();
+    for (int i = 0; i < k(j); i++) {
+      double l = llrcalc.to_double(LLR_apriori(b + i));
+      for (int s = 0; s < M(j); s++) {
+        if (bitmap(j)(s, i) == 0) {
+          cost(j)(s) += (l < 0.0) ? -l : 0.0;
+        }
+        else {
+          cost(j)(s) += (l > 0.0) ? l : 0.0;
+        }
+      }
+    }
+    b += k(j);
+  }
+}
+
+template<class T>
+void Modulator_ND::sphere_maxlog(const Mat<T> &R, const Vec<T> &z,
+                                 const ivec &perm,
+                                 const Array<Vec<T> > &constellation,
+                                 double scale, const QLLRvec &LLR_apriori,
+                                 QLLRvec &LLR_aposteriori)
+{
+  int np = sum(k); // number of bits in total
+  it_assert(length(LLR_apriori) == np,
+            "Modulator_ND::sphere_maxlog(): Wrong sizes");
+
+  Array<vec> cost;
+  apriori_costs(LLR_apriori, cost);
+  ivec offset(nt);
+  offset(0) = 0;
+  for (int j = 1; j < nt; j++) {
+    offset(j) = offset(j - 1) + k(j - 1);
+  }
+
+  // the tree levels are indexed as the rows of R, the root is level nt-1
+  ivec s(nt);               // symbol chosen at each level
+  ivec s_ml(nt);            // best leaf found so far
+  vec ped(nt + 1);          // partial metrics of the levels above
+  Array<vec> inc(nt);       // metric increments of the children
+  Array<ivec> order(nt);    // children sorted by their increments
+  ivec pos(nt);             // current child at each level
+  vec lambda_bar(np);       // metrics of the counter-hypotheses
+  double lambda_ml = std::numeric_limits<double>::max();
+  bool found = false;
+  lambda_bar = std::numeric_limits<double>::max();
+  ped(nt) = 0.0;
+
+  int i = nt - 1;
+  bool enter = true;
+  while (true) {
+    int d = perm(i);
+    if (enter) {
+      // interference of the decided levels and the sorted children
+      T b = z(i);
+      for (int l = i + 1; l < nt; l++) {
+        b -= R(i, l) * constellation(perm(l))(s(l));
+      }
+      inc(i).set_size(M(d));
+      order(i).set_size(M(d));
+      for (int j = 0; j < M(d); j++) {
+        inc(i)(j) = scale * sqr(b - R(i, i) * constellation(d)(j))
+                    + cost(d)(j);
+        int q = j;
+        while ((q > 0) && (inc(i)(order(i)(q - 1)) > inc(i)(j))) {
+          order(i)(q) = order(i)(q - 1);
+          q--;
+        }
+        order(i)(q) = j;
+      }
+      pos(i) = 0;
+      enter = false;
+    }
+
+    if (pos(i) == M(d)) {
+      if (++i == nt) {
+        break;
+      }
+      pos(i)++;
+      continue;
+    }
+
+    int j = order(i)(pos(i));
+    double metric = ped(i + 1) + inc(i)(j);
+    s(i) = j;
+
+    if (found) {
+      // A leaf below this node can only improve the ML metric or the
+      // counter-hypotheses of the bits that may differ from the ML
+      // solution. The radius of the node is the largest of those.
+      double r_rest = 0.0, r_level = 0.0, r_node = 0.0;
+      for (int l = 0; l < nt; l++) {
+        int dl = perm(l);
+        for (int q = 0; q < k(dl); q++) {
+          double lb = lambda_bar(offset(dl) + q);
+          if (l < i) {
+            r_rest = std::max(r_rest, lb);
+          }
+          else if (l == i) {
+            r_level = std::max(r_level, lb);
+            if (bitmap(dl)(j, q) != bitmap(dl)(s_ml(l), q)) {
+              r_node = std::max(r_node, lb);
+            }
+          }
+          else if (bitmap(dl)(s(l), q) != bitmap(dl)(s_ml(l), q)) {
+            r_rest = std::max(r_rest, lb);
+          }
+        }
+      }
+      if (metric >= std::max(r_rest, r_level)) {
+        // the remaining children have larger metrics
+        pos(i) = M(d);
+        continue;
+      }
+      if (metric >= std::max(r_rest, r_node)) {
+        pos(i)++;
+        continue;
+      }
+    }
+
+    if (i > 0) {
+      ped(i) = metric;
+      i--;
+      enter = true;
+      continue;
+    }
+
+    // leaf node
+    if (!found || (metric < lambda_ml)) {
+      if (found) {
+        // the old ML solution is the best counter-hypothesis of the bits
+        // in which the new one differs
+        for (int l = 0; l < nt; l++) {
+          int dl = perm(l);
+          for (int q = 0; q < k(dl); q++) {
+            if (bitmap(dl)(s(l), q) != bitmap(dl)(s_ml(l), q)) {
+              lambda_bar(offset(dl) + q) = lambda_ml;
+            }
+          }
+        }
+      }
+      s_ml = s;
+      lambda_ml = metric;
+      found = true;
+    }
+    else {
+      for (int l = 0; l < nt; l++) {
+        int dl = perm(l);
+        for (int q = 0; q < k(dl); q++) {
+          if (bitmap(dl)(s(l), q) != bitmap(dl)(s_ml(l), q)) {
+            double &lb = lambda_bar(offset(dl) + q);
+            lb = std::min(lb, metric);
+          }
+        }
+      }
+    }
+    for (int b = 0; b < np; b++) {
+      lambda_bar(b) = std::min(lambda_bar(b), lambda_ml + llr_clip);
+    }
+    pos(0)++;
+  }
+
+  LLR_aposteriori.set_size(np);
+  for (int l = 0; l < nt; l++) {
+    int dl = perm(l);
+    for (int q = 0; q < k(dl); q++) {
+      double llr = lambda_bar(offset(dl) + q) - lambda_ml;
+      if (bitmap(dl)(s_ml(l), q) == 1) {
+        llr = -llr;
+      }
+      LLR_aposteriori(offset(dl) + q) = llrcalc.to_qllr(llr);
+    }
+  }
+}
+
+template<class T>
+void Modulator_ND::kbest_maxlog(const Mat<T> &R, const Vec<T> &z,
+                                const ivec &perm,
+                                const Array<Vec<T> > &constellation,
+                                double scale, const QLLRvec &LLR_apriori,
+                                QLLRvec &LLR_aposteriori)
+{
+  int np = sum(k); // number of bits in total
+  it_assert(length(LLR_apriori) == np,
+            "Modulator_ND::kbest_maxlog(): Wrong sizes");
+
+  Array<vec> cost;
+  apriori_costs(LLR_apriori, cost);
+  ivec offset(nt);
+  offset(0) = 0;
+  for (int j = 1; j < nt; j++) {
+    offset(j) = offset(j - 1) + k(j - 1);
+  }
+
+  // survivors (rows) with the symbols of the tree levels (columns)
+  int K = kbest_size;
+  int n_children = K * max(M);
+  imat survivors(K, nt), next(K, nt);
+  vec metric(K), child_metric(n_children);
+  ivec child_parent(n_children), child_symbol(n_children);
+  ivec index(n_children);
+  int count = 1;
+  metric(0) = 0.0;
+
+  for (int i = nt - 1; i >= 0; i--) {
+    int d = perm(i);
+    int n = 0;
+    for (int p = 0; p < count; p++) {
+      T b = z(i);
+      for (int l = i + 1; l < nt; l++) {
+        b -= R(i, l) * constellation(perm(l))(survivors(p, l));
+      }
+      for (int j = 0; j < M(d); j++) {
+        child_metric(n) = metric(p) + scale
+                          * sqr(b - R(i, i) * constellation(d)(j)) + cost(d)(j);
+        child_parent(n) = p;
+        child_symbol(n) = j;
+        index(n) = n;
+        n++;
+      }
+    }
+
+    int keep = std::min(K, n);
+    std::partial_sort(index._data(), index._data() + keep, index._data() + n,
+                      Metric_Less(child_metric));
+    for (int q = 0; q < keep; q++) {
+      int c = index(q);
+      for (int l = i + 1; l < nt; l++) {
+        next(q, l) = survivors(child_parent(c), l);
+      }
+      next(q, i) = child_symbol(c);
+      metric(q) = child_metric(c);
+    }
+    survivors = next;
+    count = keep;
+  }
+
+  // best metrics in the list with the bits equal to 0 and 1
+  vec best0(np), best1(np);
+  best0 = std::numeric_limits<double>::max();
+  best1 = std::numeric_limits<double>::max();
+  for (int p = 0; p < count; p++) {
+    for (int l = 0; l < nt; l++) {
+      int dl = perm(l);
+      for (int q = 0; q < k(dl); q++) {
+        double &best = (bitmap(dl)(survivors(p, l), q) == 0)
+                       ? best0(offset(dl) + q) : best1(offset(dl) + q);
+        best = std::min(best, metric(p));
+      }
+    }
+  }
+
+  LLR_aposteriori.set_size(np);
+  for (int b = 0; b < np; b++) {
+    double llr;
+    if (best1(b) == std::numeric_limits<double>::max()) {
+      llr = llr_clip;
+    }
+    else if (best0(b) == std::numeric_limits<double>::max()) {
+      llr = -llr_clip;
+    }
+    else {
+      llr = std::max(-llr_clip, std::min(llr_clip, best1(b) - best0(b)));
+    }
+    LLR_aposteriori(b) = llrcalc.to_qllr(llr);
+  }
+}
+
 // ----------------------------------------------------------------------
 // Modulator_NRD
 // ----------------------------------------------------------------------
@@ -186,6 +556,26 @@ void Modulator_NRD::demodulate_soft_bits(const vec &y, const mat &H,
     demodulate_soft_bits(shat, h, 1.0, zeros_i(sum(k)), LLR_aposteriori);
   }
   break;
+  case SPHERE_MAXLOG:
+  case KBEST_MAXLOG: {
+    it_assert((H.rows() == length(y)) && (H.cols() == nt),
+              "Modulator_NRD::demodulate_soft_bits(): Wrong sizes");
+    it_assert(H.rows() >= H.cols(), "Modulator_NRD::demodulate_soft_bits():"
+              " tree search impossible for undetermined systems");
+    mat R;
+    vec z;
+    ivec perm;
+    sorted_qr(H, y, R, z, perm);
+    if (method == SPHERE_MAXLOG) {
+      sphere_maxlog(R, z, perm, symbols, 1.0 / (2.0 * sigma2), LLR_apriori,
+                    LLR_aposteriori);
+    }
+    else {
+      kbest_maxlog(R, z, perm, symbols, 1.0 / (2.0 * sigma2), LLR_apriori,
+                   LLR_aposteriori);
+    }
+  }
+  break;
   default:
     it_error("Modulator_NRD::demodulate_soft_bits(): Improper soft "
              "demodulation method");
@@ -417,6 +807,26 @@ void Modulator_NCD::demodulate_soft_bits(const cvec &y, const cmat &H,
     demodulate_soft_bits(shat, h, 1.0, zeros_i(sum(k)), LLR_aposteriori);
   }
   break;
+  case SPHERE_MAXLOG:
+  case KBEST_MAXLOG: {
+    it_assert((H.rows() == length(y)) && (H.cols() == nt),
+              "Modulator_NCD::demodulate_soft_bits(): Wrong sizes");
+    it_assert(H.rows() >= H.cols(), "Modulator_NCD::demodulate_soft_bits():"
+              " tree search impossible for undetermined systems");
+    cmat R;
+    cvec z;
+    ivec perm;
+    sorted_qr(H, y, R, z, perm);
+    if (method == SPHERE_MAXLOG) {
+      sphere_maxlog(R, z, perm, symbols, 1.0 / sigma2, LLR_apriori,
+                    LLR_aposteriori);
+    }
+    else {
+      kbest_maxlog(R, z, perm, symbols, 1.0 / sigma2, LLR_apriori,
+                   LLR_aposteriori);
+    }
+  }
+  break;
   default:
     it_error("Modulator_NCD::demodulate_soft_bits(): Improper soft "
              "demodulation method");
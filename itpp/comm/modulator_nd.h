@@ -66,12 +66,16 @@ public:
     //! Log-MAP demodulation by "brute-force" enumeration of all points
     FULL_ENUM_LOGMAP,
     //! Zero-Forcing Log-MAP approximated demodulation
-    ZF_LOGMAP
+    ZF_LOGMAP,
+    //! Max-log demodulation by single tree search sphere decoding
+    SPHERE_MAXLOG,
+    //! Max-log demodulation over the survivors of a K-best tree search
+    KBEST_MAXLOG
   };
 
   //! Default constructor
   Modulator_ND(LLR_calc_unit llrcalc_in = LLR_calc_unit()):
-      llrcalc(llrcalc_in) {}
+      llrcalc(llrcalc_in), llr_clip(8.0), kbest_size(16) {}
   //! Destructor
   virtual ~Modulator_ND() {}
 
@@ -81,6 +85,32 @@ public:
   //! Get LLR calculation unit
   LLR_calc_unit get_llrcalc() const { return llrcalc; }
 
+  /*!
+   * \brief Set the LLR clipping level of the tree search methods
+   *
+   * \c SPHERE_MAXLOG and \c KBEST_MAXLOG limit the magnitude of the
+   * output LLRs to \c clip (natural logarithm units, default 8). In the
+   * sphere decoder the clipping also bounds the search radius, so a
+   * smaller value prunes more of the tree.
+   */
+  void set_llr_clipping(double clip) {
+    it_assert(clip > 0, "Modulator_ND::set_llr_clipping(): Clipping level "
+              "must be positive");
+    llr_clip = clip;
+  }
+
+  //! Get the LLR clipping level of the tree search methods
+  double get_llr_clipping() const { return llr_clip; }
+
+  //! Set the number of survivors per level of \c KBEST_MAXLOG (default 16)
+  void set_kbest_size(int K) {
+    it_assert(K > 0, "Modulator_ND::set_kbest_size(): K must be positive");
+    kbest_size = K;
+  }
+
+  //! Get the number of survivors per level of \c KBEST_MAXLOG
+  int get_kbest_size() const { return kbest_size; }
+
   //! Get number of dimensions
   int get_dim() const { return nt; }
 
@@ -112,6 +142,10 @@ protected:
   Array<bmat> bitmap;
   //! Bit pattern in decimal form ordered and the corresponding symbols (one pattern per dimension)
   Array<ivec> bits2symbols;
+  //! LLR clipping level of the tree search methods
+  double llr_clip;
+  //! Number of survivors per level of the K-best search
+  int kbest_size;
 
   //! Convert LLR to log-probabilities
   QLLRvec probabilities(QLLR l); // some abuse of what QLLR stands for...
@@ -161,6 +195,44 @@ protected:
   */
   void update_LLR(const Array<QLLRvec> &logP_apriori, int s,
                   QLLR scaled_norm, int j, QLLRvec &num, QLLRvec &denom);
+
+  //! Max-log cost of each symbol given the a priori LLRs (for internal use)
+  void apriori_costs(const QLLRvec &LLR_apriori, Array<vec> &cost) const;
+
+  /*!
+   * \brief Single tree search sphere decoder (for internal use)
+   *
+   * Computes clipped max-log LLRs from the triangular system \f$z = Rs +
+   * e\f$ obtained by a QR decomposition of the channel matrix. Level
+   * \f$i\f$ of the tree is dimension \c perm(i). The counter-hypothesis
+   * metrics are found in the same depth-first Schnorr-Euchner search as
+   * the ML solution, following Studer et al. (IEEE JSAC, 2008).
+   *
+   * \param[in]   R                Upper triangular matrix
+   * \param[in]   z                Rotated received vector
+   * \param[in]   perm             Dimension detected at each tree level
+   * \param[in]   constellation    Modulation symbols per dimension
+   * \param[in]   scale            Inverse of the noise variance term
+   * \param[in]   LLR_apriori      Vector of a priori LLR values per bit
+   * \param[out]  LLR_aposteriori  Vector of a posteriori LLR values
+   */
+  template<class T>
+  void sphere_maxlog(const Mat<T> &R, const Vec<T> &z, const ivec &perm,
+                     const Array<Vec<T> > &constellation, double scale,
+                     const QLLRvec &LLR_apriori, QLLRvec &LLR_aposteriori);
+
+  /*!
+   * \brief K-best breadth-first tree search (for internal use)
+   *
+   * Keeps the \c kbest_size best partial vectors at each tree level and
+   * computes the max-log LLRs over the final list. Bits without a
+   * counter-hypothesis in the list get the clipping level. The arguments
+   * are the same as for \c sphere_maxlog().
+   */
+  template<class T>
+  void kbest_maxlog(const Mat<T> &R, const Vec<T> &z, const ivec &perm,
+                    const Array<Vec<T> > &constellation, double scale,
+                    const QLLRvec &LLR_apriori, QLLRvec &LLR_aposteriori);
 };
 
 
@@ -215,12 +287,21 @@ public:
   /*!
    * \brief Soft demodulation wrapper function for various methods
    *
-   * Currently the following two demodulation methods are supported:
+   * Currently the following demodulation methods are supported:
    * - FULL_ENUM_LOGMAP - exact demodulation, which use "brute-force"
    *   enumeration of all constellation points
    * - ZF_LOGMAP - approximated methods with Zero-Forcing preprocessing,
    *   which sometimes tends to perform poorly, especially for poorly
    *   conditioned H
+   * - SPHERE_MAXLOG - exact max-log demodulation by a single tree search
+   *   sphere decoder, with the LLRs clipped at \c get_llr_clipping()
+   * - KBEST_MAXLOG - max-log demodulation over the list found by a
+   *   K-best search with \c get_kbest_size() survivors per level
+   *
+   * Both tree search methods use a sorted QR decomposition of H and
+   * require \f$n_r \geq n_t\f$. Unlike \c FULL_ENUM_LOGMAP, their
+   * complexity does not grow exponentially with the number of dimensions
+   * at useful SNRs.
    *
    * \param[in]   y                Received vector
    * \param[in]   H                Channel matrix
@@ -238,12 +319,21 @@ public:
   /*!
    * \brief Soft demodulation wrapper function for various methods
    *
-   * Currently the following two demodulation methods are supported:
+   * Currently the following demodulation methods are supported:
    * - FULL_ENUM_LOGMAP - exact demodulation, which use "brute-force"
    *   enumeration of all constellation points
    * - ZF_LOGMAP - approximated methods with Zero-Forcing preprocessing,
    *   which sometimes tends to perform poorly, especially for poorly
    *   conditioned H
+   * - SPHERE_MAXLOG - exact max-log demodulation by a single tree search
+   *   sphere decoder, with the LLRs clipped at \c get_llr_clipping()
+   * - KBEST_MAXLOG - max-log demodulation over the list found by a
+   *   K-best search with \c get_kbest_size() survivors per level
+   *
+   * Both tree search methods use a sorted QR decomposition of H and
+   * require \f$n_r \geq n_t\f$. Unlike \c FULL_ENUM_LOGMAP, their
+   * complexity does not grow exponentially with the number of dimensions
+   * at useful SNRs.
    *
    * \param[in]   y                Received vector
    * \param[in]   H                Channel matrix
@@ -371,12 +461,21 @@ public:
   /*!
    * \brief Soft demodulation wrapper function for various methods
    *
-   * Currently the following two demodulation methods are supported:
+   * Currently the following demodulation methods are supported:
    * - FULL_ENUM_LOGMAP - exact demodulation, which use "brute-force"
    *   enumeration of all constellation points
    * - ZF_LOGMAP - approximated methods with Zero-Forcing preprocessing,
    *   which sometimes tends to perform poorly, especially for poorly
    *   conditioned H
+   * - SPHERE_MAXLOG - exact max-log demodulation by a single tree search
+   *   sphere decoder, with the LLRs clipped at \c get_llr_clipping()
+   * - KBEST_MAXLOG - max-log demodulation over the list found by a
+   *   K-best search with \c get_kbest_size() survivors per level
+   *
+   * Both tree search methods use a sorted QR decomposition of H and
+   * require \f$n_r \geq n_t\f$. Unlike \c FULL_ENUM_LOGMAP, their
+   * complexity does not grow exponentially with the number of dimensions
+   * at useful SNRs.
    *
    * \param[in]   y                Received vector
    * \param[in]   H                Channel matrix
@@ -395,12 +494,21 @@ public:
   /*!
    * \brief Soft demodulation wrapper function for various methods
    *
-   * Currently the following two demodulation methods are supported:
+   * Currently the following demodulation methods are supported:
    * - FULL_ENUM_LOGMAP - exact demodulation, which use "brute-force"
    *   enumeration of all constellation points
    * - ZF_LOGMAP - approximated methods with Zero-Forcing preprocessing,
    *   which sometimes tends to perform poorly, especially for poorly
    *   conditioned H
+   * - SPHERE_MAXLOG - exact max-log demodulation by a single tree search
+   *   sphere decoder, with the LLRs clipped at \c get_llr_clipping()
+   * - KBEST_MAXLOG - max-log demodulation over the list found by a
+   *   K-best search with \c get_kbest_size() survivors per level
+   *
+   * Both tree search methods use a sorted QR decomposition of H and
+   * require \f$n_r \geq n_t\f$. Unlike \c FULL_ENUM_LOGMAP, their
+   * complexity does not grow exponentially with the number of dimensions
+   * at useful SNRs.
    *
    * \param[in]   y                Received vector
    * \param[in]   H                Channel matrix
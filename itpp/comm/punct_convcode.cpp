@@ -115,6 +115,19 @@ void Punctured_Convolutional_Code::weight_reverse(int state, int &w0, int &w1, i
   }
 }
 
+void Punctured_Convolutional_Code::branch_weights(imat &branch_weight, bool reverse)
+{
+  branch_weight.set_size(1 << m, 2 * Period, false);
+  for (int t = 0; t < Period; t++) {
+    for (int s = 0; s < (1 << m); s++) {
+      if (reverse)
+        weight_reverse(s, branch_weight(s, 2 * t), branch_weight(s, 2 * t + 1), t);
+      else
+        weight(s, branch_weight(s, 2 * t), branch_weight(s, 2 * t + 1), t);
+    }
+  }
+}
+
 //------- Public functions -----------------------
 
 void Punctured_Convolutional_Code::set_puncture_matrix(const bmat &pmatrix)
@@ -394,6 +407,55 @@ void Punctured_Convolutional_Code::decode_tailbite(const vec &received_signal, b
 }
 
 
+void Punctured_Convolutional_Code::decode_stream(const vec &received_signal,
+    bvec &output)
+{
+  if (stream_metric.size() == 0) { // a new stream
+    stream_punct_pos = 0;
+  }
+  int period_size = n * Period;
+  vec temp(received_signal.size() * period_size);
+  int nn = 0;
+
+  for (int i = 0; i < received_signal.size(); i++) {
+    // insert dummy symbols with the same contribution for 0 and 1
+    while (puncture_matrix(stream_punct_pos % n, stream_punct_pos / n)
+           == bin(0)) {
+      temp(nn++) = 0;
+      stream_punct_pos = (stream_punct_pos + 1) % period_size;
+    }
+    temp(nn++) = received_signal(i);
+    stream_punct_pos = (stream_punct_pos + 1) % period_size;
+  }
+  temp.set_size(nn, true);
+
+  Convolutional_Code::decode_stream(temp, output);
+}
+
+void Punctured_Convolutional_Code::flush_stream(bvec &output)
+{
+  // complete the last code symbol if only punctured symbols are missing
+  bvec last_bits;
+  if (stream_metric.size() != 0) {
+    int period_size = n * Period;
+    vec temp(n);
+    int nn = 0;
+    while ((stream_punct_pos % n != 0)
+           && (puncture_matrix(stream_punct_pos % n, stream_punct_pos / n)
+               == bin(0))) {
+      temp(nn++) = 0;
+      stream_punct_pos = (stream_punct_pos + 1) % period_size;
+    }
+    if (nn > 0) {
+      Convolutional_Code::decode_stream(temp.left(nn), last_bits);
+    }
+  }
+  Convolutional_Code::flush_stream(output);
+  output = concat(last_bits, output);
+  stream_punct_pos = 0;
+}
+
+
 /*
   Calculate the inverse sequence
 
@@ -633,16 +695,16 @@ int Punctured_Convolutional_Code::fast(Array<ivec> &spectrum, int start_time, in
   int W = d - dist_prof_rev0;
   t = 1;
 
+  // branch weights of the code that is searched backwards
+  imat branch_weight;
+  branch_weights(branch_weight, !reverse);
+
 F2:
   S0 = next_state(S, 0);
   S1 = next_state(S, 1);
 
-  if (reverse) {
-    weight(S, w0, w1, (start_time + t) % Period);
-  }
-  else {
-    weight_reverse(S, w0, w1, (start_time + t) % Period);
-  }
+  w0 = branch_weight(S, 2 * ((start_time + t) % Period));
+  w1 = branch_weight(S, 2 * ((start_time + t) % Period) + 1);
   W0 = W - w0;
   W1 = W - w1;
 
@@ -731,24 +793,43 @@ end:
   return 1;
 }
 
-void Punctured_Convolutional_Code::calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms)
+bool Punctured_Convolutional_Code::calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms)
 {
-  Array<ivec> temp_spectra(2);
   spectrum.set_size(2);
   spectrum(0).set_size(dmax + no_terms, false);
   spectrum(1).set_size(dmax + no_terms, false);
   spectrum(0).zeros();
   spectrum(1).zeros();
 
-  for (int pos = 0; pos < Period; pos++) {
-    calculate_spectrum(temp_spectra, pos, dmax, no_terms);
-    spectrum(0) += temp_spectra(0);
-    spectrum(1) += temp_spectra(1);
+  imat branch_weight;
+  branch_weights(branch_weight);
+
+  // a catastrophic code has no finite spectrum
+  if (zero_weight_cycle(branch_weight))
+    return false;
+
+  // the start positions are independent
+  Array<Array<ivec> > pos_spectra(Period);
+  int pos;
+#pragma omp parallel for private(pos) schedule(dynamic)
+  for (pos = 0; pos < Period; pos++) {
+    trellis_spectrum(branch_weight, pos, dmax + no_terms, pos_spectra(pos));
+  }
+  for (pos = 0; pos < Period; pos++) {
+    spectrum(0) += pos_spectra(pos)(0);
+    spectrum(1) += pos_spectra(pos)(1);
   }
+  return true;
 }
 
-void Punctured_Convolutional_Code::calculate_spectrum(Array<ivec> &spectrum, int time, int dmax, int no_terms, int block_length)
+bool Punctured_Convolutional_Code::calculate_spectrum(Array<ivec> &spectrum, int time, int dmax, int no_terms, int block_length)
 {
+  if (block_length == 0) {
+    imat branch_weight;
+    branch_weights(branch_weight);
+    return trellis_spectrum(branch_weight, time, dmax + no_terms, spectrum);
+  }
+
   imat Ad_states(1 << (K - 1), dmax + no_terms), Cd_states(1 << m, dmax + no_terms);
   imat Ad_temp(1 << (K - 1), dmax + no_terms), Cd_temp(1 << m, dmax + no_terms);
   ivec mindist(1 << (K - 1)), mindist_temp(1 << m);
@@ -849,7 +930,7 @@ void Punctured_Convolutional_Code::calculate_spectrum(Array<ivec> &spectrum, int
     spectrum(0) = Ad_states.get_row(0);
     spectrum(1) = Cd_states.get_row(0);
   }
-
+  return true;
 }
 
 } // namespace itpp
@@ -81,7 +81,7 @@ class Punctured_Convolutional_Code : public Convolutional_Code
 {
 public:
   //! Constructor
-  Punctured_Convolutional_Code(void) : Convolutional_Code() {}
+  Punctured_Convolutional_Code(void) : Convolutional_Code(), stream_punct_pos(0) {}
   //! Destructor
   virtual ~Punctured_Convolutional_Code(void) {}
 
@@ -102,6 +102,9 @@ public:
   //! Return rate of code
   virtual double get_rate() const { return rate; }
 
+  //! Create a copy of the codec (used by \c decode_batch())
+  virtual Channel_Code *clone() const { return new Punctured_Convolutional_Code(*this); }
+
   //! Set encoding and decoding method (Trunc, Tail, or Tailbite)
   void set_method(const CONVOLUTIONAL_CODE_METHOD method) { Convolutional_Code::set_method(method); }
 
@@ -115,6 +118,11 @@ public:
   //! Set the encoder internal state in start_state (set by set_start_state()).
   void init_encoder() { encoder_state = start_state; }
 
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
+
   //! Encode a binary vector of inputs using specified method
   void encode(const bvec &input, bvec &output);
   //! Encode a binary vector of inputs using specified method
@@ -178,12 +186,35 @@ public:
   */
   bvec decode_tail(const vec &received_signal) { bvec output; decode_tail(received_signal, output); return output; }
 
-  //! Decode a block of encoded data where encode_tailbite has been used. Tries all start states.
+  /*!
+    \brief Decode a block of encoded data where encode_tailbite has been used.
+
+    Tries all start states, or runs the wrap-around Viterbi algorithm if
+    it is enabled with set_wrap_around_viterbi().
+  */
   void decode_tailbite(const vec &received_signal, bvec &output);
-  //! Decode a block of encoded data where encode_tailbite has been used. Tries all start states.
+  //! Decode a block of encoded data where encode_tailbite has been used (see above)
   bvec decode_tailbite(const vec &received_signal)
   { bvec output; decode_tailbite(received_signal, output); return output; }
 
+  /*!
+    \brief Streaming Viterbi decoding of a punctured stream
+
+    The punctured symbols are reinserted as zeros, with the puncture
+    pattern continued from one call to the next, before decoding with
+    Convolutional_Code::decode_stream(). The puncture pattern starts
+    over with each new stream.
+  */
+  void decode_stream(const vec &received_signal, bvec &output);
+  //! Streaming Viterbi decoding of a punctured stream (see above)
+  bvec decode_stream(const vec &received_signal)
+  { bvec output; decode_stream(received_signal, output); return output; }
+
+  //! Decide the bits still held by the streaming decoder (see Convolutional_Code::flush_stream())
+  void flush_stream(bvec &output);
+  //! Decide the bits still held by the streaming decoder (see Convolutional_Code::flush_stream())
+  bvec flush_stream() { bvec output; flush_stream(output); return output; }
+
   /*
     \brief Calculate the inverse sequence
 
@@ -205,7 +236,7 @@ public:
     returns it as ivec:s in the 0:th and 1:st component of spectrum, respectively. For a
     punctrued code the spectrum is a sum of the spectras of all starting positions.
     Suitable for calculating many terms in the spectra (uses an breadth first algorithm).
-    It is assumed that the code is non-catastrophic or else it is a possibility for an eternal loop.
+    Returns \c false, with an all-zero spectrum, if the code is catastrophic, and \c true otherwise.
 
     <ul>
     <li> \a dmax = an upper bound on the free distance </li>
@@ -214,7 +245,7 @@ public:
 
     Observe that there is a risk that some of the integers are overflow if many terms are calculated in the spectrum.
   */
-  void calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms);
+  bool calculate_spectrum(Array<ivec> &spectrum, int dmax, int no_terms);
 
   /*!
     \brief Calculate spectrum. Suitable when calculating many terms in the spectra. Breadth first search.
@@ -225,8 +256,10 @@ public:
     <li> Use \a time = 0 if the puncturing is restarted at each block. </li>
     <li> Use \a block_length = 0 (default value) for infinite blocks. </li>
     </ul>
+
+    With infinite blocks it returns \c false, with an all-zero spectrum, if the code is catastrophic.
   */
-  void calculate_spectrum(Array<ivec> &spectrum, int time, int dmax, int no_terms, int block_length = 0);
+  bool calculate_spectrum(Array<ivec> &spectrum, int time, int dmax, int no_terms, int block_length = 0);
 
   /*!
     \brief Cederwall's fast algorithm.
@@ -255,6 +288,8 @@ protected:
   int weight_reverse(const int state, const int input, int time);
   //! The weight of the reverse code of two paths (input 0 or 1) from given state
   void weight_reverse(const int state, int &w0, int &w1, int time);
+  //! The weights of all branches (of the reverse code if \c reverse = true), with input \c i at transition \c time in column 2 * \c time + \c i
+  void branch_weights(imat &branch_weight, bool reverse = false);
 
   //! The puncture period (i.e. the number of columns in the puncture matrix)
   int Period;
@@ -262,6 +297,8 @@ protected:
   int total;
   //! The puncture matrix (\a n rows and \a Period columns)
   bmat puncture_matrix;
+  //! Position of the streaming decoder in the puncture matrix (column-wise)
+  int stream_punct_pos;
 };
 
 } // namespace itpp
@@ -28,6 +28,10 @@
 
 #include <itpp/comm/rec_syst_conv_code.h>
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 
 namespace itpp
 {
@@ -105,6 +109,34 @@ void Rec_Syst_Conv_Code::set_generator_polynomials(const ivec &gen, int constrai
     }
   }
 
+  // eight trellis steps from each byte of the state with zero inputs, and
+  // from state zero with each byte of inputs
+  if (n <= 9) {
+    int nrof_bytes = (m + 7) / 8;
+    encode_state_table.set_size(256 * (nrof_bytes + 1), false);
+    encode_parity_table.set_size(256 * (nrof_bytes + 1), false);
+    for (int t = 0; t <= nrof_bytes; t++) {
+      for (int b = 0; b < 256; b++) {
+        int state = (t < nrof_bytes) ? ((b << (8 * t)) & (Nstates - 1)) : 0;
+        uint64_t word = 0;
+        for (int i = 0; i < 8; i++) {
+          int input = (t < nrof_bytes) ? 0 : ((b >> i) & 1);
+          for (j = 0; j < (n - 1); j++) {
+            word |= static_cast<uint64_t>(output_parity(state, 2 * j + input))
+                    << (8 * j + i);
+          }
+          state = state_trans(state, input);
+        }
+        encode_state_table(256 * t + b) = state;
+        encode_parity_table(256 * t + b) = word;
+      }
+    }
+  }
+  else {
+    encode_state_table.set_size(0);
+    encode_parity_table.set_size(0);
+  }
+
   ln2 = std::log(2.0);
 
   //The default value of Lc is 1:
@@ -127,13 +159,7 @@ void Rec_Syst_Conv_Code::encode_tail(const bvec &input, bvec &tail, bmat &parity
   parity_bits.set_size(length + m, n - 1, false);
   tail.set_size(m, false);
 
-  encoder_state = 0;
-  for (i = 0; i < length; i++) {
-    for (j = 0; j < (n - 1); j++) {
-      parity_bits(i, j) = output_parity(encoder_state, 2 * j + int(input(i)));
-    }
-    encoder_state = state_trans(encoder_state, int(input(i)));
-  }
+  encode_bits(input, length, parity_bits);
 
   // add tail of m=K-1 zeros
   for (i = 0; i < m; i++) {
@@ -150,17 +176,53 @@ void Rec_Syst_Conv_Code::encode_tail(const bvec &input, bvec &tail, bmat &parity
 
 void Rec_Syst_Conv_Code::encode(const bvec &input, bmat &parity_bits)
 {
-  int i, j, length = input.size();
+  int length = input.size();
   parity_bits.set_size(length, n - 1, false);
 
+  encode_bits(input, length, parity_bits);
+  terminated = false;
+}
+
+void Rec_Syst_Conv_Code::encode_bits(const bvec &input, int length,
+                                     bmat &parity_bits)
+{
+  int i = 0, j, rows = parity_bits.rows();
+  bin *parity = parity_bits._data();
+
   encoder_state = 0;
-  for (i = 0; i < length; i++) {
+  if (encode_state_table.size() > 0) {
+    int nrof_bytes = encode_state_table.size() / 256 - 1;
+    const int *state_table = encode_state_table._data();
+    const uint64_t *parity_table = encode_parity_table._data();
+    // eight steps per lookup; the parity bits of a step are in one column
+    for (; i + 8 <= length; i += 8) {
+      int inputs = 0;
+      for (int k = 0; k < 8; k++) {
+        inputs |= int(input(i + k)) << k;
+      }
+      int t = 256 * nrof_bytes + inputs;
+      int next_state = state_table[t];
+      uint64_t word = parity_table[t];
+      for (t = 0; t < nrof_bytes; t++) {
+        int b = (encoder_state >> (8 * t)) & 255;
+        next_state ^= state_table[256 * t + b];
+        word ^= parity_table[256 * t + b];
+      }
+      for (j = 0; j < (n - 1); j++) {
+        for (int k = 0; k < 8; k++) {
+          parity[j * rows + i + k] = static_cast<int>((word >> (8 * j + k)) & 1);
+        }
+      }
+      encoder_state = next_state;
+    }
+  }
+
+  for (; i < length; i++) {
     for (j = 0; j < (n - 1); j++) {
       parity_bits(i, j) = output_parity(encoder_state, 2 * j + int(input(i)));
     }
     encoder_state = state_trans(encoder_state, int(input(i)));
   }
-  terminated = false;
 }
 
 void Rec_Syst_Conv_Code::map_decode(const vec &rec_systematic, const mat &rec_parity, const vec &extrinsic_input,
@@ -302,12 +364,27 @@ void Rec_Syst_Conv_Code::log_decode(const vec &rec_systematic, const mat &rec_pa
   ivec p0, p1;
 
   //Set the internal metric:
-  if (metric == "LOGMAX") { com_log = max; }
+  if ((metric == "LOGMAX") || (metric == "LOGMAX16")) { com_log = max; }
   else if (metric == "LOGMAP") { com_log = log_add; }
   else {
     it_error("Rec_Syst_Conv_Code::log_decode: Illegal metric parameter");
   }
 
+  if (in_terminated) { terminated = true; }
+
+  //Check that Lc = 1.0
+  it_assert(Lc == 1.0,
+            "Rec_Syst_Conv_Code::log_decode: This function assumes that Lc = 1.0. Please use proper scaling of the input data");
+
+  if (nrof_subblocks > 1) {
+    subblock_log_decode(rec_systematic, rec_parity, extrinsic_input, extrinsic_output);
+    return;
+  }
+  if (window_length > 0) {
+    window_log_decode(rec_systematic, rec_parity, extrinsic_input, extrinsic_output);
+    return;
+  }
+
   mat alpha(Nstates, block_length + 1);
   mat beta(Nstates, block_length + 1);
   mat gamma(2*Nstates, block_length + 1);
@@ -315,12 +392,6 @@ void Rec_Syst_Conv_Code::log_decode(const vec &rec_systematic, const mat &rec_pa
   vec denom(block_length + 1);
   for (k = 0; k <= block_length; k++) { denom(k) = -infinity; }
 
-  if (in_terminated) { terminated = true; }
-
-  //Check that Lc = 1.0
-  it_assert(Lc == 1.0,
-            "Rec_Syst_Conv_Code::log_decode: This function assumes that Lc = 1.0. Please use proper scaling of the input data");
-
   //Calculate gamma
   for (k = 1; k <= block_length; k++) {
     kk = k - 1;
@@ -422,25 +493,44 @@ void Rec_Syst_Conv_Code::log_decode_n2(const vec &rec_systematic, const vec &rec
   ivec p0, p1;
   double ex, norm;
 
+  if ((metric == "LOGMAX16") && (Nstates == 8)) {
+    if (in_terminated) { terminated = true; }
+    it_assert(Lc == 1.0,
+              "Rec_Syst_Conv_Code::log_decode_n2: This function assumes that Lc = 1.0. Please use proper scaling of the input data");
+    fixed_log_decode_n2(rec_systematic, rec_parity, extrinsic_input, extrinsic_output);
+    return;
+  }
+
   //Set the internal metric:
-  if (metric == "LOGMAX") { com_log = max; }
+  if ((metric == "LOGMAX") || (metric == "LOGMAX16")) { com_log = max; }
   else if (metric == "LOGMAP") { com_log = log_add; }
   else {
     it_error("Rec_Syst_Conv_Code::log_decode_n2: Illegal metric parameter");
   }
 
-  mat alpha(Nstates, block_length + 1);
-  mat beta(Nstates, block_length + 1);
-  mat gamma(2*Nstates, block_length + 1);
-  extrinsic_output.set_size(ext_info_length, false);
-  //denom.set_size(block_length+1,false); for (k=0; k<=block_length; k++) { denom(k) = -infinity; }
-
   if (in_terminated) { terminated = true; }
 
   //Check that Lc = 1.0
   it_assert(Lc == 1.0,
             "Rec_Syst_Conv_Code::log_decode_n2: This function assumes that Lc = 1.0. Please use proper scaling of the input data");
 
+  if (nrof_subblocks > 1) {
+    subblock_log_decode(rec_systematic, mat(rec_parity._data(), block_length, 1),
+                        extrinsic_input, extrinsic_output);
+    return;
+  }
+  if (window_length > 0) {
+    window_log_decode(rec_systematic, mat(rec_parity._data(), block_length, 1),
+                      extrinsic_input, extrinsic_output);
+    return;
+  }
+
+  mat alpha(Nstates, block_length + 1);
+  mat beta(Nstates, block_length + 1);
+  mat gamma(2*Nstates, block_length + 1);
+  extrinsic_output.set_size(ext_info_length, false);
+  //denom.set_size(block_length+1,false); for (k=0; k<=block_length; k++) { denom(k) = -infinity; }
+
   //Initiate alpha
   for (s = 1; s < Nstates; s++) { alpha(s, 0) = -infinity; }
   alpha(0, 0) = 0.0;
@@ -523,6 +613,21 @@ void Rec_Syst_Conv_Code::log_decode(const QLLRvec &rec_systematic, const QLLRmat
   int i, j, s0, s1, k, kk, l, s, s_prim, s_prim0, s_prim1, block_length = rec_systematic.length();
   //    ivec p0, p1;
 
+  if (in_terminated) { terminated = true; }
+
+  //Check that Lc = 1.0
+  it_assert(Lc == 1.0,
+            "Rec_Syst_Conv_Code::log_decode: This function assumes that Lc = 1.0. Please use proper scaling of the input data");
+
+  if (nrof_subblocks > 1) {
+    subblock_log_decode(rec_systematic, rec_parity, extrinsic_input, extrinsic_output);
+    return;
+  }
+  if (window_length > 0) {
+    window_log_decode(rec_systematic, rec_parity, extrinsic_input, extrinsic_output);
+    return;
+  }
+
   QLLRmat alpha_q(Nstates, block_length + 1);
   QLLRmat beta_q(Nstates, block_length + 1);
   QLLRmat gamma_q(2*Nstates, block_length + 1);
@@ -530,12 +635,6 @@ void Rec_Syst_Conv_Code::log_decode(const QLLRvec &rec_systematic, const QLLRmat
   QLLRvec denom_q(block_length + 1);
   for (k = 0; k <= block_length; k++) { denom_q(k) = -QLLR_MAX; }
 
-  if (in_terminated) { terminated = true; }
-
-  //Check that Lc = 1.0
-  it_assert(Lc == 1.0,
-            "Rec_Syst_Conv_Code::log_decode: This function assumes that Lc = 1.0. Please use proper scaling of the input data");
-
   //Calculate gamma_q
   for (k = 1; k <= block_length; k++) {
     kk = k - 1;
@@ -638,18 +737,29 @@ void Rec_Syst_Conv_Code::log_decode_n2(const QLLRvec &rec_systematic,
   int ex, norm;
 
 
-  QLLRmat alpha_q(Nstates, block_length + 1);
-  QLLRmat beta_q(Nstates, block_length + 1);
-  QLLRmat gamma_q(2*Nstates, block_length + 1);
-  extrinsic_output.set_size(ext_info_length, false);
-  //denom.set_size(block_length+1,false); for (k=0; k<=block_length; k++) { denom(k) = -infinity; }
-
   if (in_terminated) { terminated = true; }
 
   //Check that Lc = 1.0
   it_assert(Lc == 1.0,
             "Rec_Syst_Conv_Code::log_decode_n2: This function assumes that Lc = 1.0. Please use proper scaling of the input data");
 
+  if (nrof_subblocks > 1) {
+    subblock_log_decode(rec_systematic, QLLRmat(rec_parity._data(), block_length, 1),
+                        extrinsic_input, extrinsic_output);
+    return;
+  }
+  if (window_length > 0) {
+    window_log_decode(rec_systematic, QLLRmat(rec_parity._data(), block_length, 1),
+                      extrinsic_input, extrinsic_output);
+    return;
+  }
+
+  QLLRmat alpha_q(Nstates, block_length + 1);
+  QLLRmat beta_q(Nstates, block_length + 1);
+  QLLRmat gamma_q(2*Nstates, block_length + 1);
+  extrinsic_output.set_size(ext_info_length, false);
+  //denom.set_size(block_length+1,false); for (k=0; k<=block_length; k++) { denom(k) = -infinity; }
+
   //Initiate alpha
   for (s = 1; s < Nstates; s++) { alpha_q(s, 0) = -QLLR_MAX; }
   alpha_q(0, 0) = 0;
@@ -726,5 +836,638 @@ void Rec_Syst_Conv_Code::set_llrcalc(LLR_calc_unit in_llrcalc)
   llrcalc = in_llrcalc;
 }
 
+void Rec_Syst_Conv_Code::set_window(int in_window_length, int in_warmup_length)
+{
+  it_assert((in_window_length >= 0) && (in_warmup_length >= 0),
+            "Rec_Syst_Conv_Code::set_window: Window and warm-up lengths must be non-negative");
+  window_length = in_window_length;
+  warmup_length = in_warmup_length;
+}
+
+void Rec_Syst_Conv_Code::set_subblocks(int in_nrof_subblocks)
+{
+  it_assert(in_nrof_subblocks >= 1,
+            "Rec_Syst_Conv_Code::set_subblocks: The number of sub-blocks must be at least one");
+  nrof_subblocks = in_nrof_subblocks;
+  reset_subblock_metrics();
+}
+
+void Rec_Syst_Conv_Code::reset_subblock_metrics()
+{
+  sub_alpha.set_size(0, 0);
+  sub_beta.set_size(0, 0);
+  sub_alpha_q.set_size(0, 0);
+  sub_beta_q.set_size(0, 0);
+}
+
+// === Sliding-window and sub-block decoders ================================
+//
+// Both modes split the block into windows of consecutive trellis steps
+// and run the BCJR recursions of a window with window_bcjr(), which only
+// stores the alpha values and branch metrics of that window. The
+// extrinsic output of a step is computed as soon as its beta is known,
+// so beta is never stored.
+//
+// In the sliding-window mode the windows are decoded one after another:
+// the forward recursion continues from the previous window, and the
+// backward recursion of a window is started warmup_length steps after
+// its end from equiprobable states (unless the block end is reached).
+//
+// In the sub-block mode the windows are independent and are decoded in
+// parallel. A sub-block starts from the alpha and beta values that its
+// neighbours reached at the common boundaries in the previous call, i.e.
+// the previous half-iteration of the turbo decoder.
+
+void Rec_Syst_Conv_Code::branch_metrics(const vec &rec_systematic, const mat &rec_parity,
+                                        const vec &extrinsic_input, int kk, double &ex, double *par) const
+{
+  ex = 0.5 * (kk < extrinsic_input.length() ? extrinsic_input(kk) + rec_systematic(kk) : rec_systematic(kk));
+  for (int s_prim = 0; s_prim < Nstates; s_prim++) {
+    for (int u = 0; u < 2; u++) {
+      double e = 0.0;
+      for (int j = 0; j < (n - 1); j++) {
+        double rp = rec_parity(kk, j);
+        e += (output_parity(s_prim, 2 * j + u) == 0 ? rp : -rp);
+      }
+      par[2 * s_prim + u] = 0.5 * e;
+    }
+  }
+}
+
+void Rec_Syst_Conv_Code::beta_recursion(const vec &rec_systematic, const mat &rec_parity,
+                                        const vec &extrinsic_input, int k_start, int k_end, vec &beta) const
+{
+  vec par(2 * Nstates), beta_prev(Nstates);
+  double ex, norm;
+  for (int k = k_end; k > k_start; k--) {
+    branch_metrics(rec_systematic, rec_parity, extrinsic_input, k - 1, ex, par._data());
+    for (int s_prim = 0; s_prim < Nstates; s_prim++) {
+      beta_prev(s_prim) = com_log(beta(state_trans(s_prim, 0)) + ex + par(2 * s_prim),
+                                  beta(state_trans(s_prim, 1)) - ex + par(2 * s_prim + 1));
+    }
+    norm = beta_prev(0);
+    for (int s = 0; s < Nstates; s++) { beta(s) = beta_prev(s) - norm; }
+  }
+}
+
+void Rec_Syst_Conv_Code::window_bcjr(const vec &rec_systematic, const mat &rec_parity,
+                                     const vec &extrinsic_input, vec &extrinsic_output,
+                                     int k0, int k1, vec &alpha, vec &beta, bool beta_from_alpha) const
+{
+  int W = k1 - k0;
+  int ext_info_length = extrinsic_input.length();
+  int k, kk, w, s, s_prim;
+  double nom, den, norm;
+
+  mat alpha_w(Nstates, W + 1);
+  mat par(2 * Nstates, W);
+  vec ex(W), beta_prev(Nstates);
+
+  //Forward recursion over the window, storing the branch metrics
+  alpha_w.set_col(0, alpha);
+  for (k = k0 + 1; k <= k1; k++) {
+    w = k - k0;
+    branch_metrics(rec_systematic, rec_parity, extrinsic_input, k - 1, ex(w - 1),
+                   par._data() + 2 * Nstates * (w - 1));
+    for (s = 0; s < Nstates; s++) {
+      int s_prim0 = rev_state_trans(s, 0);
+      int s_prim1 = rev_state_trans(s, 1);
+      alpha_w(s, w) = com_log(alpha_w(s_prim0, w - 1) + ex(w - 1) + par(2 * s_prim0, w - 1),
+                              alpha_w(s_prim1, w - 1) - ex(w - 1) + par(2 * s_prim1 + 1, w - 1));
+    }
+    norm = alpha_w(0, w);
+    for (s = 0; s < Nstates; s++) { alpha_w(s, w) -= norm; }
+  }
+  alpha = alpha_w.get_col(W);
+  if (beta_from_alpha) { beta = alpha; }
+
+  //Backward recursion over the window with the extrinsic output
+  for (k = k1; k > k0; k--) {
+    kk = k - 1;
+    w = k - k0;
+    if (kk < ext_info_length) {
+      nom = -infinity;
+      den = -infinity;
+      for (s_prim = 0; s_prim < Nstates; s_prim++) {
+        nom = com_log(nom, alpha_w(s_prim, w - 1) + par(2 * s_prim, w - 1) + beta(state_trans(s_prim, 0)));
+        den = com_log(den, alpha_w(s_prim, w - 1) + par(2 * s_prim + 1, w - 1) + beta(state_trans(s_prim, 1)));
+      }
+      extrinsic_output(kk) = nom - den;
+    }
+    for (s_prim = 0; s_prim < Nstates; s_prim++) {
+      beta_prev(s_prim) = com_log(beta(state_trans(s_prim, 0)) + ex(w - 1) + par(2 * s_prim, w - 1),
+                                  beta(state_trans(s_prim, 1)) - ex(w - 1) + par(2 * s_prim + 1, w - 1));
+    }
+    norm = beta_prev(0);
+    for (s = 0; s < Nstates; s++) { beta(s) = beta_prev(s) - norm; }
+  }
+}
+
+void Rec_Syst_Conv_Code::window_log_decode(const vec &rec_systematic, const mat &rec_parity,
+                                           const vec &extrinsic_input, vec &extrinsic_output)
+{
+  int block_length = rec_systematic.length();
+  int W = std::min(window_length, block_length);
+  vec alpha(Nstates), beta(Nstates);
+  extrinsic_output.set_size(extrinsic_input.length(), false);
+
+  alpha = -infinity;
+  alpha(0) = 0.0;
+  for (int k0 = 0; k0 < block_length; k0 += W) {
+    int k1 = std::min(k0 + W, block_length);
+    int kw = std::min(k1 + warmup_length, block_length);
+    bool beta_from_alpha = false;
+    if (kw < block_length) {
+      beta.zeros();
+    }
+    else if (terminated) {
+      beta = -infinity;
+      beta(0) = 0.0;
+    }
+    else if (k1 == block_length) {
+      beta_from_alpha = true;
+    }
+    else {
+      beta.zeros();
+    }
+    beta_recursion(rec_systematic, rec_parity, extrinsic_input, k1, kw, beta);
+    window_bcjr(rec_systematic, rec_parity, extrinsic_input, extrinsic_output,
+                k0, k1, alpha, beta, beta_from_alpha);
+  }
+}
+
+void Rec_Syst_Conv_Code::subblock_log_decode(const vec &rec_systematic, const mat &rec_parity,
+                                             const vec &extrinsic_input, vec &extrinsic_output)
+{
+  int block_length = rec_systematic.length();
+  int L = (block_length + nrof_subblocks - 1) / nrof_subblocks;
+  int P = (block_length + L - 1) / L;
+  int p;
+  extrinsic_output.set_size(extrinsic_input.length(), false);
+
+  // Start from equiprobable states at the inner boundaries
+  if ((sub_alpha.rows() != Nstates) || (sub_alpha.cols() != P + 1)) {
+    sub_alpha.set_size(Nstates, P + 1, false);
+    sub_beta.set_size(Nstates, P + 1, false);
+    sub_alpha.zeros();
+    sub_beta.zeros();
+  }
+  mat new_alpha(Nstates, P + 1), new_beta(Nstates, P + 1);
+
+  #pragma omp parallel for private(p)
+  for (p = 0; p < P; p++) {
+    int k0 = p * L;
+    int k1 = std::min(k0 + L, block_length);
+    vec alpha = sub_alpha.get_col(p);
+    vec beta = sub_beta.get_col(p + 1);
+    bool beta_from_alpha = false;
+    if (p == 0) {
+      alpha = -infinity;
+      alpha(0) = 0.0;
+    }
+    if (p == P - 1) {
+      if (terminated) {
+        beta = -infinity;
+        beta(0) = 0.0;
+      }
+      else {
+        beta_from_alpha = true;
+      }
+    }
+    window_bcjr(rec_systematic, rec_parity, extrinsic_input, extrinsic_output,
+                k0, k1, alpha, beta, beta_from_alpha);
+    new_alpha.set_col(p + 1, alpha);
+    new_beta.set_col(p, beta);
+  }
+
+  sub_alpha = new_alpha;
+  sub_beta = new_beta;
+}
+
+void Rec_Syst_Conv_Code::branch_metrics(const QLLRvec &rec_systematic, const QLLRmat &rec_parity,
+                                        const QLLRvec &extrinsic_input, int kk, QLLR &ex, QLLR *par) const
+{
+  ex = (kk < extrinsic_input.length() ? extrinsic_input(kk) + rec_systematic(kk) : rec_systematic(kk)) / 2;
+  for (int s_prim = 0; s_prim < Nstates; s_prim++) {
+    for (int u = 0; u < 2; u++) {
+      QLLR e = 0;
+      for (int j = 0; j < (n - 1); j++) {
+        QLLR rp = rec_parity(kk, j);
+        e += (output_parity(s_prim, 2 * j + u) == 0 ? rp : -rp);
+      }
+      par[2 * s_prim + u] = e / 2;
+    }
+  }
+}
+
+void Rec_Syst_Conv_Code::beta_recursion(const QLLRvec &rec_systematic, const QLLRmat &rec_parity,
+                                        const QLLRvec &extrinsic_input, int k_start, int k_end,
+                                        QLLRvec &beta_q) const
+{
+  QLLRvec par_q(2 * Nstates), beta_prev_q(Nstates);
+  QLLR ex_q, norm;
+  for (int k = k_end; k > k_start; k--) {
+    branch_metrics(rec_systematic, rec_parity, extrinsic_input, k - 1, ex_q, par_q._data());
+    for (int s_prim = 0; s_prim < Nstates; s_prim++) {
+      beta_prev_q(s_prim) = llrcalc.jaclog(beta_q(state_trans(s_prim, 0)) + ex_q + par_q(2 * s_prim),
+                                           beta_q(state_trans(s_prim, 1)) - ex_q + par_q(2 * s_prim + 1));
+    }
+    norm = beta_prev_q(0);
+    for (int s = 0; s < Nstates; s++) { beta_q(s) = beta_prev_q(s) - norm; }
+  }
+}
+
+void Rec_Syst_Conv_Code::window_bcjr(const QLLRvec &rec_systematic, const QLLRmat &rec_parity,
+                                     const QLLRvec &extrinsic_input, QLLRvec &extrinsic_output,
+                                     int k0, int k1, QLLRvec &alpha_q, QLLRvec &beta_q,
+                                     bool beta_from_alpha) const
+{
+  int W = k1 - k0;
+  int ext_info_length = extrinsic_input.length();
+  int k, kk, w, s, s_prim;
+  QLLR nom, den, norm;
+
+  QLLRmat alpha_w(Nstates, W + 1);
+  QLLRmat par_q(2 * Nstates, W);
+  QLLRvec ex_q(W), beta_prev_q(Nstates);
+
+  //Forward recursion over the window, storing the branch metrics
+  alpha_w.set_col(0, alpha_q);
+  for (k = k0 + 1; k <= k1; k++) {
+    w = k - k0;
+    branch_metrics(rec_systematic, rec_parity, extrinsic_input, k - 1, ex_q(w - 1),
+                   par_q._data() + 2 * Nstates * (w - 1));
+    for (s = 0; s < Nstates; s++) {
+      int s_prim0 = rev_state_trans(s, 0);
+      int s_prim1 = rev_state_trans(s, 1);
+      alpha_w(s, w) = llrcalc.jaclog(alpha_w(s_prim0, w - 1) + ex_q(w - 1) + par_q(2 * s_prim0, w - 1),
+                                     alpha_w(s_prim1, w - 1) - ex_q(w - 1) + par_q(2 * s_prim1 + 1, w - 1));
+    }
+    norm = alpha_w(0, w);
+    for (s = 0; s < Nstates; s++) { alpha_w(s, w) -= norm; }
+  }
+  alpha_q = alpha_w.get_col(W);
+  if (beta_from_alpha) { beta_q = alpha_q; }
+
+  //Backward recursion over the window with the extrinsic output
+  for (k = k1; k > k0; k--) {
+    kk = k - 1;
+    w = k - k0;
+    if (kk < ext_info_length) {
+      nom = -QLLR_MAX;
+      den = -QLLR_MAX;
+      for (s_prim = 0; s_prim < Nstates; s_prim++) {
+        nom = llrcalc.jaclog(nom, alpha_w(s_prim, w - 1) + par_q(2 * s_prim, w - 1) + beta_q(state_trans(s_prim, 0)));
+        den = llrcalc.jaclog(den, alpha_w(s_prim, w - 1) + par_q(2 * s_prim + 1, w - 1) + beta_q(state_trans(s_prim, 1)));
+      }
+      extrinsic_output(kk) = nom - den;
+    }
+    for (s_prim = 0; s_prim < Nstates; s_prim++) {
+      beta_prev_q(s_prim) = llrcalc.jaclog(beta_q(state_trans(s_prim, 0)) + ex_q(w - 1) + par_q(2 * s_prim, w - 1),
+                                           beta_q(state_trans(s_prim, 1)) - ex_q(w - 1) + par_q(2 * s_prim + 1, w - 1));
+    }
+    norm = beta_prev_q(0);
+    for (s = 0; s < Nstates; s++) { beta_q(s) = beta_prev_q(s) - norm; }
+  }
+}
+
+void Rec_Syst_Conv_Code::window_log_decode(const QLLRvec &rec_systematic,
+                                           const QLLRmat &rec_parity,
+                                           const QLLRvec &extrinsic_input,
+                                           QLLRvec &extrinsic_output)
+{
+  int block_length = rec_systematic.length();
+  int W = std::min(window_length, block_length);
+  QLLRvec alpha_q(Nstates), beta_q(Nstates);
+  extrinsic_output.set_size(extrinsic_input.length(), false);
+
+  alpha_q = -QLLR_MAX;
+  alpha_q(0) = 0;
+  for (int k0 = 0; k0 < block_length; k0 += W) {
+    int k1 = std::min(k0 + W, block_length);
+    int kw = std::min(k1 + warmup_length, block_length);
+    bool beta_from_alpha = false;
+    if (kw < block_length) {
+      beta_q.zeros();
+    }
+    else if (terminated) {
+      beta_q = -QLLR_MAX;
+      beta_q(0) = 0;
+    }
+    else if (k1 == block_length) {
+      beta_from_alpha = true;
+    }
+    else {
+      beta_q.zeros();
+    }
+    beta_recursion(rec_systematic, rec_parity, extrinsic_input, k1, kw, beta_q);
+    window_bcjr(rec_systematic, rec_parity, extrinsic_input, extrinsic_output,
+                k0, k1, alpha_q, beta_q, beta_from_alpha);
+  }
+}
+
+void Rec_Syst_Conv_Code::subblock_log_decode(const QLLRvec &rec_systematic,
+                                             const QLLRmat &rec_parity,
+                                             const QLLRvec &extrinsic_input,
+                                             QLLRvec &extrinsic_output)
+{
+  int block_length = rec_systematic.length();
+  int L = (block_length + nrof_subblocks - 1) / nrof_subblocks;
+  int P = (block_length + L - 1) / L;
+  int p;
+  extrinsic_output.set_size(extrinsic_input.length(), false);
+
+  // Start from equiprobable states at the inner boundaries
+  if ((sub_alpha_q.rows() != Nstates) || (sub_alpha_q.cols() != P + 1)) {
+    sub_alpha_q.set_size(Nstates, P + 1, false);
+    sub_beta_q.set_size(Nstates, P + 1, false);
+    sub_alpha_q.zeros();
+    sub_beta_q.zeros();
+  }
+  QLLRmat new_alpha_q(Nstates, P + 1), new_beta_q(Nstates, P + 1);
+
+  #pragma omp parallel for private(p)
+  for (p = 0; p < P; p++) {
+    int k0 = p * L;
+    int k1 = std::min(k0 + L, block_length);
+    QLLRvec alpha_q = sub_alpha_q.get_col(p);
+    QLLRvec beta_q = sub_beta_q.get_col(p + 1);
+    bool beta_from_alpha = false;
+    if (p == 0) {
+      alpha_q = -QLLR_MAX;
+      alpha_q(0) = 0;
+    }
+    if (p == P - 1) {
+      if (terminated) {
+        beta_q = -QLLR_MAX;
+        beta_q(0) = 0;
+      }
+      else {
+        beta_from_alpha = true;
+      }
+    }
+    window_bcjr(rec_systematic, rec_parity, extrinsic_input, extrinsic_output,
+                k0, k1, alpha_q, beta_q, beta_from_alpha);
+    new_alpha_q.set_col(p + 1, alpha_q);
+    new_beta_q.set_col(p, beta_q);
+  }
+
+  sub_alpha_q = new_alpha_q;
+  sub_beta_q = new_beta_q;
+}
+
+// === Fixed-point max-log decoder for eight states =========================
+//
+// The alpha and beta vectors of the eight-state trellis are kept in one
+// register of eight 16-bit lanes. For the recursive encoder the
+// predecessors of state s are s>>1 and (s>>1)+4, and the successors of
+// state s are (2s)&7 and ((2s)&7)+1, so the required state permutations
+// are fixed unpack and shuffle operations, independent of the generator
+// polynomials. The polynomials only determine the branch metric signs,
+// which are precomputed per lane.
+
+//! \cond
+
+//! Number of fractional bits of the 16-bit metrics of fixed_log_decode_n2()
+static const int RSC_fixed_frac_bits = 3;
+//! Largest magnitude of a quantized half LLR, which keeps the state metric spread within 16 bits
+static const int RSC_fixed_max_input = 2047;
+
+#if defined(__SSE2__)
+
+typedef __m128i states8;
+
+static inline states8 states_load(const short *p)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+static inline void states_store(short *p, states8 a)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a);
+}
+static inline states8 states_set(short x) { return _mm_set1_epi16(x); }
+static inline states8 states_adds(states8 a, states8 b) { return _mm_adds_epi16(a, b); }
+static inline states8 states_subs(states8 a, states8 b) { return _mm_subs_epi16(a, b); }
+static inline states8 states_max(states8 a, states8 b) { return _mm_max_epi16(a, b); }
+// a * c, for c = +1 or -1 in each lane
+static inline states8 states_sign(states8 a, states8 c) { return _mm_mullo_epi16(a, c); }
+// b in the lanes where mask is set, a elsewhere
+static inline states8 states_select(states8 mask, states8 a, states8 b)
+{
+  return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+// lane s holds a[s >> 1]
+static inline states8 states_pred0(states8 a) { return _mm_unpacklo_epi16(a, a); }
+// lane s holds a[(s >> 1) + 4]
+static inline states8 states_pred1(states8 a) { return _mm_unpackhi_epi16(a, a); }
+// lane s holds a[(2s) & 7] (succ0) and a[((2s) & 7) + 1] (succ1)
+static inline void states_succ(states8 a, states8 &succ0, states8 &succ1)
+{
+  // a0 a2 a4 a6 a1 a3 a5 a7
+  states8 e = _mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 1, 2, 0));
+  e = _mm_shufflehi_epi16(e, _MM_SHUFFLE(3, 1, 2, 0));
+  e = _mm_shuffle_epi32(e, _MM_SHUFFLE(3, 1, 2, 0));
+  succ0 = _mm_shuffle_epi32(e, _MM_SHUFFLE(1, 0, 1, 0));
+  succ1 = _mm_shuffle_epi32(e, _MM_SHUFFLE(3, 2, 3, 2));
+}
+// the maximum of all lanes, in all lanes
+static inline states8 states_hmax(states8 a)
+{
+  a = _mm_max_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+  a = _mm_max_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_max_epi16(a, _mm_shufflelo_epi16(_mm_shufflehi_epi16(a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                             _MM_SHUFFLE(2, 3, 0, 1)));
+}
+static inline int states_first(states8 a)
+{
+  return static_cast<short>(_mm_cvtsi128_si32(a));
+}
+
+#else // standard C++
+
+struct states8 { short x[8]; };
+
+static inline short states_sat(int a)
+{
+  return static_cast<short>(a > 32767 ? 32767 : (a < -32768 ? -32768 : a));
+}
+static inline states8 states_load(const short *p)
+{
+  states8 r;
+  for (int l = 0; l < 8; l++) r.x[l] = p[l];
+  return r;
+}
+static inline void states_store(short *p, states8 a)
+{
+  for (int l = 0; l < 8; l++) p[l] = a.x[l];
+}
+static inline states8 states_set(short x)
+{
+  states8 r;
+  for (int l = 0; l < 8; l++) r.x[l] = x;
+  return r;
+}
+static inline states8 states_adds(states8 a, states8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = states_sat(a.x[l] + b.x[l]);
+  return a;
+}
+static inline states8 states_subs(states8 a, states8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = states_sat(a.x[l] - b.x[l]);
+  return a;
+}
+static inline states8 states_max(states8 a, states8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = std::max(a.x[l], b.x[l]);
+  return a;
+}
+static inline states8 states_sign(states8 a, states8 c)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = static_cast<short>(a.x[l] * c.x[l]);
+  return a;
+}
+static inline states8 states_select(states8 mask, states8 a, states8 b)
+{
+  for (int l = 0; l < 8; l++) a.x[l] = (mask.x[l] ? b.x[l] : a.x[l]);
+  return a;
+}
+static inline states8 states_pred0(states8 a)
+{
+  states8 r;
+  for (int l = 0; l < 8; l++) r.x[l] = a.x[l >> 1];
+  return r;
+}
+static inline states8 states_pred1(states8 a)
+{
+  states8 r;
+  for (int l = 0; l < 8; l++) r.x[l] = a.x[(l >> 1) + 4];
+  return r;
+}
+static inline void states_succ(states8 a, states8 &succ0, states8 &succ1)
+{
+  for (int l = 0; l < 8; l++) {
+    succ0.x[l] = a.x[(2 * l) & 7];
+    succ1.x[l] = a.x[((2 * l) & 7) + 1];
+  }
+}
+static inline states8 states_hmax(states8 a)
+{
+  short m = a.x[0];
+  for (int l = 1; l < 8; l++) m = std::max(m, a.x[l]);
+  return states_set(m);
+}
+static inline int states_first(states8 a) { return a.x[0]; }
+
+#endif // __SSE2__
+
+//! Quantize a half LLR to the 16-bit metrics of fixed_log_decode_n2()
+static inline short rsc_fixed_quantize(double x)
+{
+  double q = std::floor(0.5 + x * (1 << RSC_fixed_frac_bits));
+  if (q > RSC_fixed_max_input) return RSC_fixed_max_input;
+  if (q < -RSC_fixed_max_input) return -RSC_fixed_max_input;
+  return static_cast<short>(q);
+}
+
+//! \endcond
+
+void Rec_Syst_Conv_Code::fixed_log_decode_n2(const vec &rec_systematic, const vec &rec_parity,
+                                             const vec &extrinsic_input, vec &extrinsic_output)
+{
+  int block_length = rec_systematic.length();
+  int ext_info_length = extrinsic_input.length();
+  int k, kk, s;
+  extrinsic_output.set_size(ext_info_length, false);
+
+  // Branch metric signs per lane. The systematic sign is + for input 0
+  // and - for input 1, the parity sign is + for parity bit 0.
+  // fwd0/fwd1: transitions into state s from s>>1 and (s>>1)+4
+  // bwd0/bwd1: transitions out of state s into (2s)&7 and ((2s)&7)+1
+  short fwd_sys[2][8], fwd_par[2][8], bwd_sys[2][8], bwd_par[2][8], fb_mask[8];
+  for (s = 0; s < 8; s++) {
+    for (int b = 0; b < 2; b++) {
+      int s_prim = (s >> 1) + 4 * b;
+      int u = ((state_trans(s_prim, 0) & 1) == (s & 1) ? 0 : 1);
+      it_assert_debug(state_trans(s_prim, u) == s, "Rec_Syst_Conv_Code::fixed_log_decode_n2: Unexpected trellis");
+      fwd_sys[b][s] = (u == 0 ? 1 : -1);
+      fwd_par[b][s] = (output_parity(s_prim, u) ? -1 : 1);
+
+      u = ((state_trans(s, 0) & 1) == b ? 0 : 1);
+      it_assert_debug(state_trans(s, u) == (((2 * s) & 7) | b), "Rec_Syst_Conv_Code::fixed_log_decode_n2: Unexpected trellis");
+      bwd_sys[b][s] = (u == 0 ? 1 : -1);
+      bwd_par[b][s] = (output_parity(s, u) ? -1 : 1);
+    }
+    // set if input 0 leads to the odd successor
+    fb_mask[s] = ((state_trans(s, 0) & 1) ? -1 : 0);
+  }
+  states8 fs0 = states_load(fwd_sys[0]), fs1 = states_load(fwd_sys[1]);
+  states8 fp0 = states_load(fwd_par[0]), fp1 = states_load(fwd_par[1]);
+  states8 bs0 = states_load(bwd_sys[0]), bs1 = states_load(bwd_sys[1]);
+  states8 bp0 = states_load(bwd_par[0]), bp1 = states_load(bwd_par[1]);
+  states8 fb = states_load(fb_mask);
+
+  // Quantized half systematic plus a priori LLRs and half parity LLRs
+  Vec<short> ex(block_length), rp(block_length);
+  for (kk = 0; kk < block_length; kk++) {
+    ex(kk) = rsc_fixed_quantize(0.5 * (kk < ext_info_length ? extrinsic_input(kk) + rec_systematic(kk)
+                                       : rec_systematic(kk)));
+    rp(kk) = rsc_fixed_quantize(0.5 * rec_parity(kk));
+  }
+
+  // Forward recursion, normalized to a maximum of zero
+  Vec<short> alpha(8 * (block_length + 1));
+  short *p_alpha = alpha._data();
+  const short minus_inf = -32768;
+  states8 a = states_set(minus_inf);
+  states_store(p_alpha, a);
+  p_alpha[0] = 0;
+  a = states_load(p_alpha);
+  for (k = 1; k <= block_length; k++) {
+    states8 e = states_set(ex(k - 1));
+    states8 r = states_set(rp(k - 1));
+    states8 t0 = states_adds(states_pred0(a), states_adds(states_sign(e, fs0), states_sign(r, fp0)));
+    states8 t1 = states_adds(states_pred1(a), states_adds(states_sign(e, fs1), states_sign(r, fp1)));
+    a = states_max(t0, t1);
+    a = states_subs(a, states_hmax(a));
+    states_store(p_alpha + 8 * k, a);
+  }
+
+  // Backward recursion with the extrinsic output
+  states8 b;
+  if (terminated) {
+    b = states_set(minus_inf);
+    short tmp[8];
+    states_store(tmp, b);
+    tmp[0] = 0;
+    b = states_load(tmp);
+  }
+  else {
+    b = a;
+  }
+  for (k = block_length; k >= 1; k--) {
+    kk = k - 1;
+    states8 succ0, succ1;
+    states_succ(b, succ0, succ1);
+    states8 e = states_set(ex(kk));
+    states8 r = states_set(rp(kk));
+    if (kk < ext_info_length) {
+      // beta of the successor and parity sign for input 0 and input 1
+      states8 b_u0 = states_select(fb, succ0, succ1);
+      states8 b_u1 = states_select(fb, succ1, succ0);
+      states8 p_u0 = states_select(fb, bp0, bp1);
+      states8 p_u1 = states_select(fb, bp1, bp0);
+      states8 a_prev = states_load(p_alpha + 8 * kk);
+      states8 nom = states_hmax(states_adds(states_adds(a_prev, b_u0), states_sign(r, p_u0)));
+      states8 den = states_hmax(states_adds(states_adds(a_prev, b_u1), states_sign(r, p_u1)));
+      extrinsic_output(kk) = static_cast<double>(states_first(nom) - states_first(den))
+                             / (1 << RSC_fixed_frac_bits);
+    }
+    states8 t0 = states_adds(succ0, states_adds(states_sign(e, bs0), states_sign(r, bp0)));
+    states8 t1 = states_adds(succ1, states_adds(states_sign(e, bs1), states_sign(r, bp1)));
+    b = states_max(t0, t1);
+    b = states_subs(b, states_hmax(b));
+  }
+}
 
 } // namespace itpp
@@ -31,6 +31,7 @@
 
 #include <itpp/base/vec.h>
 #include <itpp/base/mat.h>
+#include <itpp/base/ittypes.h>
 #include <itpp/comm/convcode.h>
 #include <itpp/comm/llr.h>
 
@@ -53,7 +54,7 @@ class Rec_Syst_Conv_Code
 public:
 
   //! Class constructor
-  Rec_Syst_Conv_Code(): infinity(1e30) {}
+  Rec_Syst_Conv_Code(): window_length(0), warmup_length(0), nrof_subblocks(1), infinity(1e30) {}
 
   //! Class constructor
   virtual ~Rec_Syst_Conv_Code() {}
@@ -88,6 +89,45 @@ public:
   */
   void set_llrcalc(LLR_calc_unit in_llrcalc);
 
+  /*!
+    \brief Set the window used by the log-domain decoders
+
+    With \a window_length > 0, log_decode() and log_decode_n2() run a
+    sliding-window BCJR: the block is processed in windows of \a
+    window_length trellis steps, and the backward recursion of each window
+    is started \a warmup_length steps beyond the window end from
+    equiprobable states (or from the true end state when the block end is
+    reached). Only the metrics of one window are stored, so the memory
+    use is proportional to \a window_length times the number of states
+    instead of the block length. A warm-up of eight to ten constraint
+    lengths makes the loss negligible.
+
+    \a window_length = 0 (the default) decodes the whole block at once.
+    The window is not used by map_decode().
+  */
+  void set_window(int window_length = 0, int warmup_length = 32);
+
+  /*!
+    \brief Split the log-domain decoders into parallel sub-blocks
+
+    With \a nrof_subblocks > 1, log_decode() and log_decode_n2() divide
+    the trellis into \a nrof_subblocks sub-blocks of equal length, which
+    are decoded independently (in parallel when OpenMP is enabled). The
+    forward and backward recursions of a sub-block start from the state
+    metrics that its neighbours reached at the common boundaries in the
+    previous call, i.e. in the previous half-iteration of a turbo
+    decoder. In the first call the inner boundaries start from
+    equiprobable states. Call reset_subblock_metrics() before decoding a
+    new block.
+
+    Sub-blocks take precedence over set_window(). They are not used by
+    map_decode() and the "LOGMAX16" metric.
+  */
+  void set_subblocks(int nrof_subblocks = 1);
+
+  //! Forget the boundary state metrics kept between calls in sub-block mode
+  void reset_subblock_metrics();
+
   /*!
     \brief Encode a binary vector of inputs and also adds a tail of \a K-1 zeros to force the encoder into the zero state.
 
@@ -132,7 +172,7 @@ public:
     \param extrinsic_input For all systematic bits
     \param extrinsic_output For all systematic bits
     \param set_terminated Equal to \a true if the trellis was terminated by the encoder and false otherwise
-    \param metric May be "LOGMAP", "LOGMAX" (default), or "TABLE"
+    \param metric May be "LOGMAP", "LOGMAX" (default), or "TABLE" ("LOGMAX16" is decoded as "LOGMAX", see log_decode_n2())
 
     <b>Note:</b> Unless LOGMAX decoding is desired, it is
     recommended to use the TABLE metric instead of LOGMAP as the
@@ -149,11 +189,19 @@ public:
     \param extrinsic_input For all systematic bits
     \param extrinsic_output For all systematic bits
     \param set_terminated Equal to \a true if the trellis was terminated by the encoder and false otherwise
-    \param metric May be "LOGMAP", "LOGMAX" (default), or "TABLE"
+    \param metric May be "LOGMAP", "LOGMAX" (default), "TABLE" or "LOGMAX16"
 
     <b>Note:</b> Unless LOGMAX decoding is desired, it is
     recommended to use the TABLE metric instead of LOGMAP as the
     table-based decoder is much faster and numerically stable.
+
+    The "LOGMAX16" metric is a fixed-point LOGMAX decoder for codes with
+    eight states (constraint length 4, as in the 3GPP turbo code). The
+    metrics of all states are updated at once in one SIMD register of
+    16-bit lanes with saturating arithmetic. Half LLRs are represented
+    with 3 fractional bits and clipped at +/-255.875. For other
+    constraint lengths "LOGMAX16" is the same as "LOGMAX". The window set
+    with set_window() is not used by this metric.
   */
   virtual void log_decode_n2(const vec &rec_systematic,
                              const vec &rec_parity,
@@ -208,14 +256,73 @@ public:
 private:
   //! Used for precalculations of the trellis state transitions
   int calc_state_transition(const int instate, const int input, ivec &parity);
+  //! Encode the first \a length inputs from state zero into the first rows of parity_bits
+  void encode_bits(const bvec &input, int length, bmat &parity_bits);
+
+  //! Fixed-point max-log version of log_decode_n2() for eight-state codes
+  void fixed_log_decode_n2(const vec &rec_systematic, const vec &rec_parity,
+                           const vec &extrinsic_input, vec &extrinsic_output);
+
+  //! Half the systematic plus a priori LLR and half the parity LLRs of each transition of trellis step kk
+  void branch_metrics(const vec &rec_systematic, const mat &rec_parity,
+                      const vec &extrinsic_input, int kk, double &ex, double *par) const;
+  //! Backward recursion of beta from trellis step k_end to k_start, with the metric in com_log
+  void beta_recursion(const vec &rec_systematic, const mat &rec_parity,
+                      const vec &extrinsic_input, int k_start, int k_end, vec &beta) const;
+  //! BCJR over trellis steps k0 to k1, from alpha at k0 and beta at k1 to alpha at k1 and beta at k0
+  void window_bcjr(const vec &rec_systematic, const mat &rec_parity,
+                   const vec &extrinsic_input, vec &extrinsic_output,
+                   int k0, int k1, vec &alpha, vec &beta, bool beta_from_alpha) const;
+  //! Sliding-window version of log_decode(), with the metric in com_log
+  void window_log_decode(const vec &rec_systematic, const mat &rec_parity,
+                         const vec &extrinsic_input, vec &extrinsic_output);
+  //! Sub-block version of log_decode(), with the metric in com_log
+  void subblock_log_decode(const vec &rec_systematic, const mat &rec_parity,
+                           const vec &extrinsic_input, vec &extrinsic_output);
+
+  //! QLLR version of branch_metrics()
+  void branch_metrics(const QLLRvec &rec_systematic, const QLLRmat &rec_parity,
+                      const QLLRvec &extrinsic_input, int kk, QLLR &ex, QLLR *par) const;
+  //! QLLR version of beta_recursion()
+  void beta_recursion(const QLLRvec &rec_systematic, const QLLRmat &rec_parity,
+                      const QLLRvec &extrinsic_input, int k_start, int k_end,
+                      QLLRvec &beta) const;
+  //! QLLR version of window_bcjr()
+  void window_bcjr(const QLLRvec &rec_systematic, const QLLRmat &rec_parity,
+                   const QLLRvec &extrinsic_input, QLLRvec &extrinsic_output,
+                   int k0, int k1, QLLRvec &alpha, QLLRvec &beta,
+                   bool beta_from_alpha) const;
+  //! Sliding-window version of the QLLR log_decode()
+  void window_log_decode(const QLLRvec &rec_systematic,
+                         const QLLRmat &rec_parity,
+                         const QLLRvec &extrinsic_input,
+                         QLLRvec &extrinsic_output);
+  //! Sub-block version of the QLLR log_decode()
+  void subblock_log_decode(const QLLRvec &rec_systematic,
+                           const QLLRmat &rec_parity,
+                           const QLLRvec &extrinsic_input,
+                           QLLRvec &extrinsic_output);
 
   int n, K, m;
   ivec gen_pol, gen_pol_rev;
   int encoder_state, Nstates;
   double rate, Lc;
   imat state_trans, output_parity, rev_state_trans, rev_output_parity;
+  /*!
+    Next states and parity bits of eight trellis steps, one table of 256
+    entries per byte of the state and one for the eight inputs, to be
+    combined with XOR. Bit 8 * j + i of a parity word is parity bit j of
+    step i. Empty with more than eight parity bits per step.
+  */
+  ivec encode_state_table;
+  Vec<uint64_t> encode_parity_table;
   bool terminated;
   double ln2;
+  int window_length, warmup_length;
+  int nrof_subblocks;
+  //! State metrics at the sub-block boundaries from the previous call
+  mat sub_alpha, sub_beta;
+  QLLRmat sub_alpha_q, sub_beta_q;
 
   /*!
     This instance of an \c LLR_calc_unit contains the tables used for table lookup
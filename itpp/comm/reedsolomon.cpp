@@ -28,26 +28,11 @@
 
 #include <itpp/comm/reedsolomon.h>
 #include <itpp/base/math/log_exp.h>
+#include <algorithm>
 
 namespace itpp
 {
 
-//-------------------- Help Function ----------------------------
-
-//! Local help function
-GFX formal_derivate(const GFX &f)
-{
-  int degree = f.get_true_degree();
-  int q = f.get_size();
-  int i;
-  GFX fprim(q, degree);
-  fprim.clear();
-  for (i = 0; i <= degree - 1; i += 2) {
-    fprim[i] = f[i+1];
-  }
-  return fprim;
-}
-
 //-------------------- Reed-Solomon ----------------------------
 //A Reed-Solomon code is a q^m-ary BCH code of length n = pow(q,m)-1.
 //k = pow(q,m)-1-t. This class works for q==2.
@@ -64,47 +49,118 @@ Reed_Solomon::Reed_Solomon(int in_m, int in_t, bool sys):
     alphapow(0) = i;
     g *= (x - GFX(q, alphapow));
   }
+
+  // the tables of the field share the mapping of the GF class
+  field.set_size(q);
+  gen_poly.set_size(2 * t + 1);
+  for (int i = 0; i <= 2 * t; i++) {
+    gen_poly(i) = (g[i].get_value() == -1) ? 0
+                  : field.alpha_pow(g[i].get_value());
+  }
+
+  rx_buf.set_size(n);
+  msg_buf.set_size(k);
+  syndromes.set_size(2 * t);
+  lambda.set_size(2 * t + 1);
+  lambda_prev.set_size(2 * t + 1);
+  lambda_temp.set_size(2 * t + 1);
+  omega.set_size(2 * t);
+  chien_terms.set_size(2 * t + 1);
+  error_pos.set_size(2 * t);
 }
 
-void Reed_Solomon::encode(const bvec &uncoded_bits, bvec &coded_bits)
-{
-  int i, j, itterations = floor_i(static_cast<double>(uncoded_bits.length())
-                                  / (k * m));
-  GFX mx(q, k), cx(q, n);
-  GFX r(n + 1, n - k);
-  GFX uncoded_shifted(n + 1, n);
-  GF mpow;
-  bvec mbit(k*m), cbit(m);
+//! \cond
 
-  coded_bits.set_size(itterations*n*m, false);
+// Words per batch of the region based encoder and decoder
+static const int RS_batch_words = 256;
 
-  if (systematic)
-    for (i = 0; i < n - k; i++)
-      uncoded_shifted[i] = GF(n + 1, -1);
+//! \endcond
 
-  for (i = 0; i < itterations; i++) {
-    //Fix the message polynom m(x).
-    for (j = 0; j < k; j++) {
-      mpow.set(q, uncoded_bits.mid((i*m*k) + (j*m), m));
-      mx[j] = mpow;
-      if (systematic) {
-        cx[j] = mx[j];
-        uncoded_shifted[j+n-k] = mx[j];
+template<class T>
+void Reed_Solomon::encode_words(const bin *uncoded, bin *coded, int words)
+{
+  // symbol j of all the words is stored in row j
+  Vec<T> msg(k * words), code(n * words);
+  for (int w = 0; w < words; w++) {
+    const bin *in = uncoded + w * k * m;
+    for (int j = 0; j < k; j++) {
+      int symbol = 0;
+      for (int p = 0; p < m; p++) {
+        symbol = (symbol << 1) | static_cast<int>(in[j * m + p]);
       }
+      msg(j * words + w) = static_cast<T>(symbol);
     }
-    //Fix the outputbits cbit.
-    if (systematic) {
-      r = modgfx(uncoded_shifted, g);
-      for (j = k; j < n; j++) {
-        cx[j] = r[j-k];
+  }
+
+  if (systematic) {
+    // c(x) = m(x) + x^k r(x), with r(x) = x^(n-k) m(x) mod g(x), is a
+    // cyclic shift of the usual systematic codeword. The division runs
+    // as an LFSR on all the words, where register l is parity row
+    // (head + l) mod 2t, so the shift only moves head.
+    int nreg = 2 * t;
+    Vec<T> parity(nreg * words), feedback(words);
+    parity.zeros();
+    int head = 0;
+    for (int j = k - 1; j >= 0; j--) {
+      T *last = parity._data() + ((head + nreg - 1) % nreg) * words;
+      for (int w = 0; w < words; w++) {
+        feedback(w) = msg(j * words + w);
+      }
+      GF_Bulk::add_region(last, feedback._data(), words);
+      head = (head + nreg - 1) % nreg;
+      field.mul_region(feedback._data(), parity._data() + head * words,
+                       words, gen_poly(0));
+      for (int l = 1; l < nreg; l++) {
+        field.mul_add_region(feedback._data(),
+                             parity._data() + ((head + l) % nreg) * words,
+                             words, gen_poly(l));
       }
     }
-    else {
-      cx = g * mx;
+    for (int i = 0; i < k * words; i++) {
+      code(i) = msg(i);
+    }
+    for (int l = 0; l < nreg; l++) {
+      const T *reg = parity._data() + ((head + l) % nreg) * words;
+      for (int w = 0; w < words; w++) {
+        code((k + l) * words + w) = reg[w];
+      }
+    }
+  }
+  else {
+    // c(x) = g(x) m(x), one region per coefficient of g(x)
+    code.zeros();
+    for (int l = 0; l <= 2 * t; l++) {
+      field.mul_add_region(msg._data(), code._data() + l * words, k * words,
+                           gen_poly(l));
+    }
+  }
+
+  for (int w = 0; w < words; w++) {
+    bin *out = coded + w * n * m;
+    for (int j = 0; j < n; j++) {
+      int symbol = code(j * words + w);
+      for (int p = 0; p < m; p++) {
+        out[j * m + p] = (symbol >> (m - 1 - p)) & 1;
+      }
+    }
+  }
+}
+
+void Reed_Solomon::encode(const bvec &uncoded_bits, bvec &coded_bits)
+{
+  int itterations = floor_i(static_cast<double>(uncoded_bits.length())
+                            / (k * m));
+  coded_bits.set_size(itterations*n*m, false);
+
+  for (int i = 0; i < itterations; i += RS_batch_words) {
+    int words = std::min(RS_batch_words, itterations - i);
+    const bin *in = uncoded_bits._data() + i * k * m;
+    bin *out = coded_bits._data() + i * n * m;
+    if (m <= 8) {
+      encode_words<uint8_t>(in, out, words);
     }
-    for (j = 0; j < n; j++) {
-      cbit = cx[j].get_vectorspace();
-      coded_bits.replace_mid((i*n*m) + (j*m), cbit);
+    else {
+      encode_words<uint16_t>(in, out, words);
     }
   }
 }
@@ -116,120 +172,235 @@ bvec Reed_Solomon::encode(const bvec &uncoded_bits)
   return coded_bits;
 }
 
-void Reed_Solomon::decode(const bvec &coded_bits, bvec &decoded_bits)
+bool Reed_Solomon::decode_symbols(uint16_t *r)
 {
-  int j, i, kk, l, L, foundzeros, decoderfailure,
-  itterations = floor_i(static_cast<double>(coded_bits.length()) / (n * m));
-  bvec mbit(m*k);
-  decoded_bits.set_size(itterations*k*m, false);
+  int nsyn = 2 * t;
 
-  GFX rx(q, n - 1), cx(q, n - 1), mx(q, k - 1), ex(q, n - 1), S(q, 2*t), Lambda(q),
-  Lambdaprim(q), OldLambda(q), T(q), Ohmega(q);
-  GFX dummy(q), One(q, (char*)"0"), Ohmegatemp(q);
-  GF delta(q), tempsum(q), rtemp(q), temp(q), Xk(q), Xkinv(q);
-  ivec errorpos;
-
-  for (i = 0; i < itterations; i++) {
-    decoderfailure = false;
-    //Fix the received polynomial r(x)
-    for (j = 0; j < n; j++) {
-      rtemp.set(q, coded_bits.mid(i*n*m + j*m, m));
-      rx[j] = rtemp;
+  // Syndromes S_j = r(alpha^j), j = 1, ..., 2t. Each nonzero symbol r_i
+  // adds alpha^(log(r_i) + i j) to all of them, so the 2t sums are
+  // independent and the exponent only needs one conditional subtraction.
+  syndromes.zeros();
+  uint16_t *S = syndromes._data();
+  const uint16_t *alpha = field.alpha_pow_table();
+  for (int i = 0; i < n; i++) {
+    if (r[i] != 0) {
+      int e = field.log_alpha(r[i]);
+      for (int j = 0; j < nsyn; j++) {
+        e += i;
+        e -= (e >= n) ? n : 0; // branch-free, the outcome is random
+        S[j] ^= alpha[e];
+      }
     }
-    //Fix the syndrome polynomial S(x).
-    S.clear();
-    for (j = 1; j <= 2*t; j++) {
-      S[j] = rx(GF(q, j));
+  }
+  bool errors = false;
+  for (int j = 0; j < nsyn; j++) {
+    errors |= (S[j] != 0);
+  }
+  return errors ? correct_errors(r) : true;
+}
+
+bool Reed_Solomon::correct_errors(uint16_t *r)
+{
+  int nsyn = 2 * t;
+
+  // Berlekamp-Massey: error locator Lambda(x) of degree L
+  lambda.zeros();
+  lambda_prev.zeros();
+  lambda(0) = lambda_prev(0) = 1;
+  int L = 0, shift = 1;
+  uint16_t b = 1;
+  for (int kk = 0; kk < nsyn; kk++) {
+    uint16_t delta = syndromes(kk);
+    for (int l = 1; l <= L; l++) {
+      delta ^= field.mul(lambda(l), syndromes(kk - l));
     }
-    if (S.get_true_degree() == 0) {
-      cx = rx;
-      decoderfailure = false;
+    if (delta == 0) {
+      shift++;
+      continue;
     }
-    else {//Errors in the received word
-      //Itterate to find Lambda(x).
-      kk = 0;
-      Lambda = GFX(q, (char*)"0");
-      L = 0;
-      T = GFX(q, (char*)"-1 0");
-      while (kk < 2*t) {
-        kk = kk + 1;
-        tempsum = GF(q, -1);
-        for (l = 1; l <= L; l++) {
-          tempsum += Lambda[l] * S[kk-l];
+    // Lambda(x) -= delta / b x^shift B(x)
+    int scale = field.log_alpha(delta) + n - field.log_alpha(b);
+    if (2 * L <= kk) {
+      lambda_temp = lambda;
+      for (int l = shift; l <= nsyn; l++) {
+        if (lambda_prev(l - shift) != 0) {
+          lambda(l) ^= field.alpha_pow((field.log_alpha(lambda_prev(l - shift))
+                                        + scale) % n);
         }
-        delta = S[kk] - tempsum;
-        if (delta != GF(q, -1)) {
-          OldLambda = Lambda;
-          Lambda -= delta * T;
-          if (2*L < kk) {
-            L = kk - L;
-            T = OldLambda / delta;
-          }
+      }
+      L = kk + 1 - L;
+      lambda_prev = lambda_temp;
+      b = delta;
+      shift = 1;
+    }
+    else {
+      for (int l = shift; l <= nsyn; l++) {
+        if (lambda_prev(l - shift) != 0) {
+          lambda(l) ^= field.alpha_pow((field.log_alpha(lambda_prev(l - shift))
+                                        + scale) % n);
         }
-        T = GFX(q, (char*)"-1 0") * T;
       }
-      //Find the zeros to Lambda(x).
-      errorpos.set_size(Lambda.get_true_degree(), false);
-      errorpos.clear();
-      foundzeros = 0;
-      for (j = q - 2; j >= 0; j--) {
-        temp = Lambda(GF(q, j));
-        if (Lambda(GF(q, j)) == GF(q, -1)) {
-          errorpos(foundzeros) = (n - j) % n;
-          foundzeros += 1;
-          if (foundzeros >= Lambda.get_true_degree()) {
-            break;
-          }
+      shift++;
+    }
+  }
+  if ((L > t) || (lambda(L) == 0)) {
+    return false;
+  }
+
+  // Chien search: alpha^j is a root when alpha^(n-j) locates an error
+  int found = 0;
+  for (int l = 0; l <= L; l++) {
+    chien_terms(l) = lambda(l);
+  }
+  for (int j = 0; (j < n) && (found < L); j++) {
+    uint16_t sum = chien_terms(0);
+    for (int l = 1; l <= L; l++) {
+      if (chien_terms(l) != 0) {
+        if (j > 0) {
+          chien_terms(l) = field.alpha_pow(field.log_alpha(chien_terms(l)) + l % n);
         }
+        sum ^= chien_terms(l);
       }
-      if (foundzeros != Lambda.get_true_degree()) {
-        decoderfailure = false;
+    }
+    if (sum == 0) {
+      error_pos(found++) = j;
+    }
+  }
+  if (found != L) {
+    return false;
+  }
+
+  // Forney: e = Omega(X^-1) / Lambda'(X^-1), Omega(x) = Lambda(x) S(x) mod x^2t
+  for (int i = 0; i < nsyn; i++) {
+    uint16_t o = 0;
+    for (int l = 0; (l <= L) && (l <= i); l++) {
+      o ^= field.mul(lambda(l), syndromes(i - l));
+    }
+    omega(i) = o;
+  }
+  for (int e = 0; e < found; e++) {
+    int j = error_pos(e); // X^-1 = alpha^j
+    uint16_t num = 0, den = 0;
+    for (int i = nsyn - 1; i >= 0; i--) {
+      num = ((num == 0) ? 0 : field.alpha_pow(field.log_alpha(num) + j)) ^ omega(i);
+    }
+    // only the odd terms of Lambda(x) survive in the formal derivative
+    for (int l = 1; l <= L; l += 2) {
+      if (lambda(l) != 0) {
+        den ^= field.alpha_pow((field.log_alpha(lambda(l)) + j * (l - 1)) % n);
       }
-      else {
-        //Compute Ohmega(x) using the key equation for RS-decoding
-        Ohmega.set_degree(2*t);
-        Ohmegatemp = Lambda * (One + S);
-        for (j = 0; j <= 2*t; j++) {
-          Ohmega[j] = Ohmegatemp[j];
-        }
-        Lambdaprim = formal_derivate(Lambda);
-        //Find the error polynomial
-        ex.clear();
-        for (j = 0; j < foundzeros; j++) {
-          Xk = GF(q, errorpos(j));
-          Xkinv = GF(q, 0) / Xk;
-          ex[errorpos(j)] = (Xk * Ohmega(Xkinv)) / Lambdaprim(Xkinv);
-        }
-        //Reconstruct the corrected codeword.
-        cx = rx + ex;
-        //Code word validation
-        S.clear();
-        for (j = 1; j <= 2*t; j++) {
-          S[j] = rx(GF(q, j));
-        }
-        if (S.get_true_degree() >= 1) {
-          decoderfailure = false;
+    }
+    // the roots are simple, so den != 0
+    if (num != 0) {
+      r[(n - j) % n] ^= field.alpha_pow(field.log_alpha(num) + n
+                                        - field.log_alpha(den));
+    }
+  }
+  return true;
+}
+
+template<class T>
+void Reed_Solomon::decode_words(const bin *coded, bin *decoded, int words)
+{
+  // symbol i of all the words is stored in row i
+  Vec<T> rx(n * words), syn(2 * t * words);
+  for (int w = 0; w < words; w++) {
+    const bin *in = coded + w * n * m;
+    for (int j = 0; j < n; j++) {
+      int symbol = 0;
+      for (int p = 0; p < m; p++) {
+        symbol = (symbol << 1) | static_cast<int>(in[j * m + p]);
+      }
+      rx(j * words + w) = static_cast<T>(symbol);
+    }
+  }
+
+  // S_j = sum_i alpha^(i j) r_i, one region per term
+  syn.zeros();
+  for (int i = 0; i < n; i++) {
+    int e = 0;
+    for (int j = 0; j < 2 * t; j++) {
+      e += i;
+      e -= (e >= n) ? n : 0;
+      field.mul_add_region(rx._data() + i * words, syn._data() + j * words,
+                           words, field.alpha_pow(e));
+    }
+  }
+
+  for (int w = 0; w < words; w++) {
+    for (int j = 0; j < n; j++) {
+      rx_buf(j) = rx(j * words + w);
+    }
+    bool errors = false;
+    for (int j = 0; j < 2 * t; j++) {
+      syndromes(j) = syn(j * words + w);
+      errors |= (syndromes(j) != 0);
+    }
+    // A word that cannot be decoded is left as received
+    if (errors) {
+      correct_errors(rx_buf._data());
+    }
+    extract_message(decoded + w * k * m);
+  }
+}
+
+void Reed_Solomon::extract_message(bin *out)
+{
+  if (systematic) {
+    for (int j = 0; j < k; j++) {
+      msg_buf(j) = rx_buf(j);
+    }
+  }
+  else {
+    // m(x) = c(x) / g(x), where g(x) is monic of degree 2t
+    for (int j = n - 1; j >= 2 * t; j--) {
+      uint16_t coef = rx_buf(j);
+      msg_buf(j - 2 * t) = coef;
+      if (coef != 0) {
+        for (int l = 0; l < 2 * t; l++) {
+          rx_buf(j - 2 * t + l) ^= field.mul(coef, gen_poly(l));
         }
       }
     }
-    //Find the message polynomial
-    mbit.clear();
-    if (decoderfailure == false) {
-      if (cx.get_true_degree() >= 1) {// A nonzero codeword was transmitted
-        if (systematic) {
-          for (j = 0; j < k; j++) {
-            mx[j] = cx[j];
+  }
+  for (int j = 0; j < k; j++) {
+    for (int p = 0; p < m; p++) {
+      out[j * m + p] = (msg_buf(j) >> (m - 1 - p)) & 1;
+    }
+  }
+}
+
+void Reed_Solomon::decode(const bvec &coded_bits, bvec &decoded_bits)
+{
+  int itterations = floor_i(static_cast<double>(coded_bits.length()) / (n * m));
+  decoded_bits.set_size(itterations*k*m, false);
+
+  for (int i = 0; i < itterations; i += RS_batch_words) {
+    int words = std::min(RS_batch_words, itterations - i);
+    const bin *in = coded_bits._data() + i * n * m;
+    bin *out = decoded_bits._data() + i * k * m;
+    if (words < 16) {
+      // too few words for the region operations to pay off
+      for (int w = 0; w < words; w++) {
+        const bin *word = in + w * n * m;
+        for (int j = 0; j < n; j++) {
+          int symbol = 0;
+          for (int p = 0; p < m; p++) {
+            symbol = (symbol << 1) | static_cast<int>(word[j * m + p]);
           }
+          rx_buf(j) = static_cast<uint16_t>(symbol);
         }
-        else {
-          mx = divgfx(cx, g);
-        }
-        for (j = 0; j <= mx.get_true_degree(); j++) {
-          mbit.replace_mid(j*m, mx[j].get_vectorspace());
-        }
+        // A word that cannot be decoded is left as received
+        decode_symbols(rx_buf._data());
+        extract_message(out + w * k * m);
       }
     }
-    decoded_bits.replace_mid(i*m*k, mbit);
+    else if (m <= 8) {
+      decode_words<uint8_t>(in, out, words);
+    }
+    else {
+      decode_words<uint16_t>(in, out, words);
+    }
   }
 }
 
@@ -30,6 +30,7 @@
 #define REEDSOLOMON_H
 
 #include <itpp/base/vec.h>
+#include <itpp/base/ittypes.h>
 #include <itpp/comm/galois.h>
 #include <itpp/comm/channel_code.h>
 
@@ -47,6 +48,13 @@ namespace itpp
   "Error Control Systems for digital communication and storage," Prentice Hall.
 
   The code is \f$2^m\f$ - ary of length \f$2^m-1\f$ capable of correcting \f$t\f$ errors.
+
+  The encoder and decoder work directly on arrays of field elements with
+  log/antilog tables and preallocated buffers. Decoding uses syndromes
+  (words with all-zero syndromes are accepted at once), Berlekamp-Massey,
+  Chien search and the Forney algorithm. A word that cannot be decoded is
+  left as received. Batches of words are encoded, and their syndromes
+  computed, with the GF_Bulk region operations.
 */
 class Reed_Solomon : public Channel_Code
 {
@@ -56,6 +64,11 @@ public:
   //! Destructor
   virtual ~Reed_Solomon() { }
 
+  //! Encode a packed binary vector (see Channel_Code)
+  using Channel_Code::encode;
+  //! Decode a packed binary vector (see Channel_Code)
+  using Channel_Code::decode;
+
   //! Encoder function.
   virtual void encode(const bvec &uncoded_bits, bvec &coded_bits);
   //! Encoder function.
@@ -73,6 +86,9 @@ public:
   //! Gets the rate of the RS-code.
   virtual double get_rate() const { return static_cast<double>(k) / n; }
 
+  //! Create a copy of the codec (used by \c decode_batch())
+  virtual Channel_Code *clone() const { return new Reed_Solomon(*this); }
+
   //! Dummy assignment operator - MSVC++ warning C4512
   Reed_Solomon & operator=(const Reed_Solomon &) { return *this; }
 
@@ -85,6 +101,33 @@ protected:
   GFX g;
   //! Whether or not the code is systematic
   const bool systematic;
+
+  /*! \name Table-driven encoder and decoder
+    Field elements are stored as integers in the vector space
+    representation of GF::get_vectorspace().
+    @{ */
+  //! Coefficients of the generator polynomial
+  Vec<uint16_t> gen_poly;
+  //! Working buffers of the encoder and decoder
+  Vec<uint16_t> rx_buf, msg_buf, syndromes, lambda, lambda_prev, lambda_temp,
+  omega, chien_terms;
+  //! Error positions found by the Chien search
+  ivec error_pos;
+  //! Field arithmetic (tables of alpha, products, batches of words)
+  GF_Bulk field;
+  //! Correct the errors in the received word \a r in place. Returns false on a decoder failure.
+  bool decode_symbols(uint16_t *r);
+  //! Correct the errors of \a r in place, given its nonzero syndromes
+  bool correct_errors(uint16_t *r);
+  //! Encode a batch of words, stored symbol by symbol in arrays of T
+  template<class T>
+  void encode_words(const bin *uncoded, bin *coded, int words);
+  //! Decode a batch of words, with their syndromes computed by region operations
+  template<class T>
+  void decode_words(const bin *coded, bin *decoded, int words);
+  //! Write the message bits of the corrected word in \c rx_buf to \a out
+  void extract_message(bin *out);
+  /*! @} */
 };
 
 } // namespace itpp
@@ -28,6 +28,7 @@ h_comm_sources = \
 
 cpp_comm_sources = \
 	$(top_srcdir)/itpp/comm/bch.cpp \
+	$(top_srcdir)/itpp/comm/channel_code.cpp \
 	$(top_srcdir)/itpp/comm/channel.cpp \
 	$(top_srcdir)/itpp/comm/commfunc.cpp \
 	$(top_srcdir)/itpp/comm/convcode.cpp \
@@ -27,6 +27,7 @@
  */
 
 #include <itpp/comm/turbo.h>
+#include <algorithm>
 
 
 namespace itpp
@@ -42,6 +43,7 @@ void Turbo_Codec::set_parameters(ivec gen1, ivec gen2, int constraint_length, co
   Nuncoded            = interleaver_size;
   logmax_scale_factor = in_logmax_scale_factor;
   adaptive_stop       = in_adaptive_stop;
+  reset_iteration_histogram();
 
   //Check the decoding metric
   if (in_metric == "LOGMAX") {
@@ -56,12 +58,15 @@ void Turbo_Codec::set_parameters(ivec gen1, ivec gen2, int constraint_length, co
   else if (in_metric == "TABLE") {
     metric = "TABLE";
   }
+  else if (in_metric == "LOGMAX16") {
+    metric = "LOGMAX16";
+  }
   else {
-    it_error("Turbo_Codec::set_parameters: The decoder metric must be either MAP, LOGMAP or LOGMAX");
+    it_error("Turbo_Codec::set_parameters: The decoder metric must be either MAP, LOGMAP, LOGMAX, TABLE or LOGMAX16");
   }
 
   if (logmax_scale_factor != 1.0) {
-    it_assert(metric == "LOGMAX", "Turbo_Codec::set_parameters: logmax_scale_factor can only be used together with LOGMAX decoding");
+    it_assert((metric == "LOGMAX") || (metric == "LOGMAX16"), "Turbo_Codec::set_parameters: logmax_scale_factor can only be used together with LOGMAX decoding");
   }
 
   //The RSC Encoders:
@@ -107,7 +112,8 @@ void Turbo_Codec::set_interleaver(const ivec &interleaver_sequence)
   float_interleaver.set_interleaver_sequence(interleaver_sequence);
 }
 
-void Turbo_Codec::set_metric(std::string in_metric, double in_logmax_scale_factor, LLR_calc_unit in_llrcalc)
+void Turbo_Codec::set_metric(std::string in_metric, double in_logmax_scale_factor, LLR_calc_unit in_llrcalc,
+                             int in_window_length, int in_warmup_length)
 {
   logmax_scale_factor = in_logmax_scale_factor;
 
@@ -124,17 +130,29 @@ void Turbo_Codec::set_metric(std::string in_metric, double in_logmax_scale_facto
   else if (in_metric == "TABLE") {
     metric = "TABLE";
   }
+  else if (in_metric == "LOGMAX16") {
+    metric = "LOGMAX16";
+  }
   else {
-    it_error("Turbo_Codec::set_metric: The decoder metric must be either MAP, LOGMAP or LOGMAX");
+    it_error("Turbo_Codec::set_metric: The decoder metric must be either MAP, LOGMAP, LOGMAX, TABLE or LOGMAX16");
   }
 
   rscc1.set_llrcalc(in_llrcalc);
   rscc2.set_llrcalc(in_llrcalc);
+  rscc1.set_window(in_window_length, in_warmup_length);
+  rscc2.set_window(in_window_length, in_warmup_length);
+}
+
+void Turbo_Codec::set_subblocks(int in_nrof_subblocks)
+{
+  rscc1.set_subblocks(in_nrof_subblocks);
+  rscc2.set_subblocks(in_nrof_subblocks);
 }
 
 void Turbo_Codec::set_iterations(int in_iterations)
 {
   iterations = in_iterations;
+  reset_iteration_histogram();
 }
 
 void Turbo_Codec::set_adaptive_stop(bool in_adaptive_stop)
@@ -142,6 +160,26 @@ void Turbo_Codec::set_adaptive_stop(bool in_adaptive_stop)
   adaptive_stop = in_adaptive_stop;
 }
 
+void Turbo_Codec::set_crc_stop(const CRC_Code &crc)
+{
+  crc_code = crc;
+  crc_stop = true;
+}
+
+void Turbo_Codec::reset_iteration_histogram()
+{
+  iteration_histogram.set_size(iterations, false);
+  iteration_histogram.zeros();
+}
+
+void Turbo_Codec::update_iteration_histogram(int nrof_used_iterations_i)
+{
+  if (nrof_used_iterations_i > iteration_histogram.size()) {
+    iteration_histogram.set_size(nrof_used_iterations_i, true);
+  }
+  iteration_histogram(nrof_used_iterations_i - 1)++;
+}
+
 void Turbo_Codec::set_awgn_channel_parameters(double in_Ec, double in_N0)
 {
   Ec = in_Ec;
@@ -209,6 +247,48 @@ void Turbo_Codec::decode(const vec &received_signal, bvec &decoded_bits, const b
   decode(received_signal, decoded_bits, nrof_used_iterations, true_bits);
 }
 
+void Turbo_Codec::decode_batch(const Array<vec> &received_signals, Array<bvec> &decoded_bits, int nthreads)
+{
+  it_assert(nthreads > 0, "Turbo_Codec::decode_batch(): Number of threads must be positive");
+  int nblocks = received_signals.size();
+  decoded_bits.set_size(nblocks);
+
+  nthreads = std::min(nthreads, nblocks);
+  if (nthreads <= 1) {
+    for (int i = 0; i < nblocks; i++) {
+      decode(received_signals(i), decoded_bits(i));
+    }
+    return;
+  }
+
+  // The decoder keeps its working storage in member variables, so each
+  // worker decodes with its own copy of the codec
+  Array<Turbo_Codec *> workers(nthreads);
+  for (int t = 0; t < nthreads; t++) {
+    workers(t) = new Turbo_Codec(*this);
+    workers(t)->reset_iteration_histogram();
+  }
+
+  int t;
+#pragma omp parallel for private(t) num_threads(nthreads) schedule(static, 1)
+  for (t = 0; t < nthreads; t++) {
+    for (int i = t; i < nblocks; i += nthreads) {
+      workers(t)->decode(received_signals(i), decoded_bits(i));
+    }
+  }
+
+  for (t = 0; t < nthreads; t++) {
+    const ivec &hist = workers(t)->iteration_histogram;
+    if (hist.size() > iteration_histogram.size()) {
+      iteration_histogram.set_size(hist.size(), true);
+    }
+    for (int n = 0; n < hist.size(); n++) {
+      iteration_histogram(n) += hist(n);
+    }
+    delete workers(t);
+  }
+}
+
 void Turbo_Codec::decode(const vec &received_signal, bvec &decoded_bits, ivec &nrof_used_iterations,
                          const bvec &true_bits)
 {
@@ -354,6 +434,8 @@ void Turbo_Codec::decode_block(const vec &rec_syst1, const vec &rec_syst2, const
   Le12.set_size(Nuncoded + m_tail, false);
   Le21.set_size(Nuncoded + m_tail, false);
   Le21.zeros();
+  rscc1.reset_subblock_metrics();
+  rscc2.reset_subblock_metrics();
 
   //Calculate the interleaved and the deinterleaved sequences:
   float_interleaver.interleave(rec_syst1.left(interleaver_size), int_rec_syst1);
@@ -393,7 +475,7 @@ void Turbo_Codec::decode_block(const vec &rec_syst1, const vec &rec_syst2, const
     if (metric == "MAP") {
       rscc1.map_decode(rec_syst, rec_parity1, Le21, Le12, true);
     }
-    else if ((metric == "LOGMAX") || (metric == "LOGMAP") || (metric == "TABLE")) {
+    else if ((metric == "LOGMAX") || (metric == "LOGMAP") || (metric == "TABLE") || (metric == "LOGMAX16")) {
       rscc1.log_decode(rec_syst, rec_parity1, Le21, Le12, true, metric);
       if (logmax_scale_factor != 1.0) {
         Le12 *= logmax_scale_factor;
@@ -411,7 +493,7 @@ void Turbo_Codec::decode_block(const vec &rec_syst1, const vec &rec_syst2, const
     if (metric == "MAP") {
       rscc2.map_decode(int_rec_syst, rec_parity2, Le12_int, Le21_int, true);
     }
-    else if ((metric == "LOGMAX") || (metric == "LOGMAP")  || (metric == "TABLE")) {
+    else if ((metric == "LOGMAX") || (metric == "LOGMAP") || (metric == "TABLE") || (metric == "LOGMAX16")) {
       rscc2.log_decode(int_rec_syst, rec_parity2, Le12_int, Le21_int, true, metric);
       if (logmax_scale_factor != 1.0) {
         Le21_int *= logmax_scale_factor;
@@ -447,6 +529,10 @@ void Turbo_Codec::decode_block(const vec &rec_syst1, const vec &rec_syst2, const
         for (k = 0; k < Nuncoded; k++) { if (decoded_bits_i(i - 1, k) != decoded_bits_i(i, k)) { CONTINUE = true; break; } }
       }
 
+      if ((crc_stop) && (CONTINUE) && crc_code.check_parity(decoded_bits_i.get_row(i))) {
+        CONTINUE = false;
+      }
+
     }
 
     //Check if iterations shall continue:
@@ -461,6 +547,7 @@ void Turbo_Codec::decode_block(const vec &rec_syst1, const vec &rec_syst2, const
 
   }
 
+  update_iteration_histogram(nrof_used_iterations_i);
 }
 
 void Turbo_Codec::decode_n3(const vec &received_signal, bvec &decoded_bits, ivec &nrof_used_iterations,
@@ -514,6 +601,8 @@ void Turbo_Codec::decode_n3(const vec &received_signal, bvec &decoded_bits, ivec
 
     //Reset extrinsic data:
     Le21.zeros();
+    rscc1.reset_subblock_metrics();
+    rscc2.reset_subblock_metrics();
 
     //The data part:
     for (k = 0; k < Nuncoded; k++) {
@@ -587,6 +676,14 @@ void Turbo_Codec::decode_n3(const vec &received_signal, bvec &decoded_bits, ivec
         }
       }
 
+      if ((crc_stop) && (CONTINUE) && (j < (iterations - 1))) {
+        L = rec_syst1.left(Nuncoded) + Le21.left(Nuncoded) + Le12.left(Nuncoded);
+        for (l = 0; l < Nuncoded; l++) {(L(l) > 0.0) ? (temp_decoded_bits(l) = bin(0)) : (temp_decoded_bits(l) = bin(1)); }
+        if (crc_code.check_parity(temp_decoded_bits)) {
+          CONTINUE = false;
+        }
+      }
+
       if (CONTINUE == false) { nrof_used_iterations_i = j + 1; break; }
 
     }
@@ -599,6 +696,7 @@ void Turbo_Codec::decode_n3(const vec &received_signal, bvec &decoded_bits, ivec
     }
 
     nrof_used_iterations(i) = nrof_used_iterations_i;
+    update_iteration_histogram(nrof_used_iterations_i);
 
   }
 
@@ -806,4 +904,65 @@ ivec wcdma_turbo_interleaver_sequence(int interleaver_size)
   }
 }
 
+ivec lte_turbo_interleaver_sequence(int interleaver_size)
+{
+  // The block sizes K and the QPP coefficients f1 and f2 of 3GPP TS 36.212, Table 5.1.3-3
+  static const int lte_qpp_table[188][3] = {
+    {40, 3, 10}, {48, 7, 12}, {56, 19, 42}, {64, 7, 16}, {72, 7, 18}, {80, 11, 20},
+    {88, 5, 22}, {96, 11, 24}, {104, 7, 26}, {112, 41, 84}, {120, 103, 90}, {128, 15, 32},
+    {136, 9, 34}, {144, 17, 108}, {152, 9, 38}, {160, 21, 120}, {168, 101, 84}, {176, 21, 44},
+    {184, 57, 46}, {192, 23, 48}, {200, 13, 50}, {208, 27, 52}, {216, 11, 36}, {224, 27, 56},
+    {232, 85, 58}, {240, 29, 60}, {248, 33, 62}, {256, 15, 32}, {264, 17, 198}, {272, 33, 68},
+    {280, 103, 210}, {288, 19, 36}, {296, 19, 74}, {304, 37, 76}, {312, 19, 78}, {320, 21, 120},
+    {328, 21, 82}, {336, 115, 84}, {344, 193, 86}, {352, 21, 44}, {360, 133, 90}, {368, 81, 46},
+    {376, 45, 94}, {384, 23, 48}, {392, 243, 98}, {400, 151, 40}, {408, 155, 102}, {416, 25, 52},
+    {424, 51, 106}, {432, 47, 72}, {440, 91, 110}, {448, 29, 168}, {456, 29, 114}, {464, 247, 58},
+    {472, 29, 118}, {480, 89, 180}, {488, 91, 122}, {496, 157, 62}, {504, 55, 84}, {512, 31, 64},
+    {528, 17, 66}, {544, 35, 68}, {560, 227, 420}, {576, 65, 96}, {592, 19, 74}, {608, 37, 76},
+    {624, 41, 234}, {640, 39, 80}, {656, 185, 82}, {672, 43, 252}, {688, 21, 86}, {704, 155, 44},
+    {720, 79, 120}, {736, 139, 92}, {752, 23, 94}, {768, 217, 48}, {784, 25, 98}, {800, 17, 80},
+    {816, 127, 102}, {832, 25, 52}, {848, 239, 106}, {864, 17, 48}, {880, 137, 110}, {896, 215, 112},
+    {912, 29, 114}, {928, 15, 58}, {944, 147, 118}, {960, 29, 60}, {976, 59, 122}, {992, 65, 124},
+    {1008, 55, 84}, {1024, 31, 64}, {1056, 17, 66}, {1088, 171, 204}, {1120, 67, 140}, {1152, 35, 72},
+    {1184, 19, 74}, {1216, 39, 76}, {1248, 19, 78}, {1280, 199, 240}, {1312, 21, 82}, {1344, 211, 252},
+    {1376, 21, 86}, {1408, 43, 88}, {1440, 149, 60}, {1472, 45, 92}, {1504, 49, 846}, {1536, 71, 48},
+    {1568, 13, 28}, {1600, 17, 80}, {1632, 25, 102}, {1664, 183, 104}, {1696, 55, 954}, {1728, 127, 96},
+    {1760, 27, 110}, {1792, 29, 112}, {1824, 29, 114}, {1856, 57, 116}, {1888, 45, 354}, {1920, 31, 120},
+    {1952, 59, 610}, {1984, 185, 124}, {2016, 113, 420}, {2048, 31, 64}, {2112, 17, 66}, {2176, 171, 136},
+    {2240, 209, 420}, {2304, 253, 216}, {2368, 367, 444}, {2432, 265, 456}, {2496, 181, 468}, {2560, 39, 80},
+    {2624, 27, 164}, {2688, 127, 504}, {2752, 143, 172}, {2816, 43, 88}, {2880, 29, 300}, {2944, 45, 92},
+    {3008, 157, 188}, {3072, 47, 96}, {3136, 13, 28}, {3200, 111, 240}, {3264, 443, 204}, {3328, 51, 104},
+    {3392, 51, 212}, {3456, 451, 192}, {3520, 257, 220}, {3584, 57, 336}, {3648, 313, 228}, {3712, 271, 232},
+    {3776, 179, 236}, {3840, 331, 120}, {3904, 363, 244}, {3968, 375, 248}, {4032, 127, 168}, {4096, 31, 64},
+    {4160, 33, 130}, {4224, 43, 264}, {4288, 33, 134}, {4352, 477, 408}, {4416, 35, 138}, {4480, 233, 280},
+    {4544, 357, 142}, {4608, 337, 480}, {4672, 37, 146}, {4736, 71, 444}, {4800, 71, 120}, {4864, 37, 152},
+    {4928, 39, 462}, {4992, 127, 234}, {5056, 39, 158}, {5120, 39, 80}, {5184, 31, 96}, {5248, 113, 902},
+    {5312, 41, 166}, {5376, 251, 336}, {5440, 43, 170}, {5504, 21, 86}, {5568, 43, 174}, {5632, 45, 176},
+    {5696, 45, 178}, {5760, 161, 120}, {5824, 89, 182}, {5888, 323, 184}, {5952, 47, 186}, {6016, 23, 94},
+    {6080, 47, 190}, {6144, 263, 480}
+  };
+
+  int i = 0;
+  while ((i < 188) && (lte_qpp_table[i][0] != interleaver_size)) { i++; }
+  it_assert(i < 188, "lte_turbo_interleaver_sequence: The interleaver size is not an LTE block size");
+
+  // pi(k) = (f1*k + f2*k^2) mod K, computed recursively without multiplications:
+  // pi(k+1) = pi(k) + g(k) and g(k+1) = g(k) + 2*f2, where g(0) = f1 + f2
+  int K = interleaver_size;
+  int f1 = lte_qpp_table[i][1];
+  int f2 = lte_qpp_table[i][2];
+  int step2 = (2 * f2) % K;
+  int g = (f1 + f2) % K;
+  int pi = 0;
+  ivec I(K);
+  for (int k = 0; k < K; k++) {
+    I(k) = pi;
+    pi += g;
+    if (pi >= K) { pi -= K; }
+    g += step2;
+    if (g >= K) { g -= K; }
+  }
+  return I;
+}
+
 } // namespace itpp
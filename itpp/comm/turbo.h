@@ -32,6 +32,7 @@
 #include <itpp/comm/rec_syst_conv_code.h>
 #include <itpp/comm/interleave.h>
 #include <itpp/comm/llr.h>
+#include <itpp/comm/crc.h>
 
 
 namespace itpp
@@ -56,7 +57,7 @@ class Turbo_Codec
 public:
 
   //! Class constructor
-  Turbo_Codec(void) {}
+  Turbo_Codec(void) : crc_stop(false) {}
 
   //! Class destructor
   virtual ~Turbo_Codec(void) {}
@@ -69,12 +70,14 @@ public:
     \param constraint_length The constraint length of the two constituent encoders
     \param interleaver_sequence An ivec defining the internal turbo interleaver.
     \param in_iterations The number of decoding iterations. Default value is 8.
-    \param in_metric Determines the decoder metric: "MAP", LOGMAP", "LOGMAX", or "TABLE". The default is "LOGMAX".
+    \param in_metric Determines the decoder metric: "MAP", LOGMAP", "LOGMAX", "TABLE" or "LOGMAX16". The default is "LOGMAX".
+    "LOGMAX16" is a fixed-point LOGMAX decoder that updates all eight states of a constraint length 4 code (as in
+    3GPP) at once with 16-bit SIMD arithmetic, see Rec_Syst_Conv_Code::log_decode_n2().
     \param in_logmax_scale_factor The extrinsic information from each constituent decoder is to optimistic when
     LOGMAX decoding is used.
     This parameter allows for a down-scaling of the extrinsic information that will be passed on to the next decoder.
     The default value
-    is 1.0. This parameter is ignored for other metrics than "LOGMAX".
+    is 1.0. This parameter is ignored for other metrics than "LOGMAX" and "LOGMAX16".
     \param in_adaptive_stop If this parameter is true, then the iterations will stop if the decoding results after one
     full iteration equals the previous iteration. Default value is false.
 
@@ -100,17 +103,35 @@ public:
   /*!
     \brief Set the decoder metric
 
-    \param in_metric Determines the decoder metric: "MAP", LOGMAP", "LOGMAX", or "TABLE". The default is "LOGMAX".
+    \param in_metric Determines the decoder metric: "MAP", LOGMAP", "LOGMAX", "TABLE" or "LOGMAX16". The default is "LOGMAX".
+    "LOGMAX16" is a fixed-point LOGMAX decoder that updates all eight states of a constraint length 4 code (as in
+    3GPP) at once with 16-bit SIMD arithmetic, see Rec_Syst_Conv_Code::log_decode_n2().
     \param in_logmax_scale_factor The extrinsic information from each constituent decoder is to optimistic when
     LOGMAX decoding is used.
     This parameter allows for a down-scaling of the extrinsic information that will be passed on to the next decoder.
-    The default value is 1.0. This parameter is ignored for other metrics than "LOGMAX".
+    The default value is 1.0. This parameter is ignored for other metrics than "LOGMAX" and "LOGMAX16".
 
     \param lcalc This parameter can be used to provide a specific \c LLR_calc_unit which defines the resolution in
     the table-lookup if decoding with the metric "TABLE" is used.
+
+    \param window_length If larger than zero, the constituent decoders use a sliding-window BCJR with windows of
+    this many trellis steps, which bounds their memory use for long blocks (see
+    Rec_Syst_Conv_Code::set_window()). The default value 0 decodes each block at once. Not used with "MAP".
+    \param warmup_length The number of trellis steps used to warm up the backward recursion of each window.
   */
   void set_metric(std::string in_metric = "LOGMAX", double in_logmax_scale_factor = 1.0,
-                  LLR_calc_unit lcalc = LLR_calc_unit());
+                  LLR_calc_unit lcalc = LLR_calc_unit(), int window_length = 0,
+                  int warmup_length = 32);
+
+  /*!
+    \brief Decode each constituent code in parallel sub-blocks
+
+    The trellis of each constituent decoder is split into \a nrof_subblocks sub-blocks, which are decoded
+    concurrently (when OpenMP is enabled). The state metrics at the sub-block boundaries are exchanged between
+    iterations, see Rec_Syst_Conv_Code::set_subblocks(). A few extra iterations may be needed to reach the
+    performance of the default, whole-block decoding (\a nrof_subblocks = 1).
+  */
+  void set_subblocks(int nrof_subblocks = 1);
 
   /*!
     \brief Sets the number of decoding iterations. Default value is 8.
@@ -125,6 +146,33 @@ public:
   */
   void set_adaptive_stop(bool in_adaptive_stop = true);
 
+  /*!
+    \brief Stop the iterations as soon as the decoded block passes a CRC check
+
+    After each full iteration the hard decisions of the \a Nuncoded data bits are checked with \a crc, i.e. every
+    code block is assumed to end with the parity bits added by CRC_Code::encode(). The iterations stop as soon as
+    the check passes, which at high SNR typically happens after one or two iterations. Unlike the adaptive stop
+    criterion, no extra iteration is needed to detect convergence. The CRC check can be combined with the adaptive
+    stop criterion and with the \c true_bits argument of the decoder functions; the iterations then stop as soon
+    as any of them is met.
+  */
+  void set_crc_stop(const CRC_Code &crc);
+
+  //! Do not use a CRC check to stop the iterations (the default)
+  void clear_crc_stop() { crc_stop = false; }
+
+  /*!
+    \brief Returns the number of iterations used by the decoded blocks
+
+    Element \a i holds the number of code blocks that were decoded with \a i + 1 iterations since the last call
+    to set_parameters(), set_iterations() or reset_iteration_histogram(). All decoder functions, including
+    decode_block(), update the histogram.
+  */
+  ivec get_iteration_histogram() const { return iteration_histogram; }
+
+  //! Sets all the elements of the iteration histogram to zero
+  void reset_iteration_histogram();
+
   /*!
     \brief Set parameters for decoding on an AWGN channel
 
@@ -206,6 +254,18 @@ public:
   virtual void decode(const vec &received_signal, bvec &decoded_bits, ivec &nrof_used_iterations,
                       const bvec &true_bits = "0");
 
+  /*!
+    \brief Decode a batch of received blocks using several threads
+
+    Each element of \c received_signals is decoded with \c decode() and
+    the result is stored in the same element of \c decoded_bits. As in
+    \c Channel_Code::decode_batch(), the blocks are shared out among
+    \c nthreads workers, each of them decoding with its own copy of the
+    codec. The workers are run in parallel only if IT++ is compiled with
+    OpenMP support.
+  */
+  void decode_batch(const Array<vec> &received_signals, Array<bvec> &decoded_bits, int nthreads = 1);
+
   /*!
     \brief Encode a single block
 
@@ -270,21 +330,26 @@ private:
   void decode_n3(const vec &received_signal, bvec &decoded_bits, ivec &nrof_used_iterations,
                  const bvec &true_bits = "0");
 
+  //! Adds a decoded block to the iteration histogram
+  void update_iteration_histogram(int nrof_used_iterations_i);
+
   //Scalars:
   int interleaver_size;
   int Ncoded, Nuncoded;
   int m_tail, n1, n2, n_tot, iterations;
   double Ec, N0, Lc, R, logmax_scale_factor;
-  bool adaptive_stop;
+  bool adaptive_stop, crc_stop;
   std::string metric;
 
   //Vectors:
   bvec decoded_bits_previous_iteration;
+  ivec iteration_histogram;
 
   //Classes:
   Rec_Syst_Conv_Code rscc1, rscc2;
   Sequence_Interleaver<bin> bit_interleaver;
   Sequence_Interleaver<double> float_interleaver;
+  CRC_Code crc_code;
 };
 
 /*!
@@ -293,6 +358,18 @@ private:
 */
 ivec wcdma_turbo_interleaver_sequence(int interleaver_size);
 
+/*!
+  \relatesalso Turbo_Codec
+  \brief Generates the quadratic permutation polynomial (QPP) interleaver sequence used in LTE
+
+  The sequence is \f$ \pi(k) = (f_1 k + f_2 k^2) \bmod K \f$, with the coefficients of 3GPP TS 36.212
+  for the 188 LTE block sizes \a K = \a interleaver_size from 40 to 6144. It is computed with additions only.
+
+  A QPP interleaver is contention-free for any number of sub-blocks that divides \a K, so it is the natural
+  choice together with Turbo_Codec::set_subblocks().
+*/
+ivec lte_turbo_interleaver_sequence(int interleaver_size);
+
 } // namespace itpp
 
 #endif // #ifndef TURBO_H
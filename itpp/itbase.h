@@ -117,6 +117,7 @@
 #include <itpp/base/mat.h>
 #include <itpp/base/matfunc.h>
 #include <itpp/base/operators.h>
+#include <itpp/base/packed_bvec.h>
 #include <itpp/base/parser.h>
 #include <itpp/base/random.h>
 #include <itpp/base/smat.h>
@@ -110,5 +110,38 @@ int main()
     }
   }
 
+  cout << "========================================" << endl;
+  cout << "   Batch decoding test                  " << endl;
+  cout << "========================================" << endl;
+
+  {
+    BCH bch(31, 2);
+    Array<bvec> coded(10);
+    for (int i = 0; i < coded.size(); i++) {
+      coded(i) = set_errors(bch.encode(randb(21)), randi(2, 0, 30));
+    }
+
+    Array<bvec> decoded, decoded_mt;
+    bch.decode_batch(coded, decoded);
+    bch.decode_batch(coded, decoded_mt, 3);
+    for (int i = 0; i < coded.size(); i++) {
+      cout << "Decoded to:" << decoded(i) << ", equal = "
+           << (decoded_mt(i) == decoded(i)) << endl;
+    }
+  }
+
+  cout << "========================================" << endl;
+  cout << "   High-rate code test                  " << endl;
+  cout << "========================================" << endl;
+
+  {
+    BCH bch(255, 4, true);
+    bvec input = randb(5 * bch.get_k());
+    bvec encoded = bch.encode(input);
+    cout << "Error-free words decoded: " << (bch.decode(encoded) == input) << endl;
+    bvec err = set_errors(encoded, "3 100 254 300 301 509 600 700 701 702 1000 1001 1002 1003");
+    cout << "Up to 4 errors per word decoded: " << (bch.decode(err) == input) << endl;
+  }
+
   return 0;
 }
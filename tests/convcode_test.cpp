@@ -147,6 +147,33 @@ int main()
   cout << "Puncture matrix   = " << code_punct.get_puncture_matrix() << endl
        << endl;
 
+  code_punct.calculate_spectrum(spectrum_punct, 5, 6);
+  code_punct.fast(spectrum_punct_fast, 0, 5, 6);
+
+  int dfree_punct = 0;
+  while (spectrum_punct(0)(dfree_punct) == 0)
+    dfree_punct++;
+  cout << "Free distance     = " << dfree_punct << endl;
+  cout << "Spectrum (all start positions):" << endl;
+  cout << "* Ad = " << spectrum_punct(0) << endl;
+  cout << "* Cd = " << spectrum_punct(1) << endl;
+  cout << "Spectrum, fast (start position 0):" << endl;
+  cout << "* Ad = " << spectrum_punct_fast(0) << endl;
+  cout << "* Cd = " << spectrum_punct_fast(1) << endl << endl;
+
+  // K = 9 with this puncturing has a zero-weight cycle, so the spectrum
+  // search must give up rather than follow it forever
+  Punctured_Convolutional_Code code_cat;
+  ivec G9(2);
+  G9(0) = 0561;
+  G9(1) = 0753;
+  code_cat.set_generator_polynomials(G9, 9);
+  code_cat.set_puncture_matrix(punct_matrix);
+  Array<ivec> spectrum_cat;
+  bool spectrum_found = code_cat.calculate_spectrum(spectrum_cat, 5, 6);
+  cout << "K = 9: catastrophic test = " << code_cat.catastrophic()
+       << ", spectrum found = " << spectrum_found << endl << endl;
+
   cout << "Tail method test. Printing 30 bits starting from bit 1400:" << endl;
   bits = randb(no_bits);
   cout << "* Input bits    = " << bits.mid(1400, 30) << endl;
@@ -217,5 +244,224 @@ int main()
   berc.count(uncoded, decoded);
   cout << "BER = " << berc.get_errorrate() << endl << endl;
 
+  cout << "------------------------------------------------------------------------------" << endl;
+  cout << "4) Fixed-point and floating point Viterbi decoding" << endl;
+  cout << "------------------------------------------------------------------------------" << endl;
+
+  code.set_generator_polynomials(G, L);
+  bits = randb(no_bits);
+  bpsk.modulate_bits(code.encode_tail(bits), symbols);
+  symbols += 0.8 * randn(symbols.size());
+  code.set_fixed_point_viterbi(false);
+  bvec float_decoded_bits = code.decode_tail(symbols);
+  code.set_fixed_point_viterbi(true);
+  tail_decoded_bits = code.decode_tail(symbols);
+  berc.clear();
+  berc.count(bits, tail_decoded_bits);
+  cout << "Tail: errors = " << berc.get_errors() << ", equal = "
+       << (tail_decoded_bits == float_decoded_bits) << endl;
+
+  // a single large sample must not take the resolution of all the others
+  vec outlier_symbols = symbols;
+  outlier_symbols(100) *= 1000.0;
+  code.set_fixed_point_viterbi(false);
+  float_decoded_bits = code.decode_tail(outlier_symbols);
+  code.set_fixed_point_viterbi(true);
+  tail_decoded_bits = code.decode_tail(outlier_symbols);
+  berc.clear();
+  berc.count(bits, tail_decoded_bits);
+  cout << "Tail with an outlier: errors = " << berc.get_errors()
+       << ", equal = " << (tail_decoded_bits == float_decoded_bits) << endl;
+
+  bits = randb(60);
+  bpsk.modulate_bits(code.encode_tailbite(bits), symbols);
+  symbols += 0.8 * randn(symbols.size());
+  code.set_fixed_point_viterbi(false);
+  float_decoded_bits = code.decode_tailbite(symbols);
+  code.set_fixed_point_viterbi(true);
+  tailbite_decoded_bits = code.decode_tailbite(symbols);
+  berc.clear();
+  berc.count(bits, tailbite_decoded_bits);
+  cout << "Tailbite: errors = " << berc.get_errors() << ", equal = "
+       << (tailbite_decoded_bits == float_decoded_bits) << endl;
+
+  cout << "------------------------------------------------------------------------------" << endl;
+  cout << "5) Streaming Viterbi decoding" << endl;
+  cout << "------------------------------------------------------------------------------" << endl;
+
+  code.reset();
+  bits = randb(no_bits);
+  bpsk.modulate_bits(code.encode_trunc(bits), symbols);
+  symbols += 0.6 * randn(symbols.size());
+  bvec stream_decoded_bits;
+  int delay = 0;
+  for (int i = 0; i < symbols.size(); i += 37) {
+    int chunk_size = std::min(37, symbols.size() - i);
+    stream_decoded_bits = concat(stream_decoded_bits,
+                                 code.decode_stream(symbols.mid(i, chunk_size)));
+    delay = std::max(delay, (i + chunk_size) / 2 - stream_decoded_bits.size());
+  }
+  cout << "Traceback depth = " << code.get_traceback_depth()
+       << ", delay = " << delay << " bits" << endl;
+  stream_decoded_bits = concat(stream_decoded_bits, code.flush_stream());
+  berc.clear();
+  berc.count(bits, stream_decoded_bits);
+  cout << "Stream: decoded bits = " << stream_decoded_bits.size()
+       << ", errors = " << berc.get_errors() << endl;
+
+  code_punct.reset();
+  bits = randb(no_bits - 1); // ends with a punctured symbol
+  bpsk.modulate_bits(code_punct.encode_trunc(bits), symbols);
+  symbols += 0.55 * randn(symbols.size());
+  trunc_decoded_bits = code_punct.decode_trunc(symbols);
+  stream_decoded_bits.set_size(0);
+  for (int i = 0; i < symbols.size(); i += 37) {
+    int chunk_size = std::min(37, symbols.size() - i);
+    stream_decoded_bits = concat(stream_decoded_bits,
+                                 code_punct.decode_stream(symbols.mid(i, chunk_size)));
+  }
+  stream_decoded_bits = concat(stream_decoded_bits, code_punct.flush_stream());
+  berc.clear();
+  berc.count(bits, stream_decoded_bits);
+  cout << "Punctured stream: decoded bits = " << stream_decoded_bits.size()
+       << ", errors = " << berc.get_errors();
+  berc.clear();
+  berc.count(bits, trunc_decoded_bits);
+  cout << " (decode_trunc: " << berc.get_errors() << ")" << endl;
+
+  // the same stream through the base class interface
+  Convolutional_Code &base_code = code_punct;
+  base_code.reset();
+  bvec base_decoded_bits;
+  for (int i = 0; i < symbols.size(); i += 37) {
+    int chunk_size = std::min(37, symbols.size() - i);
+    base_decoded_bits = concat(base_decoded_bits,
+                               base_code.decode_stream(symbols.mid(i, chunk_size)));
+  }
+  base_decoded_bits = concat(base_decoded_bits, base_code.flush_stream());
+  cout << "Punctured stream through Convolutional_Code&: equal = "
+       << (base_decoded_bits == stream_decoded_bits) << endl;
+
+  cout << "------------------------------------------------------------------------------" << endl;
+  cout << "6) Wrap-around Viterbi decoding of tail-biting blocks" << endl;
+  cout << "------------------------------------------------------------------------------" << endl;
+
+  for (int fixed = 0; fixed < 2; fixed++) {
+    code.set_fixed_point_viterbi(fixed == 1);
+    int exact_errors = 0, wava_errors = 0, nrof_equal = 0;
+    for (int i = 0; i < 50; i++) {
+      bits = randb(48);
+      bpsk.modulate_bits(code.encode_tailbite(bits), symbols);
+      symbols += 0.9 * randn(symbols.size());
+      code.set_wrap_around_viterbi(0);
+      tailbite_decoded_bits = code.decode_tailbite(symbols);
+      code.set_wrap_around_viterbi(4);
+      bvec wava_decoded_bits = code.decode_tailbite(symbols);
+      berc.clear();
+      berc.count(bits, tailbite_decoded_bits);
+      exact_errors += round_i(berc.get_errors());
+      berc.clear();
+      berc.count(bits, wava_decoded_bits);
+      wava_errors += round_i(berc.get_errors());
+      nrof_equal += (wava_decoded_bits == tailbite_decoded_bits);
+    }
+    cout << (fixed ? "Fixed-point" : "Floating point") << ": errors = "
+         << exact_errors << " (all start states), " << wava_errors
+         << " (wrap-around), equal blocks = " << nrof_equal << " of 50" << endl;
+  }
+  code.set_wrap_around_viterbi(0);
+
+  int exact_errors = 0, wava_errors = 0, nrof_equal = 0;
+  for (int i = 0; i < 50; i++) {
+    bits = randb(48);
+    bpsk.modulate_bits(code_punct.encode_tailbite(bits), symbols);
+    symbols += 0.6 * randn(symbols.size());
+    code_punct.set_wrap_around_viterbi(0);
+    tailbite_decoded_bits = code_punct.decode_tailbite(symbols);
+    code_punct.set_wrap_around_viterbi(4);
+    bvec wava_decoded_bits = code_punct.decode_tailbite(symbols);
+    berc.clear();
+    berc.count(bits, tailbite_decoded_bits);
+    exact_errors += round_i(berc.get_errors());
+    berc.clear();
+    berc.count(bits, wava_decoded_bits);
+    wava_errors += round_i(berc.get_errors());
+    nrof_equal += (wava_decoded_bits == tailbite_decoded_bits);
+  }
+  cout << "Punctured: errors = " << exact_errors << " (all start states), "
+       << wava_errors << " (wrap-around), equal blocks = " << nrof_equal
+       << " of 50" << endl;
+  code_punct.set_wrap_around_viterbi(0);
+
+  cout << "------------------------------------------------------------------------------" << endl;
+  cout << "7) Table-driven encoders versus bit-serial encoding" << endl;
+  cout << "------------------------------------------------------------------------------" << endl;
+
+  {
+    // the last code has more than eight generators and is encoded bit by bit
+    int gens[5][9] = {{05, 07}, {0133, 0171}, {0557, 0663, 0711},
+                      {021645, 035661},
+                      {011, 012, 013, 014, 015, 016, 017, 013, 015}};
+    int nrof_gens[5] = {2, 2, 3, 2, 9};
+    int constraint_lengths[5] = {3, 7, 9, 14, 4};
+    ivec lengths = "1 5 8 13 64 101";
+    for (int c = 0; c < 5; c++) {
+      ivec gen(nrof_gens[c]);
+      for (int j = 0; j < gen.size(); j++) {
+        gen(j) = gens[c][j];
+      }
+      int m = constraint_lengths[c] - 1;
+      Convolutional_Code enc, ref;
+      enc.set_generator_polynomials(gen, m + 1);
+      ref.set_generator_polynomials(gen, m + 1);
+      bool trunc_ok = true, tail_ok = true, tailbite_ok = true;
+      for (int k = 0; k < lengths.size(); k++) {
+        bvec input = randb(lengths(k)), out, expected;
+
+        // truncated, from a nonzero start state and split over two calls
+        int state = randi(1, (1 << m) - 1);
+        enc.set_start_state(state);
+        enc.init_encoder();
+        ref.set_start_state(state);
+        ref.init_encoder();
+        bvec coded = enc.encode_trunc(input.left(lengths(k) / 2));
+        coded = concat(coded, enc.encode_trunc(input.right(lengths(k) - lengths(k) / 2)));
+        expected.set_size(0);
+        for (int i = 0; i < input.size(); i++) {
+          ref.encode_bit(input(i), out);
+          expected = concat(expected, out);
+        }
+        trunc_ok = trunc_ok && (coded == expected);
+
+        // tail of m zeros, from the zero state
+        ref.set_start_state(0);
+        ref.init_encoder();
+        expected.set_size(0);
+        bvec tailed = concat(input, zeros_b(m));
+        for (int i = 0; i < tailed.size(); i++) {
+          ref.encode_bit(tailed(i), out);
+          expected = concat(expected, out);
+        }
+        tail_ok = tail_ok && (enc.encode_tail(input) == expected);
+
+        // tail-biting, from the state of the last m input bits
+        if (input.size() >= m) {
+          ref.init_encoder();
+          for (int i = input.size() - m; i < input.size(); i++) {
+            ref.encode_bit(input(i), out);
+          }
+          expected.set_size(0);
+          for (int i = 0; i < input.size(); i++) {
+            ref.encode_bit(input(i), out);
+            expected = concat(expected, out);
+          }
+          tailbite_ok = tailbite_ok && (enc.encode_tailbite(input) == expected);
+        }
+      }
+      cout << "K = " << m + 1 << ", n = " << gen.size() << ": trunc " << trunc_ok
+           << ", tail " << tail_ok << ", tailbite " << tailbite_ok << endl;
+    }
+  }
+
   return 0;
 }
@@ -0,0 +1,146 @@
+/*!
+ * \file
+ * \brief CRC_Code test program
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 1995-2010  (see AUTHORS file for a list of contributors)
+ *
+ * This file is part of IT++ - a C++ library of mathematical, signal
+ * processing, speech processing, and communications classes and functions.
+ *
+ * IT++ is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * IT++ is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with IT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <itpp/itcomm.h>
+
+using namespace itpp;
+using namespace std;
+
+
+// Parity by long division, bit by bit
+bvec long_division(const bvec &in_bits, const bvec &poly, bool reverse_parity)
+{
+  int no_parity = poly.size() - 1;
+  bvec temp = concat(in_bits, zeros_b(no_parity));
+  for (int i = 0; i < in_bits.size(); i++) {
+    if (temp(i) == 1) {
+      temp.set_subvector(i, temp(i, i + no_parity) + poly);
+    }
+  }
+  bvec out = temp.right(no_parity);
+  return reverse_parity ? reverse(out) : out;
+}
+
+// Pack the bits, the first bit in the most significant bit of a byte
+Vec<uint8_t> pack_bytes(const bvec &bits)
+{
+  Vec<uint8_t> bytes(bits.size() / 8);
+  for (int i = 0; i < bytes.size(); i++) {
+    bytes(i) = static_cast<uint8_t>(bin2dec(bits.mid(8 * i, 8)));
+  }
+  return bytes;
+}
+
+// Compare all the parity computations of crc with long division by poly
+void check_code(const CRC_Code &crc, const bvec &poly, bool reverse_parity)
+{
+  ivec lengths = "1 5 8 13 63 64 65 127 200 517 1024";
+  bool bvec_ok = true, packed_ok = true, bytes_ok = true, check_ok = true;
+  for (int k = 0; k < lengths.size(); k++) {
+    bvec bits = randb(lengths(k));
+    bvec ref = long_division(bits, poly, reverse_parity);
+
+    bvec p;
+    crc.parity(bits, p);
+    bvec_ok = bvec_ok && (p == ref);
+
+    Packed_Bvec pp;
+    crc.parity(Packed_Bvec(bits), pp);
+    packed_ok = packed_ok && (pp.to_bvec() == ref);
+
+    if (lengths(k) % 8 == 0) {
+      crc.parity(pack_bytes(bits), p);
+      bytes_ok = bytes_ok && (p == ref)
+                 && crc.check_parity(pack_bytes(bits), ref);
+      bvec wrong = ref;
+      wrong(0) = wrong(0) + bin(1);
+      bytes_ok = bytes_ok && !crc.check_parity(pack_bytes(bits), wrong);
+    }
+
+    bvec coded = crc.encode(bits), decoded;
+    check_ok = check_ok && (coded == concat(bits, ref))
+               && crc.check_parity(coded) && crc.decode(coded, decoded)
+               && (decoded == bits);
+    coded(randi(0, coded.size() - 1)) += bin(1);
+    check_ok = check_ok && !crc.check_parity(coded);
+  }
+  cout << "bvec " << bvec_ok << ", Packed_Bvec " << packed_ok
+       << ", bytes " << bytes_ok << ", check/decode " << check_ok << endl;
+}
+
+
+int main()
+{
+  cout << "=====================================" << endl;
+  cout << "         Test of CRC codes           " << endl;
+  cout << "=====================================" << endl << endl;
+
+  RNG_reset(12345);
+
+  string codes[] = {"CRC-4", "CRC-7", "CRC-8", "CRC-12", "CRC-24", "CRC-32",
+                    "CCITT-4", "CCITT-5", "CCITT-6", "CCITT-16", "CCITT-32",
+                    "WCDMA-8", "WCDMA-12", "WCDMA-16", "WCDMA-24", "ATM-8",
+                    "ANSI-16", "SDLC-16"
+                   };
+  string polys[] = {"1 1 1 1 1", "1 1 0 1 0 0 0 1", "1 1 1 0 1 0 1 0 1",
+                    "1 1 0 0 0 0 0 0 0 1 1 1 1",
+                    "1 1 0 0 0 0 0 0 0 0 1 0 1 0 0 0 1 0 0 0 0 0 0 0 1",
+                    "1 0 1 0 0 0 0 0 0 0 1 0 0 0 0 0 0 1 0 0 1 1 0 0 0 1 1 1 0 0 0 1 0",
+                    "1 0 0 1 1", "1 1 0 1 0 1", "1 0 0 0 0 1 1",
+                    "1 0 0 0 1 0 0 0 0 0 0 1 0 0 0 0 1",
+                    "1 0 0 0 0 0 1 0 0 1 1 0 0 0 0 0 1 0 0 0 1 1 1 0 1 1 0 1 1 0 1 1 1",
+                    "1 1 0 0 1 1 0 1 1", "1 1 0 0 0 0 0 0 0 1 1 1 1",
+                    "1 0 0 0 1 0 0 0 0 0 0 1 0 0 0 0 1",
+                    "1 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 1 1 0 0 0 1 1",
+                    "1 0 0 0 0 0 1 1 1", "1 1 0 0 0 0 0 0 0 0 0 0 0 0 1 0 1",
+                    "1 1 0 1 0 0 0 0 0 1 0 0 1 0 1 1 1"
+                   };
+
+  bvec message = "1 0 1 1 0 0 1 1 1 0 0 0 1 0 1";
+  for (int i = 0; i < 18; i++) {
+    CRC_Code crc(codes[i]);
+    bool wcdma = (codes[i].substr(0, 5) == "WCDMA");
+    bvec p;
+    crc.parity(message, p);
+    cout << codes[i] << ": parity = " << p << endl << "  ";
+    check_code(crc, bvec(polys[i]), wcdma);
+  }
+
+  // generators of degree 64 (the largest one with lookup tables) and above
+  cout << endl;
+  ivec degrees = "64 65 80";
+  for (int k = 0; k < degrees.size(); k++) {
+    bvec poly = concat(bvec("1"), randb(degrees(k) - 1), bvec("1"));
+    CRC_Code crc;
+    crc.set_generator(poly);
+    cout << "Degree " << degrees(k) << ": ";
+    check_code(crc, poly, false);
+  }
+
+  return 0;
+}
@@ -28,10 +28,93 @@
 
 #include <itpp/itbase.h>
 #include <itpp/itcomm.h>
+#include <vector>
 
 using namespace itpp;
 using namespace std;
 
+// element of GF(q) with the vector space representation x
+GF to_gf(int q, int x)
+{
+  GF a(q);
+  a.set(q, dec2bin(levels2bits(q), x));
+  return a;
+}
+
+int from_gf(const GF &a)
+{
+  return bin2dec(a.get_vectorspace());
+}
+
+// Compare the region operations of GF_Bulk with GF arithmetic, on arrays
+// of type T
+template<class T>
+void test_bulk(int q, const string &type)
+{
+  GF_Bulk field(q);
+  const int len = 1003; // not a multiple of the SIMD width
+  std::vector<T> src(len), dst(len), ref(len);
+  for (int i = 0; i < len; i++) {
+    src[i] = static_cast<T>(randi(0, q - 1));
+  }
+
+  ivec constants = "0 1 2 3";
+  constants = concat(constants, randi(8, 0, q - 1));
+  bool mul_ok = true, mul_add_ok = true, add_ok = true;
+  for (int k = 0; k < constants.size(); k++) {
+    int c = constants(k);
+    GF gc = to_gf(q, c);
+
+    field.mul_region(&src[0], &dst[0], len, c);
+    for (int i = 0; i < len; i++) {
+      if (dst[i] != from_gf(gc * to_gf(q, src[i])))
+        mul_ok = false;
+    }
+
+    for (int i = 0; i < len; i++) {
+      dst[i] = ref[i] = static_cast<T>(randi(0, q - 1));
+    }
+    field.mul_add_region(&src[0], &dst[0], len, c);
+    for (int i = 0; i < len; i++) {
+      if (dst[i] != from_gf(to_gf(q, ref[i]) + gc * to_gf(q, src[i])))
+        mul_add_ok = false;
+    }
+  }
+
+  for (int i = 0; i < len; i++) {
+    dst[i] = ref[i] = static_cast<T>(randi(0, q - 1));
+  }
+  GF_Bulk::add_region(&src[0], &dst[0], len);
+  for (int i = 0; i < len; i++) {
+    if (dst[i] != from_gf(to_gf(q, ref[i]) + to_gf(q, src[i])))
+      add_ok = false;
+  }
+
+  // p(x) of degree 9 at 37 points
+  const int degree = 9, npoints = 37;
+  std::vector<T> coeffs(degree + 1), points(npoints), values(npoints);
+  for (int i = 0; i <= degree; i++) {
+    coeffs[i] = static_cast<T>(randi(0, q - 1));
+  }
+  for (int i = 0; i < npoints; i++) {
+    points[i] = static_cast<T>(randi(0, q - 1));
+  }
+  field.eval_poly(&coeffs[0], degree, &points[0], &values[0], npoints);
+  bool eval_ok = true;
+  for (int i = 0; i < npoints; i++) {
+    GF x = to_gf(q, points[i]), y = to_gf(q, coeffs[degree]);
+    for (int l = degree - 1; l >= 0; l--) {
+      y = y * x + to_gf(q, coeffs[l]);
+    }
+    if (values[i] != from_gf(y))
+      eval_ok = false;
+  }
+
+  cout << "GF_Bulk(" << q << "), " << type << ": mul_region " << mul_ok
+       << ", mul_add_region " << mul_add_ok << ", add_region " << add_ok
+       << ", eval_poly " << eval_ok << endl;
+}
+
 int main()
 {
   GF a(8), b(8), c(8);
@@ -44,5 +127,11 @@ int main()
   cout << "a=" << a << ", b=" << b << endl;
   cout << "c=" << c << endl;
 
+  RNG_reset(12345);
+  test_bulk<uint8_t>(16, "uint8");
+  test_bulk<uint8_t>(256, "uint8");
+  test_bulk<uint16_t>(256, "uint16");
+  test_bulk<uint16_t>(1024, "uint16");
+
   return 0;
 }
@@ -85,6 +85,28 @@ int main()
   cout << "D=" << D << endl;
   cout << "p=" << p << endl;
 
+  GF2mat E = A.concatenate_horizontal(A);
+  ivec pivots;
+  cout << "rank([A A])=" << E.rref(pivots) << endl;
+  cout << "rref([A A])=" << E << endl;
+  cout << "pivots=" << pivots << endl;
+
+// Larger matrices, with rows of several words
+  GF2mat X = random_matrix(150, 300);
+  X = X.concatenate_vertical(X.get_submatrix(0, 0, 19, 299));
+  GF2mat R = X;
+  int rank = R.rref(pivots);
+  cout << "rank(X)=" << X.row_rank() << ", rank from rref(X)=" << rank << endl;
+  GF2mat T, U;
+  X.T_fact(T, U, p);
+  GF2mat TX = T * X;
+  TX.permute_cols(p, 0);
+  cout << "T*X*P==U: " << (TX == U) << endl;
+  cout << "T*inv(T)==I: " << (T * T.inverse() == gf2dense_eye(T.rows())) << endl;
+  GF2mat V = random_matrix(300, 130);
+  cout << "(X*V)'==V'*X': "
+       << ((X * V).transpose() == V.transpose() * X.transpose()) << endl;
+
 // Test Alist functionality
   string file = "gf2mat_test.alist";
   GF2mat_sparse_alist alist;
@@ -32,6 +32,53 @@ using std::cout;
 using std::endl;
 using namespace itpp;
 
+// length of the shortest cycle of the Tanner graph of H (0 if none), by a
+// breadth-first search from each variable node
+int tanner_girth(const GF2mat_sparse &H)
+{
+  int nvar = H.cols(), ncheck = H.rows(), girth = 0;
+  Array<ivec> var_nbrs(nvar), chk_nbrs(ncheck);
+  for (int j = 0; j < nvar; j++) {
+    var_nbrs(j) = H.get_col(j).get_nz_indices();
+  }
+  GF2mat_sparse Ht = H.transpose();
+  for (int i = 0; i < ncheck; i++) {
+    chk_nbrs(i) = Ht.get_col(i).get_nz_indices();
+  }
+
+  // nodes 0..nvar-1 are variable nodes, the others check nodes
+  for (int root = 0; root < nvar; root++) {
+    ivec depth = -ones_i(nvar + ncheck), parent(nvar + ncheck);
+    ivec queue(nvar + ncheck);
+    int head = 0, tail = 0;
+    depth(root) = 0;
+    parent(root) = -1;
+    queue(tail++) = root;
+    while (head < tail) {
+      int u = queue(head++);
+      const ivec &nbrs = (u < nvar) ? var_nbrs(u) : chk_nbrs(u - nvar);
+      for (int k = 0; k < nbrs.length(); k++) {
+        int w = (u < nvar) ? nbrs(k) + nvar : nbrs(k);
+        if (w == parent(u)) {
+          continue;
+        }
+        if (depth(w) < 0) {
+          depth(w) = depth(u) + 1;
+          parent(w) = u;
+          queue(tail++) = w;
+        }
+        else {
+          int len = depth(u) + depth(w) + 1;
+          if ((girth == 0) || (len < girth)) {
+            girth = len;
+          }
+        }
+      }
+    }
+  }
+  return girth;
+}
+
 int main()
 {
   LDPC_Parity_Regular H;
@@ -58,6 +105,50 @@ int main()
   C.bp_decode(LLRin, LLRout);
   cout << LLRout.left(25) << endl;
 
+  // flooding and layered schedules with various check node updates
+  {
+    std::string methods[] = {"BP", "NMS", "OMS", "LBP", "LNMS", "LOMS"};
+    for (int i = 0; i < 6; i++) {
+      C.set_decoding_method(methods[i]);
+      int iters = C.bp_decode(LLRin, LLRout);
+      cout << methods[i] << ": iterations = " << iters << ", errors = "
+           << sum(to_ivec(LLRout < 0)) << endl;
+    }
+    C.set_decoding_method("BP");
+  }
+
+  // edge-ordered messages, optionally with RCM node renumbering
+  {
+    std::string methods[] = {"BP", "NMS", "LBP", "LNMS"};
+    QLLRvec LLRdefault(C.get_nvar());
+    for (int rcm = 0; rcm < 2; rcm++) {
+      for (int i = 0; i < 4; i++) {
+        C.set_decoding_method(methods[i]);
+        C.set_edge_ordering(false);
+        C.bp_decode(LLRin, LLRdefault);
+        C.set_edge_ordering(true, rcm == 1);
+        int iters = C.bp_decode(LLRin, LLRout);
+        bool equal = (LLRout == LLRdefault);
+        // only the RCM renumbering changes the order of the layers
+        it_assert(equal || ((rcm == 1) && (methods[i][0] == 'L')),
+                  "edge-ordered decoding differs from the default layout");
+        cout << "edge-ordered (rcm = " << rcm << ") " << methods[i]
+             << ": iterations = " << iters << ", errors = "
+             << sum(to_ivec(LLRout < 0)) << ", equal = " << equal << endl;
+      }
+    }
+
+    // the layout is saved with the codec
+    C.save_code("ldpc_test_ordered.codec");
+    LDPC_Code Co("ldpc_test_ordered.codec", &G);
+    Co.set_decoding_method("LNMS");
+    Co.bp_decode(LLRin, LLRdefault);
+    cout << "edge-ordered (rcm = 1) LNMS after reload: equal = "
+         << (LLRdefault == LLRout) << endl;
+    C.set_edge_ordering(false);
+    C.set_decoding_method("BP");
+  }
+
   // BLDPC code
   {
     cout.precision(5);
@@ -83,5 +174,132 @@ int main()
     bvec codeword;
     G.encode(in_bits, codeword);
     cout << in_bits << endl << codeword << endl;
+
+    LDPC_Generator_Sparse Gs(&H);
+    bvec codeword_s;
+    Gs.encode(in_bits, codeword_s);
+    cout << "sparse generator: gap = " << Gs.get_gap() << ", equal = "
+         << (codeword == codeword_s) << endl;
+  }
+
+  // multi-frame decoding (all-zero codewords)
+  {
+    int nframes = 20;
+    mat llr_batch(C.get_nvar(), nframes);
+    for (int f = 0; f < nframes; f++) {
+      llr_batch.set_col(f, 2.0 * (1.0 + sigma * randn(C.get_nvar())) / (N0 / 2.0));
+    }
+    // the single-frame decoder with the resolution of the batch decoder
+    // (1/8) and without correction table gives the same min-sum results
+    LLR_calc_unit llrcalc = C.get_llrcalc();
+    C.set_llrcalc(LLR_calc_unit(3, 0, 0));
+    std::string methods[] = {"NMS", "LNMS", "LOMS"};
+    for (int i = 0; i < 3; i++) {
+      C.set_decoding_method(methods[i]);
+      bmat bits_batch;
+      ivec iters;
+      C.decode_batch(llr_batch, bits_batch, iters);
+      int errors = 0;
+      int bits_mismatch = 0, iters_mismatch = 0;
+      for (int f = 0; f < nframes; f++) {
+        errors += sum(to_ivec(bits_batch.get_col(f)));
+        QLLRvec llr_single;
+        int iters_single = C.bp_decode(C.get_llrcalc().to_qllr(llr_batch.get_col(f)),
+                                       llr_single);
+        bvec bits_single = (llr_single.left(C.get_nvar() - C.get_ncheck()) < 0);
+        bits_mismatch += (bits_single != bits_batch.get_col(f));
+        iters_mismatch += (iters_single != iters(f));
+      }
+      it_assert((bits_mismatch == 0) && (iters_mismatch == 0),
+                "decode_batch() and bp_decode() differ");
+      cout << methods[i] << " batch: iterations = " << iters
+           << ", errors = " << errors << endl;
+      cout << methods[i] << " batch versus bp_decode(): frames with other "
+           << "decisions = " << bits_mismatch << ", other iteration counts = "
+           << iters_mismatch << endl;
+    }
+    C.set_llrcalc(llrcalc);
+  }
+
+  // quasi-cyclic decoder versus generic decoder
+  {
+    imat H_b = "0 -1 -1 0 1 0 -1 -1; -1 1 4 -1 -1 0 0 -1;"
+               "-1 2 -1 6 2 -1 0 0; 3 -1 5 -1 3 -1 -1 0";
+    BLDPC_Parity H(H_b, 16);
+    LDPC_Parity Hg(H.export_alist());
+    BLDPC_Generator G(&H);
+    LDPC_Code Cqc(&H, &G);
+    LDPC_Code Cg(&Hg);
+    cout << "QC expansion factor: " << Cqc.get_qc_exp_factor() << ", "
+         << Cg.get_qc_exp_factor() << endl;
+
+    bvec codeword;
+    G.encode(randb(H.get_nvar() - H.get_ncheck()), codeword);
+    vec x = 1.0 - 2.0 * to_vec(codeword) + 0.6 * randn(H.get_nvar());
+    QLLRvec llr = Cqc.get_llrcalc().to_qllr(2.0 * x / 0.36);
+    std::string methods[] = {"NMS", "LBP", "LNMS", "LOMS"};
+    for (int i = 0; i < 4; i++) {
+      Cqc.set_decoding_method(methods[i]);
+      Cg.set_decoding_method(methods[i]);
+      QLLRvec llr_qc, llr_g;
+      int iters_qc = Cqc.bp_decode(llr, llr_qc);
+      int iters_g = Cg.bp_decode(llr, llr_g);
+      cout << methods[i] << " QC: iterations = " << iters_qc << ", "
+           << iters_g << ", equal = " << (llr_qc == llr_g) << ", errors = "
+           << sum(to_ivec((llr_qc < 0) + codeword)) << endl;
+    }
+  }
+
+  // sparse generator (the columns of the parity check matrix are permuted)
+  {
+    LDPC_Parity_Regular Hs = H;
+    LDPC_Generator_Sparse Gs(&Hs);
+    LDPC_Code Cs(&Hs, &Gs);
+    Cs.save_code("ldpc_test_sparse.codec");
+    LDPC_Generator_Sparse Gl;
+    LDPC_Code Cl("ldpc_test_sparse.codec", &Gl);
+    bvec in_bits = randb(Cs.get_nvar() - Cs.get_ncheck());
+    bvec codeword, codeword_l;
+    Cs.encode(in_bits, codeword);
+    Cl.encode(in_bits, codeword_l);
+    cout << "sparse generator: gap = " << Gs.get_gap() << ", syndrome check = "
+         << Cs.syndrome_check(codeword) << ", equal after reload = "
+         << (codeword == codeword_l) << endl;
+  }
+
+  // progressive edge-growth construction
+  {
+    LDPC_Parity_Irregular Hp;
+    vec var_deg = "0 0.3 0.7", chk_deg = "0 0 0 0 0 0 1";
+    Hp.generate(400, var_deg, chk_deg, "PEG", "200 6");
+    LDPC_Code Cp(&Hp);
+    cout << Cp << endl;
+
+    // degree distributions from an edge perspective, as requested
+    GF2mat_sparse Hs = Hp.get_H(), Hts = Hp.get_H(true);
+    vec var_edges = zeros(var_deg.length()), chk_edges = zeros(chk_deg.length());
+    for (int j = 0; j < Hp.get_nvar(); j++) {
+      int d = Hs.get_col(j).nnz();
+      it_assert((d > 0) && (d <= var_deg.length()), "PEG: wrong variable degree");
+      var_edges(d - 1) += d;
+    }
+    for (int i = 0; i < Hp.get_ncheck(); i++) {
+      int d = Hts.get_col(i).nnz();
+      it_assert((d > 0) && (d <= chk_deg.length()), "PEG: wrong check degree");
+      chk_edges(d - 1) += d;
+    }
+    it_assert(sum(var_edges) == sum(chk_edges), "PEG: edge count mismatch");
+    var_edges /= sum(var_edges);
+    chk_edges /= sum(chk_edges);
+    it_assert(max(abs(var_edges - var_deg)) < 0.01,
+              "PEG: variable degree distribution differs");
+    it_assert(max(abs(chk_edges - chk_deg)) < 0.01,
+              "PEG: check degree distribution differs");
+
+    // girth target 6 (the degree-2 nodes maximize their local girth)
+    int girth_p = tanner_girth(Hs);
+    it_assert((girth_p == 0) || (girth_p >= 6), "PEG: girth below target");
+    cout << "PEG: variable degrees = " << var_edges << ", check degrees = "
+         << chk_edges << ", girth = " << girth_p << endl;
   }
 }
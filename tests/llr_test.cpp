@@ -86,6 +86,39 @@ int main()
   cout << lcu1.to_double(lcu1.Boxplus(lcu1.to_qllr(1.25), lcu1.to_qllr(3.75)))
        << endl;
 
+  cout << "-------------------" << endl;
+  cout << "Vector functions versus scalar functions:" << endl;
+  {
+    LLR_calc_unit lcus[] = {lcu1, lcu2, lcu3, lcu4};
+    int n = 103;
+    for (int u = 0; u < 4; u++) {
+      QLLRvec a = lcus[u].to_qllr(8.0 * randn(n));
+      QLLRvec b = lcus[u].to_qllr(8.0 * randn(n));
+      a(0) = 0;
+      b(1) = 0;
+      a(2) = b(2) = QLLR_MAX;
+      a(3) = -QLLR_MAX;
+      QLLRvec bp, jl;
+      lcus[u].Boxplus(a, b, bp);
+      lcus[u].jaclog(a, b, jl);
+      bool bp_equal = true, jl_equal = true;
+      for (int i = 0; i < n; i++) {
+        bp_equal = bp_equal && (bp(i) == lcus[u].Boxplus(a(i), b(i)));
+        jl_equal = jl_equal && (jl(i) == lcus[u].jaclog(a(i), b(i)));
+      }
+      cout << "Boxplus: " << bp_equal << ", jaclog: " << jl_equal << endl;
+    }
+
+    QLLRvec l = "-7 6 12 -5 5 9 -4 2 8 3 -6 7 4";
+    QLLR min1, min2;
+    int min_pos, sign;
+    for (int n = 1; n <= l.size(); n += 4) {
+      LLR_calc_unit::min_sum_reduce(l.left(n), min1, min2, min_pos, sign);
+      cout << "min_sum_reduce(" << l.left(n) << ") = " << min1 << " " << min2
+           << " " << min_pos << " " << sign << endl;
+    }
+  }
+
   return 0;
 }
 
@@ -33,6 +33,29 @@ using namespace std;
 using namespace itpp;
 
 
+// Compare the tree search methods with max-log full enumeration: the
+// sphere decoder, and K-best with a list that holds every candidate.
+template<class Modulator_T, class Vec_T, class Mat_T>
+void check_maxlog(Modulator_T chan, const Vec_T &y, const Mat_T &H,
+                  double sigma2, const QLLRvec &LLR_ap)
+{
+  // with an empty table the Jacobian logarithm is the max-log one
+  chan.set_llrcalc(LLR_calc_unit(12, 0, 0));
+  QLLRvec LLR_full, LLR_sphere, LLR_kbest;
+  chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR_full,
+                            Modulator_T::FULL_ENUM_LOGMAP);
+  chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR_sphere,
+                            Modulator_T::SPHERE_MAXLOG);
+  chan.set_kbest_size(pow2i(sum(chan.get_k())));
+  chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR_kbest,
+                            Modulator_T::KBEST_MAXLOG);
+  // the metrics are rounded to the QLLR resolution in different orders
+  cout << "max-log full enumeration == sphere: "
+       << (max(abs(LLR_sphere - LLR_full)) <= 1)
+       << ", == K-best: " << (max(abs(LLR_kbest - LLR_full)) <= 1) << endl;
+}
+
+
 int main()
 {
   cout << "========================================================" << endl;
@@ -53,6 +76,7 @@ int main()
       cout << "================== ND-U" << (1 << np) << "PAM ==================\n";
 
       chan.set_M(nt, 1 << np);
+      chan.set_llr_clipping(1e4);
       cout << chan << endl;
       bvec b = randb(nt * np);
       cout << b << endl;
@@ -74,6 +98,15 @@ int main()
       chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::ZF_LOGMAP);
       cout << "zero-forcing     : " << chan.get_llrcalc().to_double(LLR) << endl;
 
+      chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::SPHERE_MAXLOG);
+      cout << "sphere max-log   : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::KBEST_MAXLOG);
+      cout << "K-best max-log   : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      check_maxlog(chan, y, H, sigma2, LLR_ap);
+      check_maxlog(chan, y, H, sigma2, 2000 * (1 - 2 * to_ivec(b)));
+
       ivec zhat;
       chan.sphere_decoding(y, H, 0.01, 10000, 2.0, zhat);
       cout << zhat << endl;
@@ -87,6 +120,7 @@ int main()
       cout << "================== ND-U" << ((1 << (2*np))) << "QAM ==================\n";
 
       chan.set_M(nt, (1 << (2*np)));
+      chan.set_llr_clipping(1e4);
       cout << chan << endl;
       bvec b = randb(nt * np * 2);
       cout << b << endl;
@@ -106,6 +140,15 @@ int main()
 
       chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::ZF_LOGMAP);
       cout << "zero-forcing     : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::SPHERE_MAXLOG);
+      cout << "sphere max-log   : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::KBEST_MAXLOG);
+      cout << "K-best max-log   : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      check_maxlog(chan, y, H, sigma2, LLR_ap);
+      check_maxlog(chan, y, H, sigma2, 2000 * (1 - 2 * to_ivec(b)));
     }
   }
 
@@ -116,6 +159,7 @@ int main()
       cout << "================== ND-U" << ((1 << (2*np))) << "PSK ==================\n";
 
       chan.set_M(nt, (1 << (2*np)));
+      chan.set_llr_clipping(1e4);
       cout << chan << endl;
       bvec b = randb(nt * np * 2);
       cout << b << endl;
@@ -135,6 +179,15 @@ int main()
 
       chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::ZF_LOGMAP);
       cout << "zero-forcing     : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::SPHERE_MAXLOG);
+      cout << "sphere max-log   : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      chan.demodulate_soft_bits(y, H, sigma2, LLR_ap, LLR, ND_UPAM::KBEST_MAXLOG);
+      cout << "K-best max-log   : " << chan.get_llrcalc().to_double(LLR) << endl;
+
+      check_maxlog(chan, y, H, sigma2, LLR_ap);
+      check_maxlog(chan, y, H, sigma2, 2000 * (1 - 2 * to_ivec(b)));
     }
   }
 
@@ -32,6 +32,35 @@ using namespace itpp;
 using namespace std;
 
 
+// True if the soft bits agree to a relative precision of 1e-9
+bool soft_bits_equal(const vec &a, const vec &b)
+{
+  return (a.size() == b.size())
+         && (max(abs(a - b)) <= 1e-9 * std::max(1.0, max(abs(b))));
+}
+
+// Compare the soft demapper of mod with the generic Modulator<T> demapper
+// for the same constellation, without and with a channel
+template<typename T>
+void compare_soft_demappers(const Modulator<T> &mod, const string &name,
+                            const Vec<T> &rx_symbols, const Vec<T> &rx_faded,
+                            const Vec<T> &channel, double N0)
+{
+  Modulator<T> generic(mod.get_symbols(), mod.get_bits2symbols());
+  Soft_Method methods[] = {LOGMAP, APPROX};
+  cout << "  " << name << ":";
+  for (int i = 0; i < 2; i++) {
+    bool awgn_ok = soft_bits_equal(mod.demodulate_soft_bits(rx_symbols, N0, methods[i]),
+                                   generic.demodulate_soft_bits(rx_symbols, N0, methods[i]));
+    bool channel_ok = soft_bits_equal(mod.demodulate_soft_bits(rx_faded, channel, N0, methods[i]),
+                                      generic.demodulate_soft_bits(rx_faded, channel, N0, methods[i]));
+    cout << ((i == 0) ? " LOGMAP " : ", APPROX ") << awgn_ok
+         << " (channel " << channel_ok << ")";
+  }
+  cout << endl;
+}
+
+
 int main()
 {
   RNG_reset(12345);
@@ -299,4 +328,40 @@ int main()
     cout << "  softbits        = " << softbits << endl;
     cout << "  softbits_approx = " << softbits_approx << endl << endl;
   }
+
+  cout << "===========================================================" << endl;
+
+  {
+    cout << endl << "Per-dimension soft demappers versus Modulator<T>" << endl;
+    const int n = 1000;
+    for (int M = 4; M <= 256; M *= 4) {
+      QAM qam(M);
+      cvec tx_symbols = qam.modulate_bits(randb(n * round_i(qam.bits_per_symbol())));
+      cvec channel = randn_c(n);
+      cvec noise = sqrt(N0) * randn_c(n);
+      compare_soft_demappers<complex<double> >(qam, to_str(M) + "-QAM",
+                                               tx_symbols + noise,
+                                               elem_mult(channel, tx_symbols) + noise,
+                                               channel, N0);
+    }
+    for (int M = 2; M <= 8; M *= 2) {
+      PAM pam(M);
+      vec tx_symbols = pam.modulate_bits(randb(n * round_i(pam.bits_per_symbol())));
+      vec channel = randn(n);
+      vec noise = sqrt(N0) * randn(n);
+      compare_soft_demappers<double>(pam, to_str(M) + "-PAM (real signal)",
+                                     tx_symbols + noise,
+                                     elem_mult(channel, tx_symbols) + noise,
+                                     channel, N0);
+
+      PAM_c pam_c(M);
+      cvec tx_symbols_c = pam_c.modulate_bits(randb(n * round_i(pam_c.bits_per_symbol())));
+      cvec channel_c = randn_c(n);
+      cvec noise_c = sqrt(N0) * randn_c(n);
+      compare_soft_demappers<complex<double> >(pam_c, to_str(M) + "-PAM (complex signal)",
+                                               tx_symbols_c + noise_c,
+                                               elem_mult(channel_c, tx_symbols_c) + noise_c,
+                                               channel_c, N0);
+    }
+  }
 }
@@ -0,0 +1,135 @@
+/*!
+ * \file
+ * \brief Packed binary vector test program
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 1995-2010  (see AUTHORS file for a list of contributors)
+ *
+ * This file is part of IT++ - a C++ library of mathematical, signal
+ * processing, speech processing, and communications classes and functions.
+ *
+ * IT++ is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * IT++ is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with IT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <itpp/itcomm.h>
+
+using namespace itpp;
+using namespace std;
+
+
+int main()
+{
+  cout << "=====================================" << endl;
+  cout << "    Test of packed binary vectors    " << endl;
+  cout << "=====================================" << endl << endl;
+
+  RNG_reset(12345);
+
+  bvec a = "1 0 1 1 0 0 1 0 1 1 1";
+  Packed_Bvec pa(a);
+  cout << "a = " << pa << endl;
+  cout << "a.words() = " << pa.words() << endl;
+  cout << "a.weight() = " << pa.weight() << endl;
+  cout << "a(2, 6) = " << pa(2, 6) << endl;
+  cout << "a.right(4) = " << pa.right(4) << endl;
+  pa.flip(1);
+  pa.set(10, bin(0));
+  cout << "a after flip(1), set(10, 0) = " << pa << endl << endl;
+
+  // long vectors, compared bit by bit with bvec
+  int len = 1000;
+  bvec b1 = randb(len);
+  bvec b2 = randb(len);
+  Packed_Bvec p1(b1), p2(b2);
+
+  cout << "to_bvec() == bvec: " << (p1.to_bvec() == b1) << endl;
+  cout << "(p1 + p2) == (b1 + b2): " << ((p1 + p2).to_bvec() == (b1 + b2)) << endl;
+  cout << "(p1 & p2) == elem_mult(b1, b2): "
+       << ((p1 & p2).to_bvec() == elem_mult(b1, b2)) << endl;
+  cout << "weight: " << p1.weight() << " " << sum(to_ivec(b1)) << endl;
+  cout << "hamming_distance: " << hamming_distance(p1, p2) << " "
+       << sum(to_ivec(b1 + b2)) << endl;
+
+  bool slices_ok = true;
+  for (int start = 0; start < 130; start += 7) {
+    for (int nr = 0; nr < 200; nr += 13) {
+      if (p1.mid(start, nr).to_bvec() != b1.mid(start, nr))
+        slices_ok = false;
+    }
+  }
+  cout << "mid() == bvec::mid(): " << slices_ok << endl;
+
+  bool subvectors_ok = true;
+  for (int i = 0; i < 150; i += 11) {
+    for (int nr = 1; nr < 150; nr += 17) {
+      Packed_Bvec p(p1);
+      bvec b(b1);
+      p.set_subvector(i, p2.left(nr));
+      b.set_subvector(i, b2.left(nr));
+      if (p.to_bvec() != b)
+        subvectors_ok = false;
+    }
+  }
+  cout << "set_subvector() == bvec::set_subvector(): " << subvectors_ok << endl;
+  cout << "concat() == concat(): "
+       << (concat(p1.left(77), p2.left(130)).to_bvec()
+           == concat(b1.left(77), b2.left(130))) << endl << endl;
+
+  // error counters with delay and ignored bits
+  BERC berc(3, 5, 7), pberc(3, 5, 7);
+  bvec r1 = concat(zeros_b(3), b1) + concat(randb(100), zeros_b(len - 97));
+  berc.count(b1, r1);
+  pberc.count(p1, Packed_Bvec(r1));
+  cout << "BERC: " << berc.get_errors() << " " << berc.get_corrects() << endl;
+  cout << "BERC (packed): " << pberc.get_errors() << " "
+       << pberc.get_corrects() << endl;
+  cout << "count_errors (packed, delay -2): "
+       << BERC::count_errors(Packed_Bvec(r1), p1, -2) << " "
+       << BERC::count_errors(r1, b1, -2) << endl << endl;
+
+  // CRC
+  CRC_Code crc(std::string("WCDMA-16"));
+  bvec coded;
+  Packed_Bvec pcoded;
+  crc.encode(b1, coded);
+  crc.encode(p1, pcoded);
+  cout << "CRC encode: " << (pcoded.to_bvec() == coded) << endl;
+  cout << "CRC check_parity: " << crc.check_parity(pcoded) << endl;
+  pcoded.flip(500);
+  Packed_Bvec pdecoded;
+  cout << "CRC decode with an error: " << crc.decode(pcoded, pdecoded)
+       << " " << pdecoded.size() << endl << endl;
+
+  // encoders through the Channel_Code interface
+  Hamming_Code hamming(3);
+  Packed_Bvec phamming, pmessage;
+  hamming.encode(p1.left(400), phamming);
+  phamming.flip(3);
+  hamming.decode(phamming, pmessage);
+  cout << "Hamming: " << (pmessage == p1.left(400)) << endl << endl;
+
+  // channel and random bits
+  BSC bsc(0.05);
+  Packed_Bvec zero(100000);
+  cout << "BSC error rate: "
+       << round_i(bsc(zero).weight() / 1000.0) / 100.0 << endl;
+  Packed_Bvec prand;
+  randb(70, prand);
+  cout << "randb(70) = " << prand << endl;
+
+  return 0;
+}
@@ -33,6 +33,42 @@ using namespace itpp;
 using namespace std;
 
 
+// Parity of the taps of generator g on the K-bit register reg, where the
+// most significant bit of g is the tap of the newest bit (bit 0 of reg)
+int tap_parity(int g, int K, int reg)
+{
+  int p = 0;
+  for (int i = 0; i < K; i++) {
+    p ^= (g >> (K - 1 - i)) & (reg >> i) & 1;
+  }
+  return p;
+}
+
+// Bit-serial recursive systematic encoder, from the zero state; with
+// terminate, m tail bits drive the encoder back to the zero state
+void encode_bitwise(const ivec &gen, int K, const bvec &input, bool terminate,
+                    bvec &tail, bmat &parity_bits)
+{
+  int m = K - 1, n = gen.size();
+  int length = input.size() + (terminate ? m : 0);
+  tail.set_size(terminate ? m : 0);
+  parity_bits.set_size(length, n - 1);
+  int state = 0;
+  for (int i = 0; i < length; i++) {
+    int feedback = tap_parity(gen(0), K, state << 1);
+    int in = (i < input.size()) ? int(input(i)) : feedback;
+    if (i >= input.size()) {
+      tail(i - input.size()) = in;
+    }
+    int reg = (state << 1) | (in ^ feedback);
+    for (int j = 1; j < n; j++) {
+      parity_bits(i, j - 1) = tap_parity(gen(j), K, reg);
+    }
+    state = reg & ((1 << m) - 1);
+  }
+}
+
+
 int main()
 {
   bvec uncoded_bits = "0 1 1 0 1 0 1", tail_bits(4), decoded_bits(11);
@@ -69,5 +105,36 @@ int main()
   cout << "tail_bits = " << tail_bits << endl;
   cout << "decoded_bits = " << decoded_bits << endl;
 
+  // table-driven encoders versus bit-serial encoding; the last code has
+  // more than nine generators and is encoded one step at a time
+  int gens[5][10] = {{013, 015}, {023, 035}, {0435, 0567, 0627},
+                     {02565, 03471}, {07, 05, 06, 03, 01, 02, 04, 07, 05, 03}};
+  int nrof_gens[5] = {2, 2, 3, 2, 10};
+  int constraint_lengths[5] = {4, 5, 9, 11, 3};
+  ivec lengths = "1 5 8 13 64 101";
+  for (int c = 0; c < 5; c++) {
+    ivec gen(nrof_gens[c]);
+    for (int j = 0; j < gen.size(); j++) {
+      gen(j) = gens[c][j];
+    }
+    Rec_Syst_Conv_Code code;
+    code.set_generator_polynomials(gen, constraint_lengths[c]);
+    bool encode_ok = true, tail_ok = true;
+    for (int k = 0; k < lengths.size(); k++) {
+      bvec input = randb(lengths(k)), tail, expected_tail;
+      bmat parity, expected_parity;
+      code.encode(input, parity);
+      encode_bitwise(gen, constraint_lengths[c], input, false, expected_tail,
+                     expected_parity);
+      encode_ok = encode_ok && (parity == expected_parity);
+      code.encode_tail(input, tail, parity);
+      encode_bitwise(gen, constraint_lengths[c], input, true, expected_tail,
+                     expected_parity);
+      tail_ok = tail_ok && (tail == expected_tail) && (parity == expected_parity);
+    }
+    cout << "K = " << constraint_lengths[c] << ", n = " << gen.size()
+         << ": encode " << encode_ok << ", encode_tail " << tail_ok << endl;
+  }
+
   return 0;
 }
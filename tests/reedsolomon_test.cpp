@@ -33,6 +33,74 @@ using std::cout;
 using std::endl;
 
 
+// Add errors with random nonzero values to e distinct m-bit symbols
+bvec add_symbol_errors(const bvec &codeword, int m, int e)
+{
+  int n = codeword.size() / m;
+  bvec received = codeword;
+  ivec pos = sort_index(randu(n)).left(e);
+  for (int i = 0; i < e; i++) {
+    bvec error = dec2bin(m, randi(1, pow2i(m) - 1));
+    received.replace_mid(pos(i) * m, received.mid(pos(i) * m, m) + error);
+  }
+  return received;
+}
+
+// Number of m-bit symbols in which a and b differ
+int symbol_distance(const bvec &a, const bvec &b, int m)
+{
+  int d = 0;
+  for (int j = 0; j < a.size() / m; j++) {
+    d += (a.mid(j * m, m) != b.mid(j * m, m));
+  }
+  return d;
+}
+
+// Decode words with 0, ..., t symbol errors, and words with t + 1, ...,
+// t + 3 symbol errors. The latter are either miscorrected to another
+// codeword within distance t, or left as received: then the message is
+// the first k symbols (systematic code) or the quotient of the division
+// by g(x), whose product with g(x) differs from the word in the first 2t
+// symbols only. The words are decoded one by one and in a batch.
+void test_decoder(int m, int t, bool systematic, int words)
+{
+  Reed_Solomon rs(m, t, systematic);
+  int n = pow2i(m) - 1, k = n - 2 * t;
+  cout << "RS(" << n << "," << k << ")" << (systematic ? ", systematic" : "")
+       << ":" << endl;
+  for (int e = 0; e <= t + 3; e++) {
+    bvec messages = randb(words * k * m), received;
+    for (int w = 0; w < words; w++) {
+      received = concat(received, add_symbol_errors(rs.encode(messages.mid(w * k * m, k * m)), m, e));
+    }
+    bvec decoded = rs.decode(received);
+    bool batch_ok = true;
+    int correct = 0, failures = 0, miscorrections = 0;
+    for (int w = 0; w < words; w++) {
+      bvec r = received.mid(w * n * m, n * m);
+      bvec d = rs.decode(r);
+      batch_ok = batch_ok && (d == decoded.mid(w * k * m, k * m));
+      bvec c = rs.encode(d);
+      if (d == messages.mid(w * k * m, k * m)) {
+        correct++;
+      }
+      else if (systematic ? (d == r.left(k * m))
+               : (r.right((n - 2 * t) * m) == c.right((n - 2 * t) * m))) {
+        failures++;
+      }
+      else if (symbol_distance(r, c, m) <= t) {
+        miscorrections++;
+      }
+    }
+    it_assert((e > t) || (correct == words), "Correctable word not decoded");
+    it_assert(correct + failures + miscorrections == words, "Wrong decoder output");
+    cout << "  " << e << " errors: correct = " << correct << ", left as received = "
+         << failures << ", miscorrected = " << miscorrections << " of " << words
+         << ", batch equal = " << batch_ok << endl;
+  }
+}
+
+
 int main()
 {
   cout << "==========================================" << endl;
@@ -77,5 +145,12 @@ int main()
     cout << "Decoded to:      " << decoded.get_row(i) << endl << endl;
   }
 
+  cout << "Multiple errors" << endl;
+  cout << "---------------" << endl;
+  test_decoder(4, 2, false, 20);
+  test_decoder(4, 3, true, 20);
+  test_decoder(8, 16, true, 20);
+  test_decoder(8, 16, false, 20);
+
   return 0;
 }
@@ -171,5 +171,101 @@ int main()
   cout << endl;
   */
 
+  // -- sliding-window decoding of a longer block --
+  {
+    int long_block_length = 4000;
+    turbo.set_interleaver(wcdma_turbo_interleaver_sequence(long_block_length));
+    input = randb(long_block_length);
+    turbo.encode(input, transmitted);
+    bpsk.modulate_bits(transmitted, symbols);
+    noise_src.setup(0.0, sigma2(2));
+    turbo.set_awgn_channel_parameters(Ec, N0(2));
+    received = symbols + noise_src(transmitted.length());
+
+    std::string metrics[] = {"LOGMAX", "LOGMAP", "TABLE"};
+    for (int m = 0; m < 3; m++) {
+      bvec full_bits;
+      turbo.set_metric(metrics[m], 1.0);
+      turbo.decode(received, full_bits, nrof_used_iterations);
+      turbo.set_metric(metrics[m], 1.0, LLR_calc_unit(), 128, 32);
+      turbo.decode(received, decoded_bits, nrof_used_iterations);
+      berc.clear();
+      berc.count(input, decoded_bits);
+      cout << metrics[m] << " with window 128: errors = " << berc.get_errors()
+           << ", equal to full block decoding = " << (decoded_bits == full_bits)
+           << endl;
+    }
+
+    // -- 16-bit fixed-point logmax decoding --
+    turbo.set_metric("LOGMAX16", 1.0);
+    turbo.decode(received, decoded_bits, nrof_used_iterations);
+    berc.clear();
+    berc.count(input, decoded_bits);
+    cout << "LOGMAX16: errors = " << berc.get_errors() << ", iterations = "
+         << nrof_used_iterations << endl;
+  }
+
+  // -- LTE QPP interleaver and parallel sub-block decoding --
+  {
+    cout << "LTE QPP interleaver (K = 40): " << lte_turbo_interleaver_sequence(40)
+         << endl;
+    int lte_block_length = 1024;
+    // LTE constituent code: feedback 013, feedforward 015 (octal)
+    ivec lte_gen(2);
+    lte_gen(0) = 013;
+    lte_gen(1) = 015;
+    turbo.set_parameters(lte_gen, lte_gen, 4,
+                         lte_turbo_interleaver_sequence(lte_block_length),
+                         iterations, "LOGMAX", 0.7, false);
+    cout << "LTE generator polynomials = " << std::oct << lte_gen << std::dec
+         << endl;
+    input = randb(lte_block_length * 4);
+    turbo.encode(input, transmitted);
+    bpsk.modulate_bits(transmitted, symbols);
+    noise_src.setup(0.0, sigma2(2));
+    turbo.set_awgn_channel_parameters(Ec, N0(2));
+    received = symbols + noise_src(transmitted.length());
+    for (int P = 1; P <= 16; P *= 4) {
+      turbo.set_subblocks(P);
+      turbo.decode(received, decoded_bits, nrof_used_iterations);
+      berc.clear();
+      berc.count(input, decoded_bits);
+      cout << "LTE turbo code, " << P << " sub-block(s): errors = "
+           << berc.get_errors() << endl;
+    }
+    turbo.set_subblocks(1);
+  }
+
+  // -- CRC-aided early termination --
+  {
+    int lte_block_length = 1024;
+    CRC_Code crc("CRC-24");
+    input.set_size(0);
+    for (int i = 0; i < 20; i++) {
+      input = concat(input, crc.encode(randb(lte_block_length - 24)));
+    }
+    turbo.encode(input, transmitted);
+    bpsk.modulate_bits(transmitted, symbols);
+    noise_src.setup(0.0, sigma2(4));
+    turbo.set_awgn_channel_parameters(Ec, N0(4));
+    received = symbols + noise_src(transmitted.length());
+    for (int stop = 0; stop < 2; stop++) {
+      if (stop == 0) {
+        turbo.set_adaptive_stop(true);
+      }
+      else {
+        turbo.set_adaptive_stop(false);
+        turbo.set_crc_stop(crc);
+      }
+      turbo.reset_iteration_histogram();
+      turbo.decode(received, decoded_bits, nrof_used_iterations);
+      berc.clear();
+      berc.count(input, decoded_bits);
+      cout << (stop == 0 ? "adaptive stop" : "CRC stop") << ": errors = "
+           << berc.get_errors() << ", iteration histogram = "
+           << turbo.get_iteration_histogram() << endl;
+    }
+  }
+
   return 0;
 }